@@ -34,29 +34,11 @@ void PyEigenIPC::PyClient::bindClientT(pybind11::module &m, const char* name) {
 
             // we get the strides directly from the array
             // (since we use the strides, we don't care if it's rowmajor
-            // or colmajor, the read will handle it smoothly)
+            // or colmajor, the write will handle it smoothly)
 
-            // Ensure the numpy array is mutable and get a pointer to its data
             pybind11::buffer_info buf_info = arr.request();
 
-            if (PyEigenIPC::Utils::CheckInputBuffer<Layout>(buf_info)) { // check if buffer is OK
-
-                // we first create a lightweight TensorView of the buffer memory
-                Scalar* start_ptr = static_cast<Scalar*>(buf_info.ptr);
-                EigenIPC::TensorView<Scalar, Layout> output_t(start_ptr, // start pointer
-                                  buf_info.shape[0], // rows
-                                  buf_info.shape[1], // cols
-                                  PyEigenIPC::Utils::ToEigenStrides<Scalar, Layout>(buf_info) // strides
-                                );
-
-                // we use EigenIPC API to write to shared memory
-                return self.write(output_t, row, col);
-
-            } else {
-
-                return false;
-
-            }
+            return PyEigenIPC::Utils::WriteArray<Scalar, Layout>(self, buf_info, row, col);
 
         })
 
@@ -68,27 +50,9 @@ void PyEigenIPC::PyClient::bindClientT(pybind11::module &m, const char* name) {
             // (since we use the strides, we don't care if it's rowmajor
             // or colmajor, the read will handle it smoothly)
 
-            // Ensure the numpy array is mutable and get a pointer to its data
             pybind11::buffer_info buf_info = arr.request();
 
-            if (PyEigenIPC::Utils::CheckInputBuffer<Layout>(buf_info)) { // check if buffer is OK
-
-                // we first create a lightweight TensorView of the buffer memory
-                Scalar* start_ptr = static_cast<Scalar*>(buf_info.ptr);
-                EigenIPC::TensorView<Scalar, Layout> output_t(start_ptr, // start pointer
-                                  buf_info.shape[0], // rows
-                                  buf_info.shape[1], // cols
-                                  PyEigenIPC::Utils::ToEigenStrides<Scalar, Layout>(buf_info) // strides
-                                );
-
-                // we use EigenIPC API to write to shared memory
-                return self.read(output_t, row, col);
-
-            } else {
-
-                return false;
-
-            }
+            return PyEigenIPC::Utils::ReadArray<Scalar, Layout>(self, buf_info, row, col);
 
         })
 
@@ -100,6 +64,10 @@ void PyEigenIPC::PyClient::bindClientT(pybind11::module &m, const char* name) {
 
         .def("isRunning", &EigenIPC::Client<Scalar, Layout>::isAttached)
 
+        .def("getNotifyFd", &EigenIPC::Client<Scalar, Layout>::getNotifyFd)
+
+        .def("clearNotify", &EigenIPC::Client<Scalar, Layout>::clearNotify)
+
         .def("getScalarType", &EigenIPC::Client<Scalar, Layout>::getScalarType)
 
         .def("getNRows", &EigenIPC::Client<Scalar, Layout>::getNRows)
@@ -202,24 +170,22 @@ pybind11::object PyEigenIPC::PyClient::ClientFactory(std::string basename,
 
 void PyEigenIPC::PyClient::bind_ClientWrapper(pybind11::module& m) {
 
-    // By handling everything in Python-space,
-    // we eliminate the need to handle the type
-    // conversion in C++, making the ClientWrapper
-    // agnostic to the actual data type of the underlying Client.
-
-    // Here we lose a bit of performance wrt using the bare class bindings,
-    // since additional logic and checks are necessary. However, we gain
-    // much cleaner interface and flexibility
-
-    // (here we are calling python code from C++)
+    // Type-agnostic Client: it wraps any of the typed Clients (e.g. the ones
+    // returned by ClientFactory). The concrete type is resolved only once,
+    // when wrapping, so that each call is dispatched directly to the
+    // C++ Client (no Python attribute lookups or scalar type queries).
+    // The only runtime check left is the dtype of the arrays passed to
+    // write/read (checked at compile time in C++)
 
     pybind11::class_<PyEigenIPC::ClientWrapper> cls(m, "Client");
 
+    cls.def(pybind11::init<pybind11::object>(), pybind11::arg("client"));
+
     cls.def("attach", [](PyEigenIPC::ClientWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& client) {
+        wrapper.execute([](auto& client) {
 
-            return client.attr("attach")(); // calls the attach (from Client's PY bindings)
+            client.attach();
 
         });
 
@@ -227,9 +193,30 @@ void PyEigenIPC::PyClient::bind_ClientWrapper(pybind11::module& m) {
 
     cls.def("detach", [](PyEigenIPC::ClientWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& client) {
+        wrapper.execute([](auto& client) {
 
-            return client.attr("detach")();
+            client.detach();
+
+        });
+
+    });
+
+    cls.def("getNotifyFd", [](PyEigenIPC::ClientWrapper& wrapper) {
+
+        // e.g. for asyncio's loop.add_reader()
+        return wrapper.execute([](auto& client) {
+
+            return client.getNotifyFd();
+
+        });
+
+    });
+
+    cls.def("clearNotify", [](PyEigenIPC::ClientWrapper& wrapper) {
+
+        return wrapper.execute([](auto& client) {
+
+            return client.clearNotify();
 
         });
 
@@ -237,9 +224,9 @@ void PyEigenIPC::PyClient::bind_ClientWrapper(pybind11::module& m) {
 
     cls.def("close", [](PyEigenIPC::ClientWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& client) {
+        wrapper.execute([](auto& client) {
 
-            return client.attr("close")();
+            client.close();
 
         });
 
@@ -247,9 +234,9 @@ void PyEigenIPC::PyClient::bind_ClientWrapper(pybind11::module& m) {
 
     cls.def("isRunning", [](PyEigenIPC::ClientWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& client) {
+        return wrapper.execute([](auto& client) {
 
-            return client.attr("isRunning")().cast<bool>();
+            return client.isAttached();
 
         });
 
@@ -257,9 +244,9 @@ void PyEigenIPC::PyClient::bind_ClientWrapper(pybind11::module& m) {
 
     cls.def("getNRows", [](PyEigenIPC::ClientWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& client) {
+        return wrapper.execute([](auto& client) {
 
-            return client.attr("getNRows")().cast<int>();
+            return client.getNRows();
 
         });
 
@@ -267,9 +254,9 @@ void PyEigenIPC::PyClient::bind_ClientWrapper(pybind11::module& m) {
 
     cls.def("getNCols", [](PyEigenIPC::ClientWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& client) {
+        return wrapper.execute([](auto& client) {
 
-            return client.attr("getNCols")().cast<int>();
+            return client.getNCols();
 
         });
 
@@ -277,9 +264,9 @@ void PyEigenIPC::PyClient::bind_ClientWrapper(pybind11::module& m) {
 
     cls.def("getScalarType", [](PyEigenIPC::ClientWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& client) {
+        return wrapper.execute([](auto& client) {
 
-            return client.attr("getScalarType")().cast<DType>();
+            return client.getScalarType();
 
         });
 
@@ -287,9 +274,9 @@ void PyEigenIPC::PyClient::bind_ClientWrapper(pybind11::module& m) {
 
     cls.def("getNamespace", [](PyEigenIPC::ClientWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& client) {
+        return wrapper.execute([](auto& client) {
 
-            return client.attr("getNamespace")().cast<std::string>();
+            return client.getNamespace();
 
         });
 
@@ -297,9 +284,9 @@ void PyEigenIPC::PyClient::bind_ClientWrapper(pybind11::module& m) {
 
     cls.def("getBasename", [](PyEigenIPC::ClientWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& client) {
+        return wrapper.execute([](auto& client) {
 
-            return client.attr("getBasename")().cast<std::string>();
+            return client.getBasename();
 
         });
 
@@ -307,9 +294,9 @@ void PyEigenIPC::PyClient::bind_ClientWrapper(pybind11::module& m) {
 
     cls.def("dataSemAcquire", [](PyEigenIPC::ClientWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& client) {
+        wrapper.execute([](auto& client) {
 
-            return client.attr("dataSemAcquire")();
+            client.dataSemAcquire();
 
         });
 
@@ -317,9 +304,9 @@ void PyEigenIPC::PyClient::bind_ClientWrapper(pybind11::module& m) {
 
     cls.def("dataSemRelease", [](PyEigenIPC::ClientWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& client) {
+        wrapper.execute([](auto& client) {
 
-            return client.attr("dataSemRelease")();
+            client.dataSemRelease();
 
         });
 
@@ -329,97 +316,19 @@ void PyEigenIPC::PyClient::bind_ClientWrapper(pybind11::module& m) {
                              pybind11::array& np_array,
                              int row, int col) {
 
-        return wrapper.execute([&](pybind11::object& client) -> bool {
-
-            // we need to check data compatibility at runtime
-            // (this was not necessary in C++, since it's something
-            // checked at compile time)
-            // this introduces a slight overhead, but avoids unpredicted
-            // behavior when the user passes non-compatible types
-
-            // and of the input np array
-            pybind11::dtype np_dtype = np_array.dtype();
-
-            switch (client.attr("getScalarType")().cast<DType>()) {
-
-            case DType::Bool:
-
-                if (!np_dtype.is(pybind11::dtype::of<bool>())) {
-
-                    std::string error = std::string("Mismatched dtype: expected bool numpy array but got ") +
-                                    pybind11::str(np_dtype).cast<std::string>();
-
-                    EigenIPC::Journal::log("Client",
-                                 "write",
-                                 error,
-                                 LogType::EXCEP,
-                                 true);
-
-                }
-
-                break;
-
-            case DType::Int:
-
-                if (!np_dtype.is(pybind11::dtype::of<int>())) {
-
-                    std::string error = std::string("Mismatched dtype: expected int numpy array but got ") +
-                                    pybind11::str(np_dtype).cast<std::string>();
+        return wrapper.execute([&](auto& client) -> bool {
 
-                    EigenIPC::Journal::log("Client",
-                                 "write",
-                                 error,
-                                 LogType::EXCEP,
-                                 true);
-                }
-
-                break;
-
-            case DType::Float:
-
-                if (!np_dtype.is(pybind11::dtype::of<float>())) {
-
-                    std::string error = std::string("Mismatched dtype: expected float numpy array but got ") +
-                                    pybind11::str(np_dtype).cast<std::string>();
-
-                    EigenIPC::Journal::log("Client",
-                                 "write",
-                                 error,
-                                 LogType::EXCEP,
-                                 true);
-                }
-
-                break;
-
-            case DType::Double:
+            using Traits = PyEigenIPC::ShMemTraits<std::decay_t<decltype(client)>>;
 
-                if (!np_dtype.is(pybind11::dtype::of<double>())) {
-
-                    std::string error = std::string("Mismatched dtype: expected double numpy array but got ") +
-                                    pybind11::str(np_dtype).cast<std::string>();
-
-                    EigenIPC::Journal::log("Client",
-                                 "write",
-                                 error,
-                                 LogType::EXCEP,
-                                 true);
-                }
+            // throws if the array is not compatible with the Client
+            PyEigenIPC::Utils::CheckDType<typename Traits::Scalar>(np_array.dtype(),
+                                "Client", "write");
 
-                break;
+            pybind11::buffer_info buf_info = np_array.request();
 
-            default:
-
-                EigenIPC::Journal::log("Client",
-                             "write",
-                             "Mismatched dtype: provided dtype not supported.",
-                             LogType::EXCEP,
-                             true);
-
-            }
-
-            // now we can safely read the tensor
-            return client.attr("write")(np_array,
-                                             row, col).cast<bool>();
+            return PyEigenIPC::Utils::WriteArray<typename Traits::Scalar, Traits::Layout>(client,
+                                buf_info,
+                                row, col);
 
         });
 
@@ -429,97 +338,19 @@ void PyEigenIPC::PyClient::bind_ClientWrapper(pybind11::module& m) {
                              pybind11::array& np_array,
                              int row, int col) {
 
-        return wrapper.execute([&](pybind11::object& client) -> bool {
-
-            // we need to check data compatibility at runtime
-            // (this was not necessary in C++, since it's something
-            // checked at compile time)
-            // this introduces a slight overhead, but avoids unpredicted
-            // behavior when the user passes non-compatible types
-
-            // and of the input np array
-            pybind11::dtype np_dtype = np_array.dtype();
+        return wrapper.execute([&](auto& client) -> bool {
 
-            switch (client.attr("getScalarType")().cast<DType>()) {
+            using Traits = PyEigenIPC::ShMemTraits<std::decay_t<decltype(client)>>;
 
-            case DType::Bool:
-
-                if (!np_dtype.is(pybind11::dtype::of<bool>())) {
-
-                    std::string error = std::string("Mismatched dtype: expected bool numpy array but got ") +
-                                    pybind11::str(np_dtype).cast<std::string>();
-
-                    EigenIPC::Journal::log("Client",
-                                 "read",
-                                 error,
-                                 LogType::EXCEP,
-                                 true);
-
-                }
+            // throws if the array is not compatible with the Client
+            PyEigenIPC::Utils::CheckDType<typename Traits::Scalar>(np_array.dtype(),
+                                "Client", "read");
 
-                break;
-
-            case DType::Int:
-
-                if (!np_dtype.is(pybind11::dtype::of<int>())) {
-
-                    std::string error = std::string("Mismatched dtype: expected int numpy array but got ") +
-                                    pybind11::str(np_dtype).cast<std::string>();
-
-                    EigenIPC::Journal::log("Client",
-                                 "read",
-                                 error,
-                                 LogType::EXCEP,
-                                 true);
-                }
-
-                break;
-
-            case DType::Float:
-
-                if (!np_dtype.is(pybind11::dtype::of<float>())) {
-
-                    std::string error = std::string("Mismatched dtype: expected float numpy array but got ") +
-                                    pybind11::str(np_dtype).cast<std::string>();
-
-                    EigenIPC::Journal::log("Client",
-                                 "read",
-                                 error,
-                                 LogType::EXCEP,
-                                 true);
-                }
-
-                break;
-
-            case DType::Double:
-
-                if (!np_dtype.is(pybind11::dtype::of<double>())) {
-
-                    std::string error = std::string("Mismatched dtype: expected double numpy array but got ") +
-                                    pybind11::str(np_dtype).cast<std::string>();
-
-                    EigenIPC::Journal::log("Client",
-                                 "read",
-                                 error,
-                                 LogType::EXCEP,
-                                 true);
-                }
-
-                break;
-
-            default:
-
-                EigenIPC::Journal::log("Client",
-                             "read",
-                             "Mismatched dtype: provided dtype not supported.",
-                             LogType::EXCEP,
-                             true);
-
-            }
+            pybind11::buffer_info buf_info = np_array.request();
 
-            // now we can safely read the tensor
-            return client.attr("read")(np_array,
-                                             row, col).cast<bool>();
+            return PyEigenIPC::Utils::ReadArray<typename Traits::Scalar, Traits::Layout>(client,
+                                buf_info,
+                                row, col);
 
         });
 
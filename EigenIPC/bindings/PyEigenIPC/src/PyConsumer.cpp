@@ -18,5 +18,7 @@ void PyEigenIPC::PyConsumer::bind_Consumer(pybind11::module& m) {
 
         }, pybind11::arg("ms_timeout") = -1);
         cls.def("ack", &EigenIPC::Consumer::ack);
+        cls.def("get_notify_fd", &EigenIPC::Consumer::get_notify_fd);
+        cls.def("clear_notify", &EigenIPC::Consumer::clear_notify);
 
 }
\ No newline at end of file
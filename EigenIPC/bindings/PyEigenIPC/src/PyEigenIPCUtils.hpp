@@ -131,6 +131,81 @@ namespace PyEigenIPC {
 
         }
 
+        template<typename Scalar>
+        void CheckDType(const pybind11::dtype& np_dtype,
+                        const std::string& classname,
+                        const std::string& methodname) {
+
+            // throws if np_dtype does not match Scalar
+
+            if (!np_dtype.is(pybind11::dtype::of<Scalar>())) {
+
+                std::string error = std::string("Mismatched dtype: expected ") +
+                                pybind11::str(pybind11::dtype::of<Scalar>()).cast<std::string>() +
+                                std::string(" numpy array but got ") +
+                                pybind11::str(np_dtype).cast<std::string>();
+
+                EigenIPC::Journal::log(classname,
+                             methodname,
+                             error,
+                             LogType::EXCEP,
+                             true);
+
+            }
+
+        }
+
+        template<typename Scalar, int Layout>
+        EigenIPC::TensorView<Scalar, Layout> ToTensorView(pybind11::buffer_info& buf_info){
+
+            // lightweight view of the buffer memory (no copies)
+
+            return EigenIPC::TensorView<Scalar, Layout>(static_cast<Scalar*>(buf_info.ptr), // start pointer
+                                  buf_info.shape[0], // rows
+                                  buf_info.shape[1], // cols
+                                  ToEigenStrides<Scalar, Layout>(buf_info) // strides
+                                );
+
+        }
+
+        template<typename Scalar, int Layout, typename ShMem>
+        bool WriteArray(ShMem& shmem,
+                        pybind11::buffer_info& buf_info,
+                        int row, int col){
+
+            // writes the buffer to a Server/Client, using the EigenIPC API.
+            // Since we use the strides, we don't care if the buffer is rowmajor
+            // or colmajor, as long as it's coherent with Layout
+
+            if (!CheckInputBuffer<Layout>(buf_info)) {
+
+                return false;
+            }
+
+            EigenIPC::TensorView<Scalar, Layout> input_t = ToTensorView<Scalar, Layout>(buf_info);
+
+            return shmem.write(input_t, row, col);
+
+        }
+
+        template<typename Scalar, int Layout, typename ShMem>
+        bool ReadArray(ShMem& shmem,
+                       pybind11::buffer_info& buf_info,
+                       int row, int col){
+
+            // reads from a Server/Client into the buffer (see WriteArray)
+
+            if (!CheckInputBuffer<Layout>(buf_info)) {
+
+                return false;
+            }
+
+            EigenIPC::TensorView<Scalar, Layout> output_t = ToTensorView<Scalar, Layout>(buf_info);
+
+            return shmem.read(output_t, row, col);
+
+        }
+
     }
 
 }
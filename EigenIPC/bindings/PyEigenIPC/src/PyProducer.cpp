@@ -14,6 +14,7 @@ void PyEigenIPC::PyProducer::bind_Producer(pybind11::module& m) {
         cls.def("run", &EigenIPC::Producer::run);
         cls.def("close", &EigenIPC::Producer::close);
         cls.def("trigger", &EigenIPC::Producer::trigger);
+        cls.def("enable_notify_fd", &EigenIPC::Producer::enable_notify_fd);
         cls.def("wait_ack_from", [](EigenIPC::Producer& self, 
                         int n_consumers,
                         int ms_timeout) {
@@ -33,29 +33,11 @@ void PyEigenIPC::PyServer::bindServerT(pybind11::module &m, const char* name) {
 
             // we get the strides directly from the array
             // (since we use the strides, we don't care if it's rowmajor
-            // or colmajor, the read will handle it smoothly)
+            // or colmajor, the write will handle it smoothly)
 
-            // Ensure the numpy array is mutable and get a pointer to its data
             pybind11::buffer_info buf_info = arr.request();
 
-            if (PyEigenIPC::Utils::CheckInputBuffer<Layout>(buf_info)) { // check if buffer is OK
-
-                // we first create a lightweight TensorView of the buffer memory
-                Scalar* start_ptr = static_cast<Scalar*>(buf_info.ptr);
-                EigenIPC::TensorView<Scalar, Layout> output_t(start_ptr, // start pointer
-                                  buf_info.shape[0], // rows
-                                  buf_info.shape[1], // cols
-                                  PyEigenIPC::Utils::ToEigenStrides<Scalar, Layout>(buf_info) // strides
-                                );
-
-                // we use EigenIPC API to write to shared memory
-                return self.write(output_t, row, col);
-
-            } else {
-
-                return false;
-
-            }
+            return PyEigenIPC::Utils::WriteArray<Scalar, Layout>(self, buf_info, row, col);
 
         })
 
@@ -67,27 +49,9 @@ void PyEigenIPC::PyServer::bindServerT(pybind11::module &m, const char* name) {
             // (since we use the strides, we don't care if it's rowmajor
             // or colmajor, the read will handle it smoothly)
 
-            // Ensure the numpy array is mutable and get a pointer to its data
             pybind11::buffer_info buf_info = arr.request();
 
-            if (PyEigenIPC::Utils::CheckInputBuffer<Layout>(buf_info)) { // check if buffer is OK
-
-                // we first create a lightweight TensorView of the buffer memory
-                Scalar* start_ptr = static_cast<Scalar*>(buf_info.ptr);
-                EigenIPC::TensorView<Scalar, Layout> output_t(start_ptr, // start pointer
-                                  buf_info.shape[0], // rows
-                                  buf_info.shape[1], // cols
-                                  PyEigenIPC::Utils::ToEigenStrides<Scalar, Layout>(buf_info) // strides
-                                );
-
-                // we use EigenIPC API to write to shared memory
-                return self.read(output_t, row, col);
-
-            } else {
-
-                return false;
-
-            }
+            return PyEigenIPC::Utils::ReadArray<Scalar, Layout>(self, buf_info, row, col);
 
         })
 
@@ -103,6 +67,8 @@ void PyEigenIPC::PyServer::bindServerT(pybind11::module &m, const char* name) {
 
         .def("getNClients", &EigenIPC::Server<Scalar, Layout>::getNClients)
 
+        .def("enableNotifyFd", &EigenIPC::Server<Scalar, Layout>::enableNotifyFd)
+
         .def("getNRows", &EigenIPC::Server<Scalar, Layout>::getNRows)
 
         .def("getNCols", &EigenIPC::Server<Scalar, Layout>::getNCols)
@@ -206,24 +172,22 @@ pybind11::object PyEigenIPC::PyServer::ServerFactory(int n_rows,
 
 void PyEigenIPC::PyServer::bind_ServerWrapper(pybind11::module& m) {
 
-    // By handling everything in Python-space,
-    // we eliminate the need to handle the type
-    // conversion in C++, making the ServerWrapper
-    // agnostic to the actual data type of the underlying Server.
-
-    // Here we lose a bit of performance wrt using the bare class bindings,
-    // since additional logic and checks are necessary. However, we gain
-    // much cleaner interface and flexibility
-
-    // (here we are calling python code from C++)
+    // Type-agnostic Server: it wraps any of the typed Servers (e.g. the ones
+    // returned by ServerFactory). The concrete type is resolved only once,
+    // when wrapping, so that each call is dispatched directly to the
+    // C++ Server (no Python attribute lookups or scalar type queries).
+    // The only runtime check left is the dtype of the arrays passed to
+    // write/read (checked at compile time in C++)
 
     pybind11::class_<PyEigenIPC::ServerWrapper> cls(m, "Server");
 
+    cls.def(pybind11::init<pybind11::object>(), pybind11::arg("server"));
+
     cls.def("run", [](PyEigenIPC::ServerWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& server) {
+        wrapper.execute([](auto& server) {
 
-            return server.attr("run")();
+            server.run();
 
         });
 
@@ -231,9 +195,9 @@ void PyEigenIPC::PyServer::bind_ServerWrapper(pybind11::module& m) {
 
     cls.def("stop", [](PyEigenIPC::ServerWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& server) {
+        wrapper.execute([](auto& server) {
 
-            return server.attr("stop")();
+            server.stop();
 
         });
 
@@ -241,9 +205,9 @@ void PyEigenIPC::PyServer::bind_ServerWrapper(pybind11::module& m) {
 
     cls.def("close", [](PyEigenIPC::ServerWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& server) {
+        wrapper.execute([](auto& server) {
 
-            return server.attr("close")();
+            server.close();
 
         });
 
@@ -251,9 +215,9 @@ void PyEigenIPC::PyServer::bind_ServerWrapper(pybind11::module& m) {
 
     cls.def("isRunning", [](PyEigenIPC::ServerWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& server) {
+        return wrapper.execute([](auto& server) {
 
-            return server.attr("isRunning")().cast<bool>();
+            return server.isRunning();
 
         });
 
@@ -261,9 +225,19 @@ void PyEigenIPC::PyServer::bind_ServerWrapper(pybind11::module& m) {
 
     cls.def("getNClients", [](PyEigenIPC::ServerWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& server) {
+        return wrapper.execute([](auto& server) {
+
+            return server.getNClients();
+
+        });
+
+    });
+
+    cls.def("enableNotifyFd", [](PyEigenIPC::ServerWrapper& wrapper) {
+
+        return wrapper.execute([](auto& server) {
 
-            return server.attr("getNClients")().cast<int>();
+            return server.enableNotifyFd();
 
         });
 
@@ -271,9 +245,9 @@ void PyEigenIPC::PyServer::bind_ServerWrapper(pybind11::module& m) {
 
     cls.def("getNRows", [](PyEigenIPC::ServerWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& server) {
+        return wrapper.execute([](auto& server) {
 
-            return server.attr("getNRows")().cast<int>();
+            return server.getNRows();
 
         });
 
@@ -281,9 +255,9 @@ void PyEigenIPC::PyServer::bind_ServerWrapper(pybind11::module& m) {
 
     cls.def("getNCols", [](PyEigenIPC::ServerWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& server) {
+        return wrapper.execute([](auto& server) {
 
-            return server.attr("getNCols")().cast<int>();
+            return server.getNCols();
 
         });
 
@@ -291,9 +265,9 @@ void PyEigenIPC::PyServer::bind_ServerWrapper(pybind11::module& m) {
 
     cls.def("getScalarType", [](PyEigenIPC::ServerWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& server) {
+        return wrapper.execute([](auto& server) {
 
-            return server.attr("getScalarType")().cast<DType>();
+            return server.getScalarType();
 
         });
 
@@ -301,9 +275,9 @@ void PyEigenIPC::PyServer::bind_ServerWrapper(pybind11::module& m) {
 
     cls.def("getNamespace", [](PyEigenIPC::ServerWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& server) {
+        return wrapper.execute([](auto& server) {
 
-            return server.attr("getNamespace")().cast<std::string>();
+            return server.getNamespace();
 
         });
 
@@ -311,9 +285,9 @@ void PyEigenIPC::PyServer::bind_ServerWrapper(pybind11::module& m) {
 
     cls.def("getBasename", [](PyEigenIPC::ServerWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& server) {
+        return wrapper.execute([](auto& server) {
 
-            return server.attr("getBasename")().cast<std::string>();
+            return server.getBasename();
 
         });
 
@@ -321,9 +295,9 @@ void PyEigenIPC::PyServer::bind_ServerWrapper(pybind11::module& m) {
 
     cls.def("dataSemAcquire", [](PyEigenIPC::ServerWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& server) {
+        wrapper.execute([](auto& server) {
 
-            return server.attr("dataSemAcquire")();
+            server.dataSemAcquire();
 
         });
 
@@ -331,9 +305,9 @@ void PyEigenIPC::PyServer::bind_ServerWrapper(pybind11::module& m) {
 
     cls.def("dataSemRelease", [](PyEigenIPC::ServerWrapper& wrapper) {
 
-        return wrapper.execute([&](pybind11::object& server) {
+        wrapper.execute([](auto& server) {
 
-            return server.attr("dataSemRelease")();
+            server.dataSemRelease();
 
         });
 
@@ -343,99 +317,19 @@ void PyEigenIPC::PyServer::bind_ServerWrapper(pybind11::module& m) {
                              pybind11::array& np_array,
                              int row, int col) {
 
-        return wrapper.execute([&](pybind11::object& server) -> bool {
+        return wrapper.execute([&](auto& server) -> bool {
 
-            // we need to check data compatibility at runtime
-            // (this was not necessary in C++, since it's something
-            // checked at compile time)
-            // this introduces a slight overhead, but avoids unpredicted
-            // behavior when the user passes non-compatible types
+            using Traits = PyEigenIPC::ShMemTraits<std::decay_t<decltype(server)>>;
 
-            // and of the input np array
-            pybind11::dtype np_dtype = np_array.dtype();
+            // throws if the array is not compatible with the Server
+            PyEigenIPC::Utils::CheckDType<typename Traits::Scalar>(np_array.dtype(),
+                                "Server", "write");
 
             pybind11::buffer_info buf_info = np_array.request();
 
-            switch (server.attr("getScalarType")().cast<DType>()) {
-
-            case DType::Bool:
-
-                if (!np_dtype.is(pybind11::dtype::of<bool>())) {
-
-                    std::string error = std::string("Mismatched dtype: expected bool numpy array but got ") +
-                                    pybind11::str(np_dtype).cast<std::string>();
-
-                    EigenIPC::Journal::log("Server",
-                                 "write",
-                                 error,
-                                 LogType::EXCEP,
-                                 true);
-
-                }
-
-                break;
-
-            case DType::Int:
-
-                if (!np_dtype.is(pybind11::dtype::of<int>())) {
-
-                    std::string error = std::string("Mismatched dtype: expected int numpy array but got ") +
-                                    pybind11::str(np_dtype).cast<std::string>();
-
-                    EigenIPC::Journal::log("Server",
-                                 "write",
-                                 error,
-                                 LogType::EXCEP,
-                                 true);
-                }
-
-                break;
-
-            case DType::Float:
-
-                if (!np_dtype.is(pybind11::dtype::of<float>())) {
-
-                    std::string error = std::string("Mismatched dtype: expected float numpy array but got ") +
-                                    pybind11::str(np_dtype).cast<std::string>();
-
-                    EigenIPC::Journal::log("Server",
-                                 "write",
-                                 error,
-                                 LogType::EXCEP,
-                                 true);
-                }
-
-                break;
-
-            case DType::Double:
-
-                if (!np_dtype.is(pybind11::dtype::of<double>())) {
-
-                    std::string error = std::string("Mismatched dtype: expected double numpy array but got ") +
-                                    pybind11::str(np_dtype).cast<std::string>();
-
-                    EigenIPC::Journal::log("Server",
-                                 "write",
-                                 error,
-                                 LogType::EXCEP,
-                                 true);
-                }
-
-                break;
-
-            default:
-
-                EigenIPC::Journal::log("Server",
-                             "write",
-                             "Mismatched dtype: provided dtype not supported.",
-                             LogType::EXCEP,
-                             true);
-
-            }
-
-            // now we can safely read the tensor
-            return server.attr("write")(np_array,
-                                             row, col).cast<bool>();
+            return PyEigenIPC::Utils::WriteArray<typename Traits::Scalar, Traits::Layout>(server,
+                                buf_info,
+                                row, col);
 
         });
 
@@ -445,97 +339,19 @@ void PyEigenIPC::PyServer::bind_ServerWrapper(pybind11::module& m) {
                              pybind11::array& np_array,
                              int row, int col) {
 
-        return wrapper.execute([&](pybind11::object& server) -> bool {
-
-            // we need to check data compatibility at runtime
-            // (this was not necessary in C++, since it's something
-            // checked at compile time)
-            // this introduces a slight overhead, but avoids unpredicted
-            // behavior when the user passes non-compatible types
-
-            // and of the input np array
-            pybind11::dtype np_dtype = np_array.dtype();
-
-            switch (server.attr("getScalarType")().cast<DType>()) {
-
-            case DType::Bool:
-
-                if (!np_dtype.is(pybind11::dtype::of<bool>())) {
-
-                    std::string error = std::string("Mismatched dtype: expected bool numpy array but got ") +
-                                    pybind11::str(np_dtype).cast<std::string>();
-
-                    EigenIPC::Journal::log("Server",
-                                 "read",
-                                 error,
-                                 LogType::EXCEP,
-                                 true);
-
-                }
-
-                break;
-
-            case DType::Int:
-
-                if (!np_dtype.is(pybind11::dtype::of<int>())) {
-
-                    std::string error = std::string("Mismatched dtype: expected int numpy array but got ") +
-                                    pybind11::str(np_dtype).cast<std::string>();
-
-                    EigenIPC::Journal::log("Server",
-                                 "read",
-                                 error,
-                                 LogType::EXCEP,
-                                 true);
-                }
+        return wrapper.execute([&](auto& server) -> bool {
 
-                break;
-
-            case DType::Float:
-
-                if (!np_dtype.is(pybind11::dtype::of<float>())) {
-
-                    std::string error = std::string("Mismatched dtype: expected float numpy array but got ") +
-                                    pybind11::str(np_dtype).cast<std::string>();
-
-                    EigenIPC::Journal::log("Server",
-                                 "read",
-                                 error,
-                                 LogType::EXCEP,
-                                 true);
-                }
+            using Traits = PyEigenIPC::ShMemTraits<std::decay_t<decltype(server)>>;
 
-                break;
+            // throws if the array is not compatible with the Server
+            PyEigenIPC::Utils::CheckDType<typename Traits::Scalar>(np_array.dtype(),
+                                "Server", "read");
 
-            case DType::Double:
-
-                if (!np_dtype.is(pybind11::dtype::of<double>())) {
-
-                    std::string error = std::string("Mismatched dtype: expected double numpy array but got ") +
-                                    pybind11::str(np_dtype).cast<std::string>();
-
-                    EigenIPC::Journal::log("Server",
-                                 "read",
-                                 error,
-                                 LogType::EXCEP,
-                                 true);
-                }
-
-                break;
-
-            default:
-
-                EigenIPC::Journal::log("Server",
-                             "read",
-                             "Mismatched dtype: provided dtype not supported.",
-                             LogType::EXCEP,
-                             true);
-
-            }
+            pybind11::buffer_info buf_info = np_array.request();
 
-            // now we can safely read the tensor
-            return server.attr("read")(np_array,
-                                             row, col).cast<bool>();
+            return PyEigenIPC::Utils::ReadArray<typename Traits::Scalar, Traits::Layout>(server,
+                                buf_info,
+                                row, col);
 
         });
 
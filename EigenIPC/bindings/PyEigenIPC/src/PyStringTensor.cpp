@@ -34,20 +34,23 @@ void PyEigenIPC::PyStringTensor::declare_StringTensorServer(py::module &m) {
 
     py::class_<StringTensor<StrServer>>(m, pyclass_name.c_str())
 
-        .def(py::init<int, std::string, std::string, bool, VLevel, bool, bool>(),
+        .def(py::init<int, std::string, std::string, bool, VLevel, bool, bool, int>(),
              py::arg("length"),
              py::arg("basename") = "MySharedMemory",
              py::arg("name_space") = "",
              py::arg("verbose") = false,
              py::arg("vlevel") = VLevel::V0,
              py::arg("force_reconnection") = false,
-             py::arg("safe") = true)
+             py::arg("safe") = true,
+             py::arg("arena_bytes") = -1)
 
         .def("run", &StringTensor<StrServer>::run)
 
         // Add other method bindings here ...
         .def("isRunning", &StringTensor<StrServer>::isRunning)
 
+        .def("isStale", &StringTensor<StrServer>::isStale)
+
         .def("length", &StringTensor<StrServer>::getLength)
 
         .def("getNamespace", &StringTensor<StrServer>::getNamespace)
@@ -150,6 +153,8 @@ void PyEigenIPC::PyStringTensor::declare_StringTensorClient(py::module &m) {
         // Add other method bindings here ...
         .def("isRunning", &StringTensor<StrClient>::isRunning)
 
+        .def("isStale", &StringTensor<StrClient>::isStale)
+
         .def("length", &StringTensor<StrClient>::getLength)
 
         .def("getNamespace", &StringTensor<StrClient>::getNamespace)
@@ -21,21 +21,59 @@
 #include <pybind11/pybind11.h>
 #include <memory>
 #include <type_traits>
+#include <variant>
+
+#include <EigenIPC/Server.hpp>
+#include <EigenIPC/Client.hpp>
 
 namespace PyEigenIPC {
 
+    // all the concrete Servers/Clients the factories can create
+    template <template <typename, int> class ShMem>
+    using ShMemPtr = std::variant<
+                        std::shared_ptr<ShMem<bool, EigenIPC::ColMajor>>,
+                        std::shared_ptr<ShMem<bool, EigenIPC::RowMajor>>,
+                        std::shared_ptr<ShMem<int, EigenIPC::ColMajor>>,
+                        std::shared_ptr<ShMem<int, EigenIPC::RowMajor>>,
+                        std::shared_ptr<ShMem<float, EigenIPC::ColMajor>>,
+                        std::shared_ptr<ShMem<float, EigenIPC::RowMajor>>,
+                        std::shared_ptr<ShMem<double, EigenIPC::ColMajor>>,
+                        std::shared_ptr<ShMem<double, EigenIPC::RowMajor>>>;
+
+    // scalar type and layout of a concrete Server/Client
+    template <typename ShMem>
+    struct ShMemTraits;
+
+    template <template <typename, int> class ShMem, typename S, int L>
+    struct ShMemTraits<ShMem<S, L>> {
+
+        using Scalar = S;
+
+        static constexpr int Layout = L;
+
+    };
+
+    // The wrappers resolve the concrete Server/Client behind a Python object
+    // once, at construction. execute() then calls f directly on it (f has to
+    // accept any of the concrete types, e.g. a generic lambda), without
+    // going through Python attribute lookups
+
     class ClientWrapper {
 
         public:
 
-            ClientWrapper(pybind11::object* Obj);
+            ClientWrapper(pybind11::object client);
 
             template<typename Func>
-            auto execute(Func&& f) -> decltype(f(std::declval<pybind11::object&>()));
+            decltype(auto) execute(Func&& f);
 
         public:
 
-            std::unique_ptr<pybind11::object> wrapped;
+            pybind11::object wrapped; // keeps the Python object alive
+
+        private:
+
+            ShMemPtr<EigenIPC::Client> _client;
 
     };
 
@@ -43,14 +81,18 @@ namespace PyEigenIPC {
 
         public:
 
-            ServerWrapper(pybind11::object* Obj);
+            ServerWrapper(pybind11::object server);
 
             template<typename Func>
-            auto execute(Func&& f) -> decltype(f(std::declval<pybind11::object&>()));
+            decltype(auto) execute(Func&& f);
 
         public:
 
-            std::unique_ptr<pybind11::object> wrapped;
+            pybind11::object wrapped; // keeps the Python object alive
+
+        private:
+
+            ShMemPtr<EigenIPC::Server> _server;
 
     };
 
@@ -59,4 +101,3 @@ namespace PyEigenIPC {
 #include "WrapUtils.inl"
 
 #endif  // WRAPUTILS_HPP
-
@@ -1,23 +1,53 @@
+#include <stdexcept>
+
 namespace PyEigenIPC {
 
-    inline ClientWrapper::ClientWrapper(pybind11::object* Obj)
-        : wrapped(std::unique_ptr<pybind11::object>(Obj)) {
+    template <typename Variant, std::size_t I = 0>
+    Variant resolveShMem(pybind11::handle obj) {
+
+        // tries all the alternatives of Variant, in order
+        if constexpr (I == std::variant_size_v<Variant>) {
+
+            throw std::runtime_error(std::string("Cannot wrap an object of type ") +
+                    pybind11::str(pybind11::type::handle_of(obj)).cast<std::string>());
+
+        } else {
+
+            using Ptr = std::variant_alternative_t<I, Variant>;
+
+            if (pybind11::isinstance<typename Ptr::element_type>(obj)) {
+
+                return Variant(obj.cast<Ptr>());
+            }
+
+            return resolveShMem<Variant, I + 1>(obj);
+
+        }
+
+    }
+
+    inline ClientWrapper::ClientWrapper(pybind11::object client)
+        : wrapped(client),
+        _client(resolveShMem<ShMemPtr<EigenIPC::Client>>(client)) {
 
     }
 
     template<typename Func>
-    auto ClientWrapper::execute(Func&& f) -> decltype(f(std::declval<pybind11::object&>())) {
-        return f(*wrapped);
+    decltype(auto) ClientWrapper::execute(Func&& f) {
+        return std::visit([&](auto& client) -> decltype(auto) { return f(*client); },
+                        _client);
     }
 
-    inline ServerWrapper::ServerWrapper(pybind11::object* Obj)
-        : wrapped(std::unique_ptr<pybind11::object>(Obj)) {
+    inline ServerWrapper::ServerWrapper(pybind11::object server)
+        : wrapped(server),
+        _server(resolveShMem<ShMemPtr<EigenIPC::Server>>(server)) {
 
     }
 
     template<typename Func>
-    auto ServerWrapper::execute(Func&& f) -> decltype(f(std::declval<pybind11::object&>())) {
-        return f(*wrapped);
+    decltype(auto) ServerWrapper::execute(Func&& f) {
+        return std::visit([&](auto& server) -> decltype(auto) { return f(*server); },
+                        _server);
     }
 
 }
@@ -0,0 +1,169 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+// 
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+// 
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+// 
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef BROADCASTRING_HPP
+#define BROADCASTRING_HPP
+
+#include <Eigen/Dense>
+#include <string>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+// public headers
+#include <EigenIPC/SharedMemConfig.hpp>
+#include <EigenIPC/Journal.hpp>
+#include <EigenIPC/DTypes.hpp>
+#include <EigenIPC/ReturnCodes.hpp>
+
+namespace EigenIPC{
+
+    namespace SyncUtils{
+
+        struct BroadcastHeader; // private, ring state and cells (in shared memory)
+
+    }
+
+    // single-writer, multiple-reader ring of fixed-shape tensors (a shared log).
+    // Samples get increasing sequence numbers and every reader goes through all of
+    // them with its own cursor. The writer never waits: a reader which falls more
+    // than a ring behind loses the overwritten samples (and is told how many)
+    template <typename Scalar,
+              int Layout = MemLayoutDefault>
+    class BroadcastRing {
+
+        using VLevel = Journal::VLevel;
+        using LogType = Journal::LogType;
+
+        public:
+
+            typedef std::weak_ptr<BroadcastRing> WeakPtr;
+            typedef std::shared_ptr<BroadcastRing> Ptr;
+            typedef std::unique_ptr<BroadcastRing> UniquePtr;
+
+            BroadcastRing(std::string basename = "MyBroadcastRing",
+                    std::string name_space = "",
+                    bool verbose = false,
+                    VLevel vlevel = VLevel::V0);
+
+            ~BroadcastRing();
+
+            void create(int n_rows,
+                    int n_cols,
+                    int capacity, // number of samples kept
+                    bool force_reconnection = false); // as the (only) writer
+
+            void attach(); // as a reader (blocks until the ring is created). Only
+            // samples written from now on are read (see readLast() for older ones)
+
+            void close();
+
+            bool isRunning();
+
+            uint64_t append(const TRef<Scalar, Layout> data); // writer only.
+            // Returns the sequence number of the sample
+
+            bool tryRead(TRef<Scalar, Layout> output); // next sample after the
+            // cursor (false if there is none yet)
+
+            bool read(TRef<Scalar, Layout> output,
+                    int ms_timeout = -1); // waits for the next sample (false on
+            // timeout or if the writer is closed). ms_timeout < 0 -> no timeout
+
+            int readLast(std::vector<Tensor<Scalar, Layout>>& outputs,
+                    int k); // catches up: reads the last k samples (at most
+            // capacity - 1, whether already read or not) into the first entries of
+            // outputs (oldest first, only grown if needed) and moves the cursor to
+            // the head. Returns how many were read. Skipped samples are not counted as lost
+
+            uint64_t getHead(); // number of samples written so far
+            uint64_t getCursor(); // sequence number of the next sample to be read
+
+            uint64_t getLost(); // samples overwritten before this reader got to them
+
+            int getCapacity();
+
+            int getNRows();
+            int getNCols();
+
+            void set_wait_policy(WaitPolicy policy,
+                        int max_spin_us = 20); // for read()
+
+        private:
+
+            bool _verbose = false;
+
+            bool _is_writer = false;
+
+            bool _is_running = false;
+
+            int _n_rows = -1;
+            int _n_cols = -1;
+            int _capacity = -1;
+
+            uint64_t _cursor = 0;
+            uint64_t _lost = 0;
+
+            int _shm_fd = -1;
+
+            std::size_t _mem_size = 0;
+
+            WaitPolicy _wait_policy = WaitPolicy::SpinThenBlock; // see set_wait_policy()
+
+            long long _max_spin_ns = 20000;
+
+            double _avg_wait_ns = 0.0; // running average of the last waits
+
+            std::string _basename, _namespace, _unique_id;
+
+            std::string THISNAME = "EigenIPC::BroadcastRing";
+
+            std::string RING_BASENAME = "Broadcast";
+
+            VLevel _vlevel = VLevel::V0; // minimal debug info
+
+            Journal _journal; // for rt-friendly logging
+
+            SharedMemConfig _mem_config;
+
+            ReturnCode _return_code = ReturnCode::NONE;
+
+            SyncUtils::BroadcastHeader* _header = nullptr;
+
+            MMap<Scalar, Layout> _cellView(uint64_t seq);
+
+            bool _tryRead(TRef<Scalar, Layout>& output);
+
+            bool _readAt(uint64_t seq, TRef<Scalar, Layout>& output); // false
+            // if the sample was overwritten
+
+            bool _openRing(); // true if the ring is available
+
+            void _checkSize(int rows, int cols,
+                        std::string calling_method);
+
+            void _checkRunning(std::string calling_method);
+
+            std::string _getThisName(); // used to get this class
+            // name
+
+    };
+
+}
+
+#endif // BROADCASTRING_HPP
@@ -28,6 +28,7 @@
 #include <semaphore.h>
 #include <csignal>
 #include <memory>
+#include <vector>
 #include <thread>
 #include <chrono>
 
@@ -39,6 +40,12 @@
 
 namespace EigenIPC{
 
+    namespace SyncUtils{
+
+        struct MemHeader; // private, shared metadata and synchronization state
+
+    }
+
     template <typename Scalar,
               int Layout = MemLayoutDefault>
     class Client {
@@ -52,6 +59,60 @@ namespace EigenIPC{
             typedef std::shared_ptr<Client> Ptr;
             typedef std::unique_ptr<Client> UniquePtr;
 
+            // zero-copy, read-only view of a block of the shared tensor, borrowed
+            // through acquireView(). Depending on the sync mode, it holds the
+            // data lock (Lock, Striped) or records the data version (SeqLock, Ring)
+            // until releaseView() is called (automatically on destruction)
+            class ReadView {
+
+                friend class Client;
+
+                public:
+
+                    ReadView(ReadView&& other) noexcept
+                        : _client(other._client),
+                        _data(other._data),
+                        _epoch(other._epoch),
+                        _slot(other._slot),
+                        _stripe_first(other._stripe_first),
+                        _stripe_last(other._stripe_last)
+                    {
+                        other._client = nullptr; // ownership is transferred
+                    }
+
+                    ReadView(const ReadView&) = delete;
+                    ReadView& operator=(const ReadView&) = delete;
+                    ReadView& operator=(ReadView&&) = delete;
+
+                    ~ReadView() {
+
+                        if (_client != nullptr) {
+
+                            _client->releaseView(*this);
+                        }
+
+                    }
+
+                    bool isValid() const { return _client != nullptr; } // false if
+                    // acquisition failed or the view was already released
+
+                    const ConstBlockView<Scalar, Layout>& data() const { return _data; }
+
+                private:
+
+                    ReadView()
+                        : _data(nullptr, 0, 0, Eigen::OuterStride<>(0)) {}
+
+                    Client* _client = nullptr;
+
+                    ConstBlockView<Scalar, Layout> _data;
+
+                    uint64_t _epoch = 0; // data version at acquisition (SeqLock, Ring)
+                    int _slot = 0; // borrowed slot (Ring)
+                    int _stripe_first = 0, _stripe_last = 0; // held stripes (Striped)
+
+            };
+
             Client(std::string basename = "MySharedMemory",
                    std::string name_space = "",
                    bool verbose = false,
@@ -81,7 +142,31 @@ namespace EigenIPC{
             // underlying shared tensor data to a view of another
             // Tensor
 
-            void attach();
+            bool readChanged(TRef<Scalar, Layout> output,
+                            uint64_t& since_version,
+                            std::vector<int>& changed_rows); // only copies the rows
+            // written after since_version (all rows if since_version is 0) to the
+            // same rows of output, which are listed in changed_rows. since_version
+            // is then updated to the version output is now in sync with
+
+            bool waitForUpdate(int ms_timeout = -1); // blocks until the tensor
+            // is written again (by anyone) after the last call (or after attach()).
+            // Returns false on timeout or if the server stops. ms_timeout < 0 -> no timeout
+
+            int getNotifyFd(); // pollable (e.g. with epoll) fd, readable after the
+            // server writes or stops. -1 if not attached or if the server did not
+            // call enableNotifyFd(). Writes from clients are not signaled on it
+            // (see waitForUpdate()). Valid until detach()
+
+            uint64_t clearNotify(); // to be called when the fd is readable: rearms
+            // it and returns the number of notifications since the last call
+
+            void attach(); // blocks until the server is running
+
+            static bool attachAll(const std::vector<Client*>& clients,
+                        int ms_timeout = -1); // waits for all the servers at once and
+            // attaches each client as soon as its server runs. False on timeout
+            // (ms_timeout < 0 -> no timeout), with the clients attached so far left attached
             void detach();
 
             void close();
@@ -95,11 +180,26 @@ namespace EigenIPC{
 
             int getMemLayout() const;
 
+            uint64_t getDataVersion() const; // version of the last write (a single
+            // atomic load): it changes every time the tensor is written. 0 if the
+            // shared memory is not mapped
+
+            SyncMode getSyncMode() const; // as chosen by the server
+            // (only available after attach())
+
             std::string getNamespace() const;
             std::string getBasename() const;
 
-            void dataSemAcquire(); // acquire data sem (blocking)
-            void dataSemRelease(); // acquire data sem (blocking)
+            void dataSemAcquire(); // acquire data lock (blocking)
+            void dataSemRelease(); // release data lock
+
+            ReadView acquireView(int row, int col,
+                            int n_rows, int n_cols); // nonblocking: an invalid
+            // view is returned if the data is not available
+
+            bool releaseView(ReadView& view); // false if the data may have been
+            // modified while borrowed (SeqLock, Ring), in which case what was read
+            // through the view should be discarded
 
         protected:
 
@@ -121,24 +221,32 @@ namespace EigenIPC{
             int _n_cols = -1;
 
             int _data_shm_fd = -1; // shared memory file descriptor
-            int _nrows_shm_fd = -1;
-            int _ncols_shm_fd = -1;
-            int _n_clients_shm_fd = -1;
-            int _dtype_shm_fd = -1;
-            int _isrunning_shm_fd = -1;
-            int _mem_layout_shm_fd = -1;
+
+            int _client_slot = -1; // our entry in the server's client registry
+
+            std::size_t _mem_size = 0; // [bytes] of the whole mapped memory
 
             static const int _mem_layout = Layout;
 
             int _msg_counter = 0; // aux variable using for periodic logging
-            int _msg_sample_interval = 4000; // msg printed every n iterations
+            int _msg_sample_interval = 4000; // [ms] between messages while waiting
 
             std::string THISNAME = "EigenIPC::Client";
 
             std::string _basename, _namespace;
 
-            float _sem_acq_timeout = 0.0001;
-            struct timespec _sem_timeout;
+            SyncMode _sync_mode = SyncMode::Lock; // read from the server at attach()
+
+            int _stripe_first = 0, _stripe_last = 0; // stripes currently held
+            // (SyncMode::Striped)
+
+            uint32_t _last_generation = 0; // last write seen by waitForUpdate()
+
+            int _notify_fd = -1; // eventfd registered with the server
+            int _notify_conn_fd = -1; // keeps the registration alive
+
+            int _seq_max_retries = 100000; // max attempts at getting a
+            // consistent snapshot in SyncMode::SeqLock
 
             VLevel _vlevel = VLevel::V0; // minimal debug info
 
@@ -146,7 +254,12 @@ namespace EigenIPC{
 
             SharedMemConfig _mem_config;
 
-            sem_t* _data_sem = nullptr; // semaphore for safe data access
+            uint32_t _pid = 0; // identifies this process as owner of the data
+            // lock (which lives in the shared sync header). With SyncMode::SeqLock
+            // and SyncMode::Ring the lock only serializes writers
+
+            SyncUtils::MemHeader* _header = nullptr; // shared metadata and sync state
+            // (at the beginning of the tensor's shared segment)
 
             ReturnCode _return_code = ReturnCode::NONE; // overwritten by all methods
             // this is to avoid dyn. allocation
@@ -156,35 +269,42 @@ namespace EigenIPC{
             Tensor<Scalar, Layout> _tensor_copy; // copy (not view) of the tensor
 
             MMap<Scalar, Layout> _tensor_view; // view of the tensor
-            // auxiliary views
-            MMap<int, Layout> _n_rows_view,
-                      _n_cols_view,
-                      _n_clients_view,
-                      _dtype_view,
-                      _mem_layout_view;
-            MMap<bool, Layout> _isrunning_view;
-
-            void _acquireSemTimeout(const std::string& sem_path,
-                            sem_t*& sem,
-                            bool verbose = false);
-
-            bool _acquireSemOneShot(const std::string& sem_path,
-                             sem_t*& sem);
-            
-            void _acquireSemBlocking(const std::string& sem_path,
-                            sem_t*& sem,
-                            bool verbose = false);
-
-            void _releaseSem(const std::string& sem_path,
-                        sem_t*& sem,
-                        bool verbose = false);
 
             bool _acquireData(bool blocking = false,
                             bool verbose = false);
             void _releaseData();
 
+            bool _acquireBlock(int row, int n_rows); // acquires whatever protects
+            // the given rows (nonblocking)
+            void _releaseBlock();
+
+            template <typename DataT>
+            bool _ringWrite(const DataT& data,
+                        int row, int col); // fills and publishes the next slot
+
+            template <typename DataT>
+            bool _write(const DataT& data,
+                        int row, int col);
+
+            template <typename OutT>
+            bool _read(OutT& output,
+                        int row, int col);
+
+            bool _copyChanged(TRef<Scalar, Layout> output,
+                        const MMap<Scalar, Layout>& data,
+                        uint64_t since_version,
+                        std::vector<int>& changed_rows);
+
             void _waitForServer();
 
+            bool _isServerReady(); // nonblocking: server memory mapped and running
+
+            void _completeAttach(); // once the server is ready
+
+            void _checkVersion();
+
+            bool _mapMem(); // true if the server's memory is mapped and initialized
+
             std::string _getThisName(); // used to get this class
             // name
 
@@ -193,13 +313,7 @@ namespace EigenIPC{
             // consistent with Server
 
             void _initDataMem();
-            void _initMetaMem();
-
-            void _initSems();
-
-            void _closeSems();
 
-            void _cleanMetaMem();
             void _cleanMems();
 
             void _checkIsAttached();
@@ -18,13 +18,12 @@
 #ifndef CONDVAR_HPP
 #define CONDVAR_HPP
 
+#include <atomic>
+#include <cstdint>
 #include <chrono>
 #include <thread>
 #include <memory>
-
-#include <boost/interprocess/sync/named_condition.hpp>
-#include <boost/interprocess/sync/named_mutex.hpp>
-#include <boost/date_time/posix_time/posix_time.hpp>
+#include <functional>
 
 // public headers
 #include <EigenIPC/SharedMemConfig.hpp>
@@ -34,6 +33,12 @@
 
 namespace EigenIPC{
 
+    namespace SyncUtils{
+
+        struct CondVarState; // private, mutex and condition state (in shared memory)
+
+    }
+
     class ConditionVariable{
 
         using VLevel = Journal::VLevel;
@@ -41,9 +46,71 @@ namespace EigenIPC{
 
         public:
 
-            using NamedCondition = boost::interprocess::named_condition;
-            using NamedMutex = boost::interprocess::named_mutex;
-            using ScopedLock = boost::interprocess::scoped_lock<NamedMutex>;
+            // process-shared futex mutex (robust: a lock held by a dead
+            // process is taken over by the next one acquiring it)
+            class NamedMutex {
+
+                friend class ConditionVariable;
+
+                public:
+
+                    NamedMutex(NamedMutex&& other) noexcept;
+
+                    NamedMutex(const NamedMutex&) = delete;
+                    NamedMutex& operator=(const NamedMutex&) = delete;
+                    NamedMutex& operator=(NamedMutex&&) = delete;
+
+                    ~NamedMutex(); // unmaps its own segment, if any
+
+                    void lock();
+                    bool try_lock();
+                    void unlock();
+
+                    bool isUnlinked() const; // true if its segment was unlinked
+                    // (e.g. by a new owner), i.e. its name may now refer to another mutex
+
+                private:
+
+                    NamedMutex() = default;
+
+                    std::atomic<uint32_t>* _word = nullptr;
+
+                    void* _mem = nullptr; // own segment (create_named_mutex)
+                    int _shm_fd = -1;
+
+                    uint32_t _pid = 0;
+
+                    ReturnCode _return_code = ReturnCode::NONE;
+
+            };
+
+            // owns the lock of a NamedMutex until unlocked or destroyed
+            class ScopedLock {
+
+                public:
+
+                    explicit ScopedLock(NamedMutex& mutex); // acquires it
+
+                    ScopedLock(ScopedLock&& other) noexcept;
+                    ScopedLock& operator=(ScopedLock&& other) noexcept;
+
+                    ScopedLock(const ScopedLock&) = delete;
+                    ScopedLock& operator=(const ScopedLock&) = delete;
+
+                    ~ScopedLock();
+
+                    void lock();
+                    void unlock();
+
+                    bool owns() const;
+
+                private:
+
+                    NamedMutex* _mutex = nullptr;
+
+                    bool _owns = false;
+
+            };
 
             typedef std::weak_ptr<ConditionVariable> WeakPtr;
             typedef std::shared_ptr<ConditionVariable> Ptr;
@@ -63,27 +130,34 @@ namespace EigenIPC{
 
             static void unlock(ScopedLock& locked_lock);
             
-            static NamedMutex create_named_mutex(std::string at);
+            static NamedMutex create_named_mutex(std::string at); // opens
+            // (or creates) a standalone mutex
 
-            void wait(ScopedLock& named_lock);
+            void wait(ScopedLock& named_lock); // may wake up spuriously
 
             void wait_for(ScopedLock& named_lock, 
                     std::function<bool()> pred);
 
             bool timedwait(ScopedLock& named_lock,
-                    unsigned int ms);
+                    unsigned int ms); // false on timeout
             
             bool timedwait_for(ScopedLock& named_lock,
                     unsigned int ms,
-                    std::function<bool()> pred);
+                    std::function<bool()> pred); // pred() at return
 
             void notify_one();
 
             void notify_all();
+
+            void set_wait_policy(WaitPolicy policy,
+                        int max_spin_us = 20); // used by the predicate
+            // waits (wait_for, timedwait_for): with SpinThenBlock/Spin, the
+            // mutex is released and the predicate polled before sleeping
             
             void close();
             
-            std::string mutex_path();
+            std::string mutex_path(); // the mutex lives in the same segment
+            // as the condition variable
             std::string cond_var_path();
 
         private:
@@ -109,18 +183,36 @@ namespace EigenIPC{
 
             SharedMemConfig _mem_config;
 
-            std::unique_ptr<NamedCondition> _cond_ptr;
-            std::unique_ptr<NamedMutex> _mutex_ptr;
+            int _shm_fd = -1;
 
-            boost::posix_time::ptime _utc_timeout;
-            
-            ScopedLock _lock;
+            std::size_t _mem_size = 0;
+
+            ReturnCode _return_code = ReturnCode::NONE;
+
+            SyncUtils::CondVarState* _state = nullptr;
+
+            NamedMutex _mutex; // view of the mutex in _state
+
+            WaitPolicy _wait_policy = WaitPolicy::Block; // see set_wait_policy()
+
+            long long _max_spin_ns = 20000;
+
+            double _avg_wait_ns = 0.0; // running average of the last waits
+
+            void _init_state(); // server
+            void _open_state(); // client
+
+            bool _wait_until(ScopedLock& named_lock,
+                    long long deadline_ns); // < 0 -> no deadline. False on timeout
 
             bool _cleanup_mem();
-            
+
+            bool _spin_for(ScopedLock& named_lock,
+                    std::function<bool()>& pred,
+                    long long deadline_ns); // < 0 -> no deadline
 
     };
 
 }
 
-#endif // CLIENT_HPP
+#endif // CONDVAR_HPP
@@ -21,29 +21,25 @@
 #include <chrono>
 #include <thread>
 #include <memory>
+#include <functional>
 
-#include <boost/interprocess/sync/named_condition.hpp>
-#include <boost/interprocess/sync/named_mutex.hpp>
-#include <boost/date_time/posix_time/posix_time.hpp>
-
-// public headers
 #include <EigenIPC/SharedMemConfig.hpp>
 #include <EigenIPC/Journal.hpp>
 #include <EigenIPC/DTypes.hpp>
 #include <EigenIPC/ReturnCodes.hpp>
-#include <EigenIPC/CondVar.hpp>
-#include <EigenIPC/Client.hpp>
 
 namespace EigenIPC{
 
+    namespace SyncUtils{
+
+        struct Barrier; // private, trigger/ack state shared with the producer
+
+    }
+
     class Consumer{
 
         using VLevel = Journal::VLevel;
         using LogType = Journal::LogType;
-        using ConditionVariable = EigenIPC::ConditionVariable;
-        using ScopedLock = ConditionVariable::ScopedLock;
-        using SharedCounter = EigenIPC::Client<int>;
-        using CounterView = EigenIPC::Tensor<int>;
 
         public:
 
@@ -56,69 +52,86 @@ namespace EigenIPC{
                     bool verbose = false,
                     VLevel vlevel = VLevel::V0);
 
-            ~Consumer();
+            virtual ~Consumer();
 
-            void run();
+            void run(); // blocks until the producer is running
 
             void close();
 
-            bool wait(int ms_timeout = -1);
+            virtual bool wait(int ms_timeout = -1);
             bool wait_and_ack(std::function<bool()> pre_ack,
                     int ms_timeout = -1);
 
-            bool ack();
+            bool ack(); // for the last trigger received (false if a newer
+            // trigger was already issued, i.e. we are late)
+
+            int slot(); // index identifying this consumer on the producer's side
+            // (assigned at run(), -1 if not running)
 
-        private:
+            void set_wait_policy(WaitPolicy policy,
+                        int max_spin_us = 20); // how to wait for triggers: with
+            // SpinThenBlock, we spin for about twice the average of the last
+            // waits, unless that exceeds max_spin_us (in which case we sleep right away)
+
+            int get_notify_fd(); // pollable (e.g. with epoll) fd, readable after
+            // each trigger and when the producer closes (then call wait(0) and
+            // ack()). -1 if not running or if the producer did not call
+            // enable_notify_fd(). Valid until close()
+
+            uint64_t clear_notify(); // to be called when the fd is readable: rearms
+            // it and returns the number of notifications since the last call
+
+        protected:
 
             bool _verbose = false;
                         
             bool _closed = false;
             bool _is_running = false;
 
-            bool _trigger_received = false;
+            uint32_t _internal_trigger_counter = 0; // last trigger epoch seen
 
-            bool _timeout = false;
-
-            int _internal_trigger_counter = 0;
-            int _trigger_counter_increment = 0;
+            int _slot = -1; // our bit in the ack mask
 
             int _fail_count = 0;
 
+            WaitPolicy _wait_policy = WaitPolicy::SpinThenBlock; // see set_wait_policy()
+
+            long long _max_spin_ns = 20000;
+
+            double _avg_wait_ns = 0.0; // running average of the last waits
+
+            int _shm_fd = -1;
+
+            std::size_t _mem_size = 0;
+
             std::string _basename, _namespace, _unique_id;
             
             std::string THISNAME = "EigenIPC::Consumer";
             
-            std::string TRIGGER_COND_NAME = "TriggerCond";
-            std::string ACK_COND_NAME = "AckCond";
-
-            std::string TRIGGER_BASENAME = "Trigger";
-            std::string ACK_BASENAME = "Ack";
+            std::string BARRIER_BASENAME = "Barrier";
 
             VLevel _vlevel = VLevel::V0; // minimal debug info
 
             Journal _journal; // for rt-friendly logging
 
-            ConditionVariable::UniquePtr _trigger_cond_ptr;
-            ConditionVariable::UniquePtr _ack_cond_ptr;
+            SharedMemConfig _mem_config;
 
-            SharedCounter _trigger_counter_clnt;
-            CounterView _trigger_counter;
+            ReturnCode _return_code = ReturnCode::NONE;
 
-            SharedCounter _ack_counter_clnt;
-            CounterView _ack_counter; 
+            SyncUtils::Barrier* _barrier = nullptr; // trigger epoch and
+            // ack counter (in shared memory)
+
+            int _notify_fd = -1; // eventfd registered with the producer
+            int _notify_conn_fd = -1; // keeps the registration alive
 
             std::string _getThisName(); // used to get this class
             // name
 
-            void _open_cond_vars(); 
-
-            void _check_running(std::string calling_method);
+            bool _open_barrier(); // true if the producer's barrier is available
 
-            bool _check_trigger_received();
+            void _close_barrier();
 
-            bool _wait(ScopedLock& ack_lock, int ms_timeout = -1);
-
-            bool _acknowledge();
+            void _check_running(std::string calling_method);
 
     };
 
@@ -30,6 +30,25 @@ namespace EigenIPC {
     const int MemLayoutDefault = RowMajor; // default layout used by this
     // library (changes here will propagate to the whole library)
 
+    // Define an enum class for the data access synchronization policies
+    enum class SyncMode {
+        Lock, // readers and writers take the data semaphore (default)
+        SeqLock, // writers bump a sequence counter, readers never lock and retry
+        // on torn reads (wait-free reads, writers never wait for readers)
+        Striped, // rows are split in blocks ("stripes"), each with its own lock:
+        // accesses to disjoint row blocks do not contend
+        Ring // the server keeps N copies ("slots") of the tensor: writers fill a free slot
+        // and publish it, readers copy the latest published one (neither waits for the other)
+    };
+
+    // how blocking waits (triggers, acks, condition variables) are carried out
+    enum class WaitPolicy {
+        Block, // sleep right away (lowest CPU usage, pays a scheduler wake-up)
+        SpinThenBlock, // busy-wait for a spin budget adapted to the observed wait
+        // durations (bounded by a maximum), then sleep
+        Spin // busy-wait only (sub-microsecond wake-ups, for dedicated/isolated cores)
+    };
+
     template <typename Scalar, int Layout = MemLayoutDefault>
     using Tensor = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Layout>;
 
@@ -46,6 +65,20 @@ namespace EigenIPC {
     using MMap = Eigen::Map<Tensor<Scalar, Layout>>; // no explicit cleanup needed
     // for Eigen::Map -> it does not own the memory.
 
+    template <typename Scalar, int Layout = MemLayoutDefault>
+    using CMMap = Eigen::Map<const Tensor<Scalar, Layout>>; // read-only MMap
+
+    template <typename Scalar, int Layout = MemLayoutDefault>
+    using BlockView = Eigen::Map<Tensor<Scalar, Layout>,
+                        Eigen::Unaligned,
+                        Eigen::OuterStride<>>; // block of a contiguous tensor
+    // (rows/cols of the block are contiguous, the outer stride is the one of the full tensor)
+
+    template <typename Scalar, int Layout = MemLayoutDefault>
+    using ConstBlockView = Eigen::Map<const Tensor<Scalar, Layout>,
+                        Eigen::Unaligned,
+                        Eigen::OuterStride<>>; // read-only BlockView
+
     // Define an enum class for data types
     enum class DType {
         Float,
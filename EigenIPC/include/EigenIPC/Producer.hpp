@@ -21,29 +21,31 @@
 #include <chrono>
 #include <thread>
 #include <memory>
+#include <vector>
 
-#include <boost/interprocess/sync/named_condition.hpp>
-#include <boost/interprocess/sync/named_mutex.hpp>
-#include <boost/date_time/posix_time/posix_time.hpp>
-
-// public headers
 #include <EigenIPC/SharedMemConfig.hpp>
 #include <EigenIPC/Journal.hpp>
 #include <EigenIPC/DTypes.hpp>
 #include <EigenIPC/ReturnCodes.hpp>
-#include <EigenIPC/CondVar.hpp>
-#include <EigenIPC/Server.hpp>
 
 namespace EigenIPC{
 
+    namespace SyncUtils{
+
+        struct Barrier; // private, trigger/ack state shared with the consumers
+
+    }
+
+    namespace NotifyUtils{
+
+        struct Notifier; // private, eventfds of the consumers to be notified
+
+    }
+
     class Producer{
 
         using VLevel = Journal::VLevel;
         using LogType = Journal::LogType;
-        using ConditionVariable = EigenIPC::ConditionVariable;
-        using ScopedLock = ConditionVariable::ScopedLock;
-        using SharedCounter = EigenIPC::Server<int>;
-        using CounterView = EigenIPC::Tensor<int>;
 
         public:
 
@@ -57,7 +59,7 @@ namespace EigenIPC{
                     VLevel vlevel = VLevel::V0,
                     bool force_reconnection = false);
 
-            ~Producer();
+            virtual ~Producer();
 
             void run();
             
@@ -65,10 +67,39 @@ namespace EigenIPC{
             
             void trigger();
 
+            // consumers ack by setting their own bit in a shared mask (see
+            // Consumer::slot()), so a consumer acking twice is only counted once
+
             bool wait_ack_from(int n_consumers,
-                        int ms_timeout = -1);
+                        int ms_timeout = -1); // any n_consumers distinct consumers
+
+            bool wait_ack_all(int ms_timeout = -1); // all the consumers which were
+            // registered at the last trigger (and are still there)
+
+            std::vector<int> missing_acks(); // slots of the consumers which did
+            // not ack the last trigger yet (e.g. after a timeout)
+
+            int n_consumers(); // currently registered (consumers which died
+            // without closing are reaped first)
+
+            static constexpr int N_LATENCY_BINS = 24; // bin 0: < 1 us, bin b: [2^(b-1), 2^b) us,
+            // last bin: anything above
+
+            std::vector<uint64_t> ack_latency_histogram(int slot); // trigger -> ack
+            // latencies of the consumer at slot, over the rounds waited for so far
+
+            void reset_ack_stats();
+
+            void set_wait_policy(WaitPolicy policy,
+                        int max_spin_us = 20); // how to wait for acks: with
+            // SpinThenBlock, we spin for about twice the average of the last
+            // waits, unless that exceeds max_spin_us (in which case we sleep right away)
 
-        private:
+            bool enable_notify_fd(); // lets consumers get a pollable notification fd
+            // (Consumer::get_notify_fd()), signaled at each trigger and on close().
+            // False if another producer already exposes one
+
+        protected:
 
             bool _verbose = false;
 
@@ -77,49 +108,63 @@ namespace EigenIPC{
             bool _closed = false;
             bool _is_running = false;
 
-            bool _ack_completed = false;
+            uint64_t _round_mask = 0; // consumers registered at the last trigger
+            uint64_t _recorded_mask = 0; // acks of this round already in the histograms
 
-            bool _timeout = false;
+            uint32_t _round_epoch = 0; // epoch of the last trigger
+
+            long long _trigger_ns = 0; // time of the last trigger
+
+            long long _last_reap_ns = 0; // last scan for dead consumers
+
+            std::vector<uint64_t> _ack_latency_hist; // N_LATENCY_BINS per consumer slot
+
+            WaitPolicy _wait_policy = WaitPolicy::SpinThenBlock; // see set_wait_policy()
+
+            long long _max_spin_ns = 20000;
+
+            double _avg_wait_ns = 0.0; // running average of the last waits
+
+            int _shm_fd = -1;
+
+            std::size_t _mem_size = 0; // [bytes] of the barrier segment
 
-            int _acks_before = 0;
-            
             std::string _basename, _namespace, _unique_id;
             
             std::string THISNAME = "EigenIPC::Producer";
             
-            std::string TRIGGER_COND_NAME = "TriggerCond";
-            std::string ACK_COND_NAME = "AckCond";
-
-            std::string TRIGGER_BASENAME = "Trigger";
-            std::string ACK_BASENAME = "Ack";
+            std::string BARRIER_BASENAME = "Barrier";
 
             VLevel _vlevel = VLevel::V0; // minimal debug info
 
             Journal _journal; // for rt-friendly logging
 
-            ConditionVariable::UniquePtr _trigger_cond_ptr;
-            ConditionVariable::UniquePtr _ack_cond_ptr;
+            SharedMemConfig _mem_config;
 
-            SharedCounter _trigger_counter_srvr;
-            CounterView _trigger_counter;
+            ReturnCode _return_code = ReturnCode::NONE;
 
-            SharedCounter _ack_counter_srvr;
-            CounterView _ack_counter; 
+            SyncUtils::Barrier* _barrier = nullptr; // trigger epoch and
+            // ack counter (in shared memory)
+
+            std::unique_ptr<NotifyUtils::Notifier> _notifier; // see enable_notify_fd()
 
             std::string _getThisName(); // used to get this class
             // name
 
-            void _create_cond_vars();
+            void _init_barrier();
 
-            void _check_running(std::string calling_method);
+            virtual std::size_t _payload_size(); // [bytes] stored after the barrier,
+            // in the same segment (none by default)
 
-            void _init_counters();
+            virtual void _init_payload(void* payload); // called before the barrier
+            // is made available to the consumers
 
-            void _increment_trigger();
+            void _record_latencies(uint64_t acked);
 
-            bool _check_ack_counter(int n_consumers);
+            void _reap_consumers(bool force = false); // at most every
+            // SyncUtils::REAP_PERIOD_NS, unless forced
 
-            bool _wait(ScopedLock& ack_lock, int ms_timeout = -1);
+            void _check_running(std::string calling_method);
 
     };
 
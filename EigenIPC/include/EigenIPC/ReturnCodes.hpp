@@ -53,6 +53,8 @@ namespace EigenIPC {
         SEMUNLINK = 1ULL << 25, // unlinked semaphore
         WRITEFAIL = 1ULL << 26, // failed to write to memory
         READFAIL = 1ULL << 27, // failed to read from memory
+        SEQREADFAIL = 1ULL << 28, // could not get a consistent (seqlock) snapshot
+        LOCKOWNERDIED = 1ULL << 29, // data lock recovered from a dead owner
         // ... up to 1ULL << 62
         OTHER = 1ULL << 62,
         UNKNOWN = 1ULL << 63,
@@ -90,6 +92,8 @@ namespace EigenIPC {
                 {ReturnCode::SEMRELFAIL, "SEMRELFAIL"},
                 {ReturnCode::SEMCLOSE, "SEMCLOSE"},
                 {ReturnCode::SEMUNLINK, "SEMUNLINK"},
+                {ReturnCode::SEQREADFAIL, "SEQREADFAIL"},
+                {ReturnCode::LOCKOWNERDIED, "LOCKOWNERDIED"},
                 // ... other codes
                 {ReturnCode::OTHER, "OTHER"},
                 {ReturnCode::UNKNOWN, "UNKNOWN"},
@@ -28,6 +28,8 @@
 #include <semaphore.h>
 #include <csignal>
 #include <memory>
+#include <vector>
+#include <utility>
 
 // public headers
 #include <EigenIPC/SharedMemConfig.hpp>
@@ -37,6 +39,18 @@
 
 namespace EigenIPC{
 
+    namespace SyncUtils{
+
+        struct MemHeader; // private, shared metadata and synchronization state
+
+    }
+
+    namespace NotifyUtils{
+
+        struct Notifier; // private, eventfds of the readers to be notified
+
+    }
+
     template <typename Scalar,
               int Layout = MemLayoutDefault>
     class Server {
@@ -50,6 +64,60 @@ namespace EigenIPC{
             typedef std::shared_ptr<Server> Ptr;
             typedef std::unique_ptr<Server> UniquePtr;
 
+            // zero-copy, writable view of a block of the shared tensor, borrowed
+            // through acquireView(). It holds the data lock (and, with SeqLock and Ring,
+            // keeps the write "open" for readers) until releaseView() is called
+            // (automatically on destruction): keep it short-lived
+            class WriteView {
+
+                friend class Server;
+
+                public:
+
+                    WriteView(WriteView&& other) noexcept
+                        : _server(other._server),
+                        _data(other._data),
+                        _row(other._row),
+                        _slot(other._slot),
+                        _stripe_first(other._stripe_first),
+                        _stripe_last(other._stripe_last)
+                    {
+                        other._server = nullptr; // ownership is transferred
+                    }
+
+                    WriteView(const WriteView&) = delete;
+                    WriteView& operator=(const WriteView&) = delete;
+                    WriteView& operator=(WriteView&&) = delete;
+
+                    ~WriteView() {
+
+                        if (_server != nullptr) {
+
+                            _server->releaseView(*this);
+                        }
+
+                    }
+
+                    bool isValid() const { return _server != nullptr; } // false if
+                    // acquisition failed or the view was already released
+
+                    BlockView<Scalar, Layout>& data() { return _data; }
+
+                private:
+
+                    WriteView()
+                        : _data(nullptr, 0, 0, Eigen::OuterStride<>(0)) {}
+
+                    Server* _server = nullptr;
+
+                    BlockView<Scalar, Layout> _data;
+
+                    int _row = 0; // first borrowed row
+                    int _slot = 0; // slot being filled (Ring)
+                    int _stripe_first = 0, _stripe_last = 0; // held stripes (Striped)
+
+            };
+
             Server(int n_rows,
                    int n_cols,
                    std::string basename = "MySharedMemory",
@@ -57,7 +125,10 @@ namespace EigenIPC{
                    bool verbose = false,
                    VLevel vlevel = VLevel::V0,
                    bool force_reconnection = false,
-                   bool safe = true);
+                   bool safe = true,
+                   SyncMode sync_mode = SyncMode::Lock,
+                   int n_stripes = 1, // only used with SyncMode::Striped
+                   int n_slots = 3); // only used with SyncMode::Ring
 
             ~Server();
 
@@ -85,7 +156,11 @@ namespace EigenIPC{
 
             bool isRunning();
 
-            int getNClients();
+            int getNClients(); // exact count of the attached clients. Clients which
+            // died without detaching are reaped (at most every 100 ms)
+
+            std::vector<int> getIdleClients(int ms_idle); // PIDs of the (live)
+            // clients which did not read/write/wait for updates over the last ms_idle
 
             int getNRows();
             int getNCols();
@@ -94,12 +169,38 @@ namespace EigenIPC{
 
             int getMemLayout() const;
 
+            uint64_t getDataVersion() const; // version of the last write (a single
+            // atomic load): it changes every time the tensor is written. 0 if the
+            // shared memory is not mapped
+
+            SyncMode getSyncMode() const;
+
             std::string getNamespace() const;
             std::string getBasename() const;
 
-            void dataSemAcquire(); // acquire data sem (blocking)
-            void dataSemRelease(); // acquire data sem (blocking)
-            
+            void dataSemAcquire(); // acquire data lock (blocking)
+            void dataSemRelease(); // release data lock
+
+            WriteView acquireView(int row, int col,
+                            int n_rows, int n_cols); // nonblocking: an invalid
+            // view is returned if the data is not available
+
+            bool releaseView(WriteView& view); // publishes what was written
+            // through the view
+
+            bool beginBatch(); // nonblocking: takes the data lock (all stripes, with
+            // SyncMode::Striped) once, so that the following writes are applied without
+            // any further locking and are only seen by readers, all at once, on commit().
+            // Reads from this server return false (immediately) until then
+
+            bool commit(); // publishes all the writes since beginBatch()
+
+            bool isBatching() const;
+
+            bool enableNotifyFd(); // lets clients get a pollable notification fd
+            // (Client::getNotifyFd()), signaled after each write from this server
+            // and when it is stopped. False if another server already exposes one
+
         protected:
 
             bool _unlink_data = true; // will also unlink data
@@ -123,13 +224,9 @@ namespace EigenIPC{
 
             int _n_clients = -1;
 
+            long long _last_reap_ns = 0; // last scan for dead clients
+
             int _data_shm_fd = -1; // shared memory file descriptor
-            int _nrows_shm_fd = -1;
-            int _ncols_shm_fd = -1;
-            int _n_clients_shm_fd = -1;
-            int _dtype_shm_fd = -1;
-            int _isrunning_shm_fd = -1;
-            int _mem_layout_shm_fd = -1;
 
             static const int _mem_layout = Layout;
 
@@ -140,12 +237,27 @@ namespace EigenIPC{
 
             struct timespec _sem_timeout;
 
+            SyncMode _sync_mode = SyncMode::Lock;
+
+            int _n_stripes = 1; // row stripes (SyncMode::Striped)
+            int _stripe_first = 0, _stripe_last = 0; // stripes currently held
+
+            int _n_slots = 3; // tensor copies (SyncMode::Ring)
+
+            int _seq_max_retries = 100000; // max attempts at getting a
+            // consistent snapshot in SyncMode::SeqLock
+
             VLevel _vlevel = VLevel::V0; // minimal debug info
 
             SharedMemConfig _mem_config;
 
             sem_t* _srvr_sem = nullptr; // semaphore for servers uniqueness
-            sem_t* _data_sem = nullptr; // semaphore for safe data access
+            uint32_t _pid = 0; // identifies this process as owner of the data
+            // lock (which lives in the shared sync header). With SyncMode::SeqLock
+            // and SyncMode::Ring the lock only serializes writers
+
+            SyncUtils::MemHeader* _header = nullptr; // shared metadata and sync state
+            // (at the beginning of the tensor's shared segment)
 
             Journal _journal; // for rt-friendly logging
 
@@ -155,18 +267,24 @@ namespace EigenIPC{
             Tensor<Scalar, Layout> _tensor_copy; // copy (not view) of the tensor
 
             MMap<Scalar, Layout> _tensor_view; // view of the tensor
-            // auxiliary views
-            MMap<int, Layout> _n_rows_view,
-                      _n_cols_view,
-                      _n_clients_view,
-                      _dtype_view,
-                      _mem_layout_view;
-            MMap<bool, Layout> _isrunning_view;
+
+            bool _batching = false; // between beginBatch() and commit()
+
+            MMap<Scalar, Layout> _batch_view; // where batched writes go (the slot
+            // being filled, with SyncMode::Ring)
+
+            int _batch_slot = 0; // SyncMode::Ring
+
+            std::vector<char> _batch_rows; // rows written by the current batch
+            // (marked as changed on commit). Preallocated, one flag per row
+
+            int _batch_first = 0, _batch_last = -1; // range of _batch_rows in use
+
+            std::unique_ptr<NotifyUtils::Notifier> _notifier; // see enableNotifyFd()
 
             std::string _getThisName();
 
             void _initDataMem();
-            void _initMetaMem();
 
             void _initSems();
 
@@ -189,13 +307,34 @@ namespace EigenIPC{
                                 bool verbose = false);
             void _releaseData();
 
+            bool _acquireBlock(int row, int n_rows); // acquires whatever protects
+            // the given rows (nonblocking)
+            void _releaseBlock();
+
+            template <typename DataT>
+            bool _ringWrite(const DataT& data,
+                        int row, int col); // fills and publishes the next slot
+
+            template <typename DataT>
+            bool _batchWrite(const DataT& data,
+                        int row, int col); // no locking (within a batch)
+
+            template <typename DataT>
+            bool _write(const DataT& data,
+                        int row, int col);
+
+            template <typename OutT>
+            bool _read(OutT& output,
+                        int row, int col);
+
             void _closeSems();
 
-            void _cleanMetaMem();
             void _cleanMems();
 
             void _checkIsRunning();
 
+            void _notifyUpdate(); // waitForUpdate() and notification fds
+
     };
 
 }
@@ -35,48 +35,23 @@ namespace EigenIPC{
             // original shared mem
             mem_path = "/" + _namespace + _name;
 
-            mem_path_nrows = "/" + _namespace + _name + "_" + MemDef::sharedTensorNRowsName();
-
-            mem_path_ncols = "/" + _namespace + _name + "_" + MemDef::sharedTensorNColsName();
-
-            mem_path_dtype = "/" + _namespace + _name + "_" + MemDef::sharedTensorDTypeName();
-
-            mem_path_clients_counter = "/" + _namespace + _name + "_" + MemDef::ClientsCountName();
-
-            mem_path_isrunning = "/" + _namespace + _name + "_" + MemDef::isSrvrRunningName();
-
-            mem_path_mem_layout = "/" + _namespace + _name + "_" + MemDef::memLayoutName();
-
             mem_path_server_sem = "/" + _namespace + _name + "_" + MemDef::SrvrSemName();
-
-            mem_path_data_sem = "/" + _namespace + _name + "_" + MemDef::DataSemName();
             
             // conditon variable wrapper
 
             mem_path_cond_var = _namespace + _name + MemDef::CondVarName();
 
-            mem_path_cond_var_mutex = _namespace + _name + MemDef::CondVarMutexName();
-
         }
 
         // shared data path
         std::string mem_path;
 
-        // auxiliary data
-        std::string mem_path_nrows;
-        std::string mem_path_ncols;
-        std::string mem_path_dtype;
-        std::string mem_path_clients_counter;
-        std::string mem_path_isrunning;
-        std::string mem_path_mem_layout;
-
-        // semaphores
+        // semaphores (the data lock and all metadata live in
+        // the header of the shared data segment at mem_path)
         std::string mem_path_server_sem;
-        std::string mem_path_data_sem;
 
         // cond. var. wrappers
         std::string mem_path_cond_var;
-        std::string mem_path_cond_var_mutex;
 
     private:
 
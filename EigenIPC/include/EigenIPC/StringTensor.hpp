@@ -23,11 +23,13 @@
 
 #include <string>
 #include <thread>
+#include <memory>
 
 #include <EigenIPC/Client.hpp>
 #include <EigenIPC/Server.hpp>
 
 #include <EigenIPC/Journal.hpp>
+#include <EigenIPC/CondVar.hpp>
 
 namespace EigenIPC {
 
@@ -39,16 +41,26 @@ namespace EigenIPC {
         class StringTensor {
         
         // Wrapper on top of Server and Client to also share
-        // tensor (list) of strings. 
-        // The idea is to use a shared tensor of ints with the following properties:
-        // Each string in the list will be encoded along the columns of
-        // the tensor. Given an input string, the string is first split
-        // into chunks of size equal to size_of(int), which is typically 4 bytes or 32 bits.
-        // This means, for most systems, we can represent each chunk of a string as a sequence
-        // of up to 4 characters (UTF-8 encoded). 
-        // Each chunck can then distributed along the column of the tensor, at 
-        // the corresponding column index. Strings are encoded using UTF8 and 
-        // then decoded with the same logic.
+        // tensor (list) of strings.
+        // The strings are stored in a shared tensor of ints (row-major) with
+        // the following layout:
+        // - row 0 holds, for each string (column), the offset [bytes] of the
+        //   string inside the arena
+        // - row 1 holds the size [bytes] of each string
+        // - row 2 holds a stamp for each string, changed at every write of it
+        // - all the other rows make up a single packed byte arena, where the
+        //   (UTF-8 encoded) strings are stored back to back.
+        // Writes append the new strings to the free part of the arena and only
+        // then update the index, so that readers never see half-written strings;
+        // when the arena is full, the live strings are compacted. Reads are a
+        // single memcpy per string (straight from the shared memory for clients).
+        // Each instance also keeps a decoded copy of all the strings: reads
+        // only go to the shared memory if the tensor was written since the last
+        // one, and then only decode the strings whose stamp moved.
+        // Strings can have any length, as long as the whole list fits in the arena
+        // (see arena_bytes). Writers (the server and any client) are serialized by
+        // a named mutex, since allocating in the arena is a read-modify-write of
+        // the index; readers run concurrently with them.
 
         using VLevel = Journal::VLevel;
 
@@ -70,7 +82,10 @@ namespace EigenIPC {
                          bool verbose = false,
                          VLevel vlevel = VLevel::V0,
                          bool force_reconnection = false,
-                         bool safe = false); // used when server
+                         bool safe = false,
+                         int arena_bytes = -1); // used when server. The arena
+            // holds all the strings: by default, it's sized for strings of
+            // _default_chars characters on average
 
             ~StringTensor();
 
@@ -90,6 +105,9 @@ namespace EigenIPC {
             bool read(std::string& str,
                       int index = 0);
 
+            bool isStale(); // true if the strings were written (by anyone)
+            // after the last read. Costs a single atomic load
+
             void close();
 
             bool isRunning();
@@ -111,26 +129,39 @@ namespace EigenIPC {
 
             int _length = -1; // string tensor length
 
-//            constexpr int MAX_THREADS = std::thread::hardware_concurrency() ?
-//                        std::thread::hardware_concurrency() : 4; // fallback to 4 threads
-
             bool _running = false;
 
             bool _is_server = false;
-            
-            // assuming maximum characters in a string are max_chars
-            static constexpr int _max_chars = 1024;
 
-            // max number of rows needed
-            static constexpr int _n_rows = _max_chars / sizeof(int);
+            // index rows (offsets, sizes and stamps of the strings)
+            static constexpr int _n_index_rows = 3;
+
+            // default arena size per string [bytes]
+            static constexpr int _default_chars = 128;
+
+            int _n_rows = -1; // index + arena rows
+
+            long long _arena_capacity = 0; // [bytes]
+
+            Tensor<int> _buffer; // local copy of the whole tensor (to avoid dyn. allocations)
+
+            std::string _scratch; // used for compacting the arena
+
+            std::vector<std::string> _cache; // decoded strings (all of them)
+            std::vector<int> _cache_stamps; // stamp of each cached string
+            // (-1 -> not cached)
 
-            int _tmp_value = 0; // tmp val to avoid dyn allocations
+            uint64_t _synced_version = 0; // data version _cache is in sync with
+            bool _synced = false;
 
-            Tensor<int> _buffer; // to avoid dyn. allocations
+            std::string _writers_path;
+
+            Journal _journal;
 
             ShMemType _sh_mem;
 
-//            std::array<std::thread, MAX_THREADS> threads; // preallocate threads
+            std::unique_ptr<ConditionVariable::NamedMutex> _writers; // held by
+            // _encode(). Opened by the server at construction, by clients once attached
 
             // Helper methods to initialize _sh_mem
             ShMemType _initServer(int length,
@@ -139,7 +170,8 @@ namespace EigenIPC {
                                   bool verbose,
                                   VLevel vlevel,
                                   bool force_reconnection,
-                                  bool safe);
+                                  bool safe,
+                                  int arena_bytes);
 
             ShMemType _initClient(std::string basename,
                                   std::string name_space,
@@ -147,20 +179,36 @@ namespace EigenIPC {
                                   VLevel vlevel,
                                   bool safe);
 
-            bool _fits(const std::vector<std::string>& vec,
+            static int _arena_rows(int length,
+                                   int arena_bytes);
+
+            static std::unique_ptr<ConditionVariable::NamedMutex> _openWriters(
+                                                const std::string& path,
+                                                bool fresh); // fresh -> a previous
+            // server's mutex is not reused
+
+            void _init_buffers();
+
+            bool _fits(int n,
                        int index);
 
-            void _encode_str(const std::string& str,
-                             int col_index);
+            long long _arena_used();
+
+            long long _compact();
+
+            bool _encode(const std::string* strs,
+                         int n,
+                         int col_index);
+
+            bool _sync();
 
-            void _decode_str(std::string& str,
-                             int col_index);
+            bool _refresh(); // brings _cache up to date with the shared memory
 
-            bool _encode_vec(const std::vector<std::string>& vec,
-                             int col_index);
+            bool _update_cache(const int* data); // data is the whole tensor
 
-            bool _decode_vec(std::vector<std::string>& vec,
-                           int col_index);
+            bool _decode_str(const int* data,
+                             std::string& str,
+                             int col_index); // data is the whole tensor
 
         };
 
@@ -0,0 +1,151 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+//
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+//
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef SYMBOLTABLE_HPP
+#define SYMBOLTABLE_HPP
+
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#include <EigenIPC/StringTensor.hpp>
+#include <EigenIPC/CondVar.hpp>
+
+#include <EigenIPC/Journal.hpp>
+
+namespace EigenIPC {
+
+        template <typename ShMemType>
+        class SymbolTable {
+
+        // Shared, append-only table of interned strings (link names, sensor IDs, ...).
+        // Every string gets a stable integer ID (its index in a StringTensor), so that
+        // processes can exchange ints (e.g. in a Server<int>) instead of strings.
+        // Lookups go through an open addressing hash index, shared through a
+        // tensor of ints with the following layout:
+        // - row 0 holds, for each bucket, the ID of its string + 1 (0 -> empty)
+        // - row 1 holds the hash of the string of each bucket
+        // - column 0 is not a bucket: (0, 0) holds the number of symbols.
+        // Each instance probes a local copy of the index, which is only refreshed
+        // when the index was written since (a single atomic load). Any process can
+        // intern new strings: interning is serialized by a named mutex.
+
+        using VLevel = Journal::VLevel;
+
+        public:
+
+            typedef std::weak_ptr<SymbolTable> WeakPtr;
+            typedef std::shared_ptr<SymbolTable> Ptr;
+            typedef std::unique_ptr<SymbolTable> UniquePtr;
+
+            SymbolTable(std::string basename = "MySymbolTable",
+                        std::string name_space = "",
+                        bool verbose = false,
+                        VLevel vlevel = VLevel::V0); // used when client
+
+            SymbolTable(int capacity, // max number of symbols
+                        std::string basename = "MySymbolTable",
+                        std::string name_space = "",
+                        bool verbose = false,
+                        VLevel vlevel = VLevel::V0,
+                        bool force_reconnection = false,
+                        int arena_bytes = -1); // used when server (see StringTensor)
+
+            ~SymbolTable();
+
+            void run();
+
+            int intern(const std::string& str); // ID of str, which is added
+            // if not there yet. -1 if the table is full (or not available)
+
+            int find(const std::string& str); // ID of str, -1 if not interned
+
+            bool name(int id,
+                      std::string& str); // string with the given ID
+
+            int size(); // number of interned strings
+
+            int getCapacity();
+
+            void close();
+
+            bool isRunning();
+
+            bool isServer();
+
+            std::string getNamespace() const;
+            std::string getBasename() const;
+
+        private:
+
+            int _capacity = -1;
+
+            int _n_buckets = -1; // power of 2
+
+            bool _running = false;
+
+            bool _is_server = false;
+
+            bool _force_reconnection = false; // server: takes over the writers' mutex
+
+            bool _synced = false;
+
+            uint64_t _synced_version = 0; // index version _buckets is in sync with
+
+            int _max_retries = 1000; // attempts at accessing the shared
+            // memory while it's busy
+
+            std::string _basename, _namespace;
+
+            std::string _mutex_path;
+
+            std::string _probe; // aux. string, used for comparing candidates
+
+            Tensor<int> _buckets; // local copy of the index
+
+            Journal _journal;
+
+            StringTensor<ShMemType> _strings;
+
+            ShMemType _index;
+
+            std::unique_ptr<ConditionVariable::NamedMutex> _writers; // serializes
+            // intern(). Opened by run()
+
+            static int _n_buckets_for(int capacity);
+
+            static int _hash(const std::string& str); // non-negative
+
+            template <typename F>
+            bool _retry(F&& access); // retries access() while the data is busy
+
+            bool _sync();
+
+            bool _probe_for(const std::string& str,
+                            int hash,
+                            int& id,
+                            int& bucket); // id of str, or -1 with bucket set
+            // to the empty bucket where it would go (-1 if there is none).
+            // False if the candidates could not be read
+
+            void _init_buffers();
+
+        };
+
+}
+
+#endif // SYMBOLTABLE_HPP
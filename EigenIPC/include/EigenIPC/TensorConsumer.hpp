@@ -0,0 +1,87 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+// 
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+// 
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+// 
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef TENSORCONSUMER_HPP
+#define TENSORCONSUMER_HPP
+
+#include <Eigen/Dense>
+#include <memory>
+
+#include <EigenIPC/Consumer.hpp>
+#include <EigenIPC/DTypes.hpp>
+
+namespace EigenIPC{
+
+    namespace SyncUtils{
+
+        struct TensorPayload; // private, tensor slots stored after the barrier
+
+    }
+
+    // Consumer of a TensorProducer: wait() also hands out a zero-copy view of
+    // the tensor published together with the received trigger
+    template <typename Scalar,
+              int Layout = MemLayoutDefault>
+    class TensorConsumer : public Consumer {
+
+        using VLevel = Journal::VLevel;
+        using LogType = Journal::LogType;
+
+        public:
+
+            typedef std::weak_ptr<TensorConsumer> WeakPtr;
+            typedef std::shared_ptr<TensorConsumer> Ptr;
+            typedef std::unique_ptr<TensorConsumer> UniquePtr;
+
+            TensorConsumer(std::string basename,
+                    std::string name_space = "",
+                    bool verbose = false,
+                    VLevel vlevel = VLevel::V0);
+
+            void run(); // blocks until the producer is running
+
+            bool wait(int ms_timeout = -1) override; // on success, data()
+            // views the tensor published with the trigger
+
+            const CMMap<Scalar, Layout>& data() const; // view of the data of the
+            // last trigger received (in shared memory)
+
+            bool isValid(); // false if the producer already started overwriting
+            // the data viewed by data() (after publishing n_slots - 1 more triggers).
+            // To be checked after reading, like SyncMode::SeqLock
+
+            int getNRows();
+            int getNCols();
+
+        protected:
+
+            int _n_rows = 0;
+            int _n_cols = 0;
+
+            SyncUtils::TensorPayload* _payload = nullptr;
+
+            int _data_slot = 0; // of the data viewed by data()
+
+            CMMap<Scalar, Layout> _data_view;
+
+            void _open_payload();
+
+    };
+
+}
+
+#endif // TENSORCONSUMER_HPP
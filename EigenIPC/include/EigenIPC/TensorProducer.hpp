@@ -0,0 +1,90 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+// 
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+// 
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+// 
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef TENSORPRODUCER_HPP
+#define TENSORPRODUCER_HPP
+
+#include <Eigen/Dense>
+#include <memory>
+
+#include <EigenIPC/Producer.hpp>
+#include <EigenIPC/DTypes.hpp>
+
+namespace EigenIPC{
+
+    namespace SyncUtils{
+
+        struct TensorPayload; // private, tensor slots stored after the barrier
+
+    }
+
+    // Producer whose triggers carry a tensor: the data and the trigger epoch
+    // live in the same shared segment, so a TensorConsumer woken up by a trigger
+    // gets exactly the data published with it (no separate Server/Client needed)
+    template <typename Scalar,
+              int Layout = MemLayoutDefault>
+    class TensorProducer : public Producer {
+
+        using VLevel = Journal::VLevel;
+        using LogType = Journal::LogType;
+
+        public:
+
+            typedef std::weak_ptr<TensorProducer> WeakPtr;
+            typedef std::shared_ptr<TensorProducer> Ptr;
+            typedef std::unique_ptr<TensorProducer> UniquePtr;
+
+            TensorProducer(int n_rows,
+                    int n_cols,
+                    std::string basename,
+                    std::string name_space = "",
+                    bool verbose = false,
+                    VLevel vlevel = VLevel::V0,
+                    bool force_reconnection = false,
+                    int n_slots = 3); // data of the last n_slots - 1 triggers
+                    // stays readable while the next one is being written
+
+            MMap<Scalar, Layout> next(); // zero-copy: view of the slot which
+            // the next publish() hands over to the consumers
+
+            void publish(); // publishes the slot returned by next() and triggers
+
+            void publish(const TRef<Scalar, Layout> data); // copies data
+            // to the next slot, then publishes it
+
+            int getNRows();
+            int getNCols();
+
+        protected:
+
+            int _n_rows = 0;
+            int _n_cols = 0;
+            int _n_slots = 0;
+
+            int _next_slot = -1; // slot opened by next() (-1 if none)
+
+            SyncUtils::TensorPayload* _payload = nullptr;
+
+            std::size_t _payload_size() override;
+
+            void _init_payload(void* payload) override;
+
+    };
+
+}
+
+#endif // TENSORPRODUCER_HPP
@@ -0,0 +1,221 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+// 
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+// 
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+// 
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef TENSORQUEUE_HPP
+#define TENSORQUEUE_HPP
+
+#include <Eigen/Dense>
+#include <string>
+#include <memory>
+#include <thread>
+#include <chrono>
+
+// public headers
+#include <EigenIPC/SharedMemConfig.hpp>
+#include <EigenIPC/Journal.hpp>
+#include <EigenIPC/DTypes.hpp>
+#include <EigenIPC/ReturnCodes.hpp>
+
+namespace EigenIPC{
+
+    namespace SyncUtils{
+
+        struct QueueHeader; // private, queue state and cells (in shared memory)
+
+    }
+
+    // bounded, lock-free multi-producer multi-consumer FIFO of fixed-shape
+    // tensors in a single shared segment. Unlike Server/Client (which only hold
+    // the latest value), every pushed tensor is popped exactly once.
+    // Cells are claimed and then committed by their producer/consumer: a
+    // process dying in between (e.g. while holding a Batch) never commits its
+    // cell, and the ring stalls for good at that position (pushes, or pops,
+    // time out) until the queue is created again
+    template <typename Scalar,
+              int Layout = MemLayoutDefault>
+    class TensorQueue {
+
+        using VLevel = Journal::VLevel;
+        using LogType = Journal::LogType;
+
+        public:
+
+            typedef std::weak_ptr<TensorQueue> WeakPtr;
+            typedef std::shared_ptr<TensorQueue> Ptr;
+            typedef std::unique_ptr<TensorQueue> UniquePtr;
+
+            // zero-copy, read-only views of consecutive popped tensors, which
+            // are contiguous in the queue's memory. The cells are handed back
+            // to the producers by release() (automatically on destruction).
+            // A batch is invalidated (empty, and release() is a no-op) when the
+            // queue it comes from is closed or destroyed
+            class Batch {
+
+                friend class TensorQueue;
+
+                public:
+
+                    Batch(Batch&& other) noexcept
+                        : _queue(other._queue),
+                        _queue_open(std::move(other._queue_open)),
+                        _pos(other._pos),
+                        _n_items(other._n_items)
+                    {
+                        other._queue = nullptr; // ownership is transferred
+                    }
+
+                    Batch(const Batch&) = delete;
+                    Batch& operator=(const Batch&) = delete;
+                    Batch& operator=(Batch&&) = delete;
+
+                    ~Batch() {
+
+                        release();
+
+                    }
+
+                    int size() const { return _isValid() ? _n_items : 0; }
+
+                    CMMap<Scalar, Layout> data(int i) const; // i-th tensor of the batch
+                    // (only while size() > 0)
+
+                    void release();
+
+                private:
+
+                    Batch() = default;
+
+                    bool _isValid() const { return _queue != nullptr && *_queue_open; }
+
+                    TensorQueue* _queue = nullptr;
+
+                    std::shared_ptr<const bool> _queue_open; // false once the
+                    // queue is closed (outlives it)
+
+                    uint64_t _pos = 0; // of the first tensor
+                    int _n_items = 0;
+
+            };
+
+            TensorQueue(std::string basename = "MyTensorQueue",
+                    std::string name_space = "",
+                    bool verbose = false,
+                    VLevel vlevel = VLevel::V0);
+
+            ~TensorQueue();
+
+            void create(int n_rows,
+                    int n_cols,
+                    int capacity, // max number of queued tensors
+                    bool force_reconnection = false); // the creator owns the
+            // queue (it is removed when the creator closes it)
+
+            void attach(); // blocks until the queue is created
+
+            void close();
+
+            bool isRunning();
+
+            bool tryPush(const TRef<Scalar, Layout> data); // false if full
+
+            bool push(const TRef<Scalar, Layout> data,
+                    int ms_timeout = -1); // waits for room (false on timeout
+            // or if the queue is closed). ms_timeout < 0 -> no timeout
+
+            bool tryPop(TRef<Scalar, Layout> output); // false if empty
+
+            bool pop(TRef<Scalar, Layout> output,
+                    int ms_timeout = -1); // waits for data (false on timeout
+            // or if the queue is closed). ms_timeout < 0 -> no timeout
+
+            Batch tryPopBatch(int max_items); // up to max_items tensors (empty
+            // batch if none is available). Never wraps around the end of the
+            // ring, so it may return less than what is queued
+
+            Batch popBatch(int max_items,
+                    int ms_timeout = -1); // waits for at least one tensor
+
+            int size(); // number of queued tensors (just a snapshot)
+
+            int getCapacity();
+
+            int getNRows();
+            int getNCols();
+
+            void set_wait_policy(WaitPolicy policy,
+                        int max_spin_us = 20); // for push() and pop()
+
+        private:
+
+            bool _verbose = false;
+
+            bool _is_owner = false;
+
+            bool _is_running = false;
+
+            int _n_rows = -1;
+            int _n_cols = -1;
+            int _capacity = -1;
+
+            int _shm_fd = -1;
+
+            std::size_t _mem_size = 0;
+
+            WaitPolicy _wait_policy = WaitPolicy::SpinThenBlock; // see set_wait_policy()
+
+            long long _max_spin_ns = 20000;
+
+            double _avg_wait_ns = 0.0; // running average of the last waits
+
+            std::string _basename, _namespace, _unique_id;
+
+            std::string THISNAME = "EigenIPC::TensorQueue";
+
+            std::string QUEUE_BASENAME = "Queue";
+
+            VLevel _vlevel = VLevel::V0; // minimal debug info
+
+            Journal _journal; // for rt-friendly logging
+
+            SharedMemConfig _mem_config;
+
+            ReturnCode _return_code = ReturnCode::NONE;
+
+            SyncUtils::QueueHeader* _header = nullptr;
+
+            std::shared_ptr<bool> _open; // shared with the batches (a new one
+            // for every create()/attach())
+
+            MMap<Scalar, Layout> _cellView(uint64_t pos);
+
+            void _commitPop(uint64_t pos, int n_items);
+
+            bool _openQueue(); // true if the queue is available
+
+            void _checkSize(int rows, int cols,
+                        std::string calling_method);
+
+            void _checkRunning(std::string calling_method);
+
+            std::string _getThisName(); // used to get this class
+            // name
+
+    };
+
+}
+
+#endif // TENSORQUEUE_HPP
@@ -0,0 +1,600 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+// 
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+// 
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+// 
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <EigenIPC/BroadcastRing.hpp>
+
+// private headers
+#include <MemUtils.hpp>
+#include <SyncUtils.hpp>
+#include <CopyUtils.hpp>
+
+namespace EigenIPC {
+
+    template <typename Scalar, int Layout>
+    BroadcastRing<Scalar, Layout>::BroadcastRing(std::string basename,
+                std::string name_space,
+                bool verbose,
+                VLevel vlevel)
+        : _verbose(verbose),
+        _basename(basename),
+        _namespace(name_space),
+        _unique_id(std::string("->")+ basename+std::string("-")+name_space),
+        _vlevel(vlevel),
+        _journal(Journal(_getThisName())),
+        _mem_config(basename + RING_BASENAME, name_space)
+    {
+
+    }
+
+    template <typename Scalar, int Layout>
+    BroadcastRing<Scalar, Layout>::~BroadcastRing() {
+
+        close();
+    }
+
+    template <typename Scalar, int Layout>
+    void BroadcastRing<Scalar, Layout>::create(int n_rows,
+                int n_cols,
+                int capacity,
+                bool force_reconnection) {
+
+        if (_is_running) {
+
+            return;
+        }
+
+        if (n_rows <= 0 || n_cols <= 0 || capacity < 2) {
+
+            _journal.log(__FUNCTION__+_unique_id,
+                "Invalid tensor size or capacity (at least 2 samples are needed)",
+                LogType::EXCEP,
+                true); // throw exception
+
+        }
+
+        _return_code = _return_code + ReturnCode::RESET;
+
+        // an already existing ring is either stale or owned by another writer
+        int other_fd = -1;
+        std::size_t other_size = 0;
+
+        void* other_mem = MemUtils::openMem(_mem_config.mem_path,
+                            other_fd,
+                            other_size,
+                            _journal,
+                            _return_code,
+                            false,
+                            _vlevel);
+
+        if (other_mem != nullptr) {
+
+            SyncUtils::BroadcastHeader* other = static_cast<SyncUtils::BroadcastHeader*>(other_mem);
+
+            if (other_size >= sizeof(SyncUtils::BroadcastHeader) &&
+                SyncUtils::isBroadcastReady(other) &&
+                SyncUtils::isBroadcastAlive(other)) {
+
+                if (!force_reconnection) {
+
+                    MemUtils::unmapMem(other_mem, other_size, other_fd);
+
+                    _journal.log(__FUNCTION__+_unique_id,
+                        "Another writer is already running at " + _mem_config.mem_path +
+                        ". Use force_reconnection to take over.",
+                        LogType::EXCEP,
+                        true); // throw exception
+
+                }
+
+                // the readers of the old ring give up
+                other->running.store(0, std::memory_order_release);
+
+                SyncUtils::futexWake(other->appends, INT_MAX);
+
+            }
+
+            MemUtils::unmapMem(other_mem, other_size, other_fd);
+
+            shm_unlink(_mem_config.mem_path.c_str());
+
+        }
+
+        _return_code = _return_code + ReturnCode::RESET;
+
+        std::size_t data_size = n_rows * n_cols * sizeof(Scalar);
+
+        _mem_size = SyncUtils::broadcastSize(capacity, data_size);
+
+        void* mem = MemUtils::initRawMem(_mem_size,
+                            _mem_config.mem_path,
+                            _shm_fd,
+                            _journal,
+                            _return_code,
+                            _verbose,
+                            _vlevel);
+
+        if (mem == nullptr) {
+
+            MemUtils::failWithCode(_return_code,
+                                _journal,
+                                __FUNCTION__,
+                                _mem_config.mem_path);
+        }
+
+        // memory is zero-initialized by ftruncate (all cells unstamped)
+        _header = new (mem) SyncUtils::BroadcastHeader;
+
+        _header->owner.store(static_cast<uint32_t>(getpid()), std::memory_order_relaxed);
+        _header->running.store(1, std::memory_order_relaxed);
+
+        _header->dtype = static_cast<int>(CppTypeToDType<Scalar>::value);
+        _header->mem_layout = Layout;
+        _header->n_rows = n_rows;
+        _header->n_cols = n_cols;
+        _header->capacity = capacity;
+        _header->slot_stride = SyncUtils::slotStride(data_size);
+
+        _header->head.store(0, std::memory_order_relaxed);
+        _header->appends.store(0, std::memory_order_relaxed);
+        _header->n_waiters.store(0, std::memory_order_relaxed);
+
+        // readers can now use it
+        _header->magic.store(SyncUtils::BROADCAST_MAGIC, std::memory_order_release);
+
+        _n_rows = n_rows;
+        _n_cols = n_cols;
+        _capacity = capacity;
+
+        _cursor = 0;
+        _lost = 0;
+
+        _is_writer = true;
+        _is_running = true;
+
+        if (_verbose &&
+            _vlevel > VLevel::V1) {
+
+            _journal.log(__FUNCTION__+_unique_id,
+                "Created broadcast ring at " + _mem_config.mem_path,
+                LogType::STAT);
+
+        }
+
+    }
+
+    template <typename Scalar, int Layout>
+    void BroadcastRing<Scalar, Layout>::attach() {
+
+        if (_is_running) {
+
+            return;
+        }
+
+        int msg_counter = 0;
+
+        while (!_openRing()) {
+
+            if (_verbose &&
+                _vlevel > VLevel::V0 &&
+                msg_counter % 4000 == 0) {
+
+                // only log every now and then
+                _journal.log(__FUNCTION__+_unique_id,
+                    "Waiting for the writer to be running...",
+                    LogType::WARN);
+
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1)); // no busy wait
+
+            msg_counter++;
+
+        }
+
+        std::string error;
+
+        if (_header->dtype != static_cast<int>(CppTypeToDType<Scalar>::value)) {
+
+            error = std::string("BroadcastRing attached with data type ") +
+                    MemUtils::getDTypeName(static_cast<int>(CppTypeToDType<Scalar>::value)) +
+                    std::string(", while the writer was initialized with ") +
+                    MemUtils::getDTypeName(_header->dtype);
+
+        } else if (_header->mem_layout != Layout) {
+
+            error = "Memory layout is not consistent with the one of the writer";
+
+        } else if (_mem_size < SyncUtils::broadcastSize(_header->capacity,
+                    _header->n_rows * _header->n_cols * sizeof(Scalar))) {
+
+            error = "The shared segment is too small for the advertised ring";
+
+        }
+
+        if (!error.empty()) {
+
+            MemUtils::unmapMem(_header, _mem_size, _shm_fd);
+
+            _header = nullptr;
+
+            _journal.log(__FUNCTION__+_unique_id,
+                error,
+                LogType::EXCEP,
+                true); // throw exception
+
+        }
+
+        _n_rows = _header->n_rows;
+        _n_cols = _header->n_cols;
+        _capacity = _header->capacity;
+
+        // only samples from now on
+        _cursor = _header->head.load(std::memory_order_acquire);
+        _lost = 0;
+
+        _is_writer = false;
+        _is_running = true;
+
+    }
+
+    template <typename Scalar, int Layout>
+    void BroadcastRing<Scalar, Layout>::close() {
+
+        if (!_is_running) {
+
+            return;
+        }
+
+        if (_is_writer) {
+
+            // readers waiting for samples give up
+            _header->running.store(0, std::memory_order_release);
+
+            SyncUtils::futexWake(_header->appends, INT_MAX);
+
+        }
+
+        bool taken_over = MemUtils::isUnlinked(_shm_fd); // by another
+        // writer (force_reconnection)
+
+        MemUtils::unmapMem(_header, _mem_size, _shm_fd);
+
+        if (_is_writer && !taken_over) {
+
+            shm_unlink(_mem_config.mem_path.c_str());
+        }
+
+        _header = nullptr;
+
+        _is_running = false;
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool BroadcastRing<Scalar, Layout>::isRunning() {
+
+        return _is_running && SyncUtils::isBroadcastAlive(_header);
+
+    }
+
+    template <typename Scalar, int Layout>
+    uint64_t BroadcastRing<Scalar, Layout>::append(const TRef<Scalar, Layout> data) {
+
+        _checkRunning(std::string(__FUNCTION__));
+
+        if (!_is_writer) {
+
+            _journal.log(__FUNCTION__+_unique_id,
+                "Only the writer (see create()) can append samples",
+                LogType::EXCEP,
+                true); // throw exception
+
+        }
+
+        _checkSize(data.rows(), data.cols(), std::string(__FUNCTION__));
+
+        // we are the only ones moving the head
+        uint64_t seq = _header->head.load(std::memory_order_relaxed);
+
+        SyncUtils::broadcastWriteBegin(_header, seq);
+
+        CopyUtils::copy(_cellView(seq), data, true);
+
+        SyncUtils::broadcastWriteEnd(_header, seq);
+
+        return seq;
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool BroadcastRing<Scalar, Layout>::tryRead(TRef<Scalar, Layout> output) {
+
+        _checkRunning(std::string(__FUNCTION__));
+
+        _checkSize(output.rows(), output.cols(), std::string(__FUNCTION__));
+
+        return _tryRead(output);
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool BroadcastRing<Scalar, Layout>::read(TRef<Scalar, Layout> output,
+                int ms_timeout) {
+
+        _checkRunning(std::string(__FUNCTION__));
+
+        _checkSize(output.rows(), output.cols(), std::string(__FUNCTION__));
+
+        uint32_t appends = 0;
+
+        long long start_ns = SyncUtils::nowNs();
+
+        // every append bumps the futex word
+        bool success = SyncUtils::futexWaitUntil(_header->appends,
+                            _header->n_waiters,
+                            appends,
+                            [&](uint32_t) { return _tryRead(output); },
+                            [&]() { return SyncUtils::isBroadcastAlive(_header); },
+                            ms_timeout,
+                            SyncUtils::spinBudget(_wait_policy, _max_spin_ns, _avg_wait_ns));
+
+        if (success) {
+
+            SyncUtils::updateAvgWait(_avg_wait_ns, SyncUtils::nowNs() - start_ns);
+        }
+
+        return success;
+
+    }
+
+    template <typename Scalar, int Layout>
+    int BroadcastRing<Scalar, Layout>::readLast(std::vector<Tensor<Scalar, Layout>>& outputs,
+                int k) {
+
+        _checkRunning(std::string(__FUNCTION__));
+
+        uint64_t head = _header->head.load(std::memory_order_acquire);
+
+        // the oldest cell might be under rewrite
+        uint64_t n_last = std::min<uint64_t>(std::max(k, 0), _capacity - 1);
+
+        uint64_t first = head > n_last ? head - n_last : 0;
+
+        if (outputs.size() < head - first) {
+
+            outputs.resize(head - first);
+        }
+
+        int n_read = 0;
+
+        for (uint64_t seq = first; seq < head; ++seq) {
+
+            outputs[n_read].resize(_n_rows, _n_cols); // no-op if already sized
+
+            TRef<Scalar, Layout> output(outputs[n_read]);
+
+            if (_readAt(seq, output)) {
+
+                n_read++;
+
+            } else {
+
+                _lost++; // overwritten while catching up
+            }
+
+        }
+
+        _cursor = std::max(_cursor, head);
+
+        return n_read;
+
+    }
+
+    template <typename Scalar, int Layout>
+    uint64_t BroadcastRing<Scalar, Layout>::getHead() {
+
+        _checkRunning(std::string(__FUNCTION__));
+
+        return _header->head.load(std::memory_order_acquire);
+
+    }
+
+    template <typename Scalar, int Layout>
+    uint64_t BroadcastRing<Scalar, Layout>::getCursor() {
+
+        return _cursor;
+    }
+
+    template <typename Scalar, int Layout>
+    uint64_t BroadcastRing<Scalar, Layout>::getLost() {
+
+        return _lost;
+    }
+
+    template <typename Scalar, int Layout>
+    int BroadcastRing<Scalar, Layout>::getCapacity() {
+
+        return _capacity;
+    }
+
+    template <typename Scalar, int Layout>
+    int BroadcastRing<Scalar, Layout>::getNRows() {
+
+        return _n_rows;
+    }
+
+    template <typename Scalar, int Layout>
+    int BroadcastRing<Scalar, Layout>::getNCols() {
+
+        return _n_cols;
+    }
+
+    template <typename Scalar, int Layout>
+    void BroadcastRing<Scalar, Layout>::set_wait_policy(WaitPolicy policy,
+                int max_spin_us) {
+
+        _wait_policy = policy;
+
+        _max_spin_ns = std::max(0, max_spin_us) * 1000LL;
+
+        _avg_wait_ns = 0.0;
+
+    }
+
+    template <typename Scalar, int Layout>
+    MMap<Scalar, Layout> BroadcastRing<Scalar, Layout>::_cellView(uint64_t seq) {
+
+        return MMap<Scalar, Layout>(reinterpret_cast<Scalar*>(
+                    SyncUtils::broadcastData(_header, seq % _capacity)),
+                    _n_rows, _n_cols);
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool BroadcastRing<Scalar, Layout>::_tryRead(TRef<Scalar, Layout>& output) {
+
+        while (true) {
+
+            uint64_t head = _header->head.load(std::memory_order_acquire);
+
+            if (_cursor >= head) {
+
+                return false; // nothing new
+            }
+
+            if (head - _cursor > static_cast<uint64_t>(_capacity - 1)) {
+
+                // overrun: we skip to the oldest sample which is
+                // still safe to read (the oldest cell might be under rewrite)
+                uint64_t oldest = head - (_capacity - 1);
+
+                _lost += oldest - _cursor;
+
+                _cursor = oldest;
+
+            }
+
+            if (_readAt(_cursor, output)) {
+
+                _cursor++;
+
+                return true;
+            }
+
+            // overwritten while copying -> the head moved on
+
+        }
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool BroadcastRing<Scalar, Layout>::_readAt(uint64_t seq,
+                TRef<Scalar, Layout>& output) {
+
+        if (!SyncUtils::broadcastReadBegin(_header, seq)) {
+
+            return false;
+        }
+
+        CopyUtils::copy(output, _cellView(seq));
+
+        return SyncUtils::broadcastReadValidate(_header, seq);
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool BroadcastRing<Scalar, Layout>::_openRing() {
+
+        _return_code = _return_code + ReturnCode::RESET;
+
+        void* mem = MemUtils::openMem(_mem_config.mem_path,
+                            _shm_fd,
+                            _mem_size,
+                            _journal,
+                            _return_code,
+                            false,
+                            _vlevel);
+
+        if (mem == nullptr) {
+
+            return false; // not created yet
+        }
+
+        SyncUtils::BroadcastHeader* header = static_cast<SyncUtils::BroadcastHeader*>(mem);
+
+        if (_mem_size < sizeof(SyncUtils::BroadcastHeader) ||
+            !SyncUtils::isBroadcastReady(header) ||
+            !SyncUtils::isBroadcastAlive(header)) {
+
+            // being initialized or stale
+            MemUtils::unmapMem(mem, _mem_size, _shm_fd);
+
+            return false;
+
+        }
+
+        _header = header;
+
+        return true;
+
+    }
+
+    template <typename Scalar, int Layout>
+    void BroadcastRing<Scalar, Layout>::_checkSize(int rows, int cols,
+                std::string calling_method) {
+
+        if (rows != _n_rows || cols != _n_cols) {
+
+            _journal.log(calling_method+_unique_id,
+                "Tensor size does not match the one of the ring",
+                LogType::EXCEP,
+                true); // throw exception
+
+        }
+    }
+
+    template <typename Scalar, int Layout>
+    void BroadcastRing<Scalar, Layout>::_checkRunning(std::string calling_method) {
+
+        if (!_is_running) {
+
+            _journal.log(calling_method+_unique_id,
+                "Not running. Did you call create() or attach()?",
+                LogType::EXCEP,
+                true); // throw exception
+
+        }
+    }
+
+    template <typename Scalar, int Layout>
+    std::string BroadcastRing<Scalar, Layout>::_getThisName() {
+
+        return THISNAME;
+    }
+
+    // explicit instantiations for specific supported types
+    // and layouts
+    template class BroadcastRing<double, ColMajor>;
+    template class BroadcastRing<float, ColMajor>;
+    template class BroadcastRing<int, ColMajor>;
+    template class BroadcastRing<bool, ColMajor>;
+
+    template class BroadcastRing<double, RowMajor>;
+    template class BroadcastRing<float, RowMajor>;
+    template class BroadcastRing<int, RowMajor>;
+    template class BroadcastRing<bool, RowMajor>;
+}
@@ -25,6 +25,9 @@
 
 // private headers
 #include <MemUtils.hpp>
+#include <SyncUtils.hpp>
+#include <CopyUtils.hpp>
+#include <NotifyUtils.hpp>
 
 namespace EigenIPC {
 
@@ -43,34 +46,13 @@ namespace EigenIPC {
         _tensor_view(nullptr,
                     -1,
                     -1),
-        _n_rows_view(nullptr,
-                    1,
-                    1),
-        _n_cols_view(nullptr,
-                    1,
-                    1),
-        _n_clients_view(nullptr,
-                        1,
-                        1),
-        _dtype_view(nullptr,
-                    1,
-                    1),
-        _isrunning_view(nullptr,
-                        1,
-                        1),
-        _mem_layout_view(nullptr,
-                    1,
-                    1),
         _journal(Journal(_getThisName()))
     {
 
         static_assert(MemUtils::IsValidDType<Scalar>::value,
                 "Invalid data type provided.");
 
-        // sem acquisition timeout settings
-        long timeoutInNanoseconds = (long)(_sem_acq_timeout * 1e9);
-        _sem_timeout.tv_sec = 0;
-        _sem_timeout.tv_nsec = timeoutInNanoseconds % 1000000000;
+        _pid = static_cast<uint32_t>(getpid()); // identifies us as owner of the data lock
 
         _terminated = false; // just in case
 
@@ -118,24 +100,35 @@ namespace EigenIPC {
 
         }
 
-        _initMetaMem(); // initializes meta-memory
+        _waitForServer(); // maps the server's memory (as soon as it is available)
+        // and waits until the server is properly initialized. From this point on,
+        // metadata does not change
 
-        _waitForServer();  // waits until server is properly initialized
+        _completeAttach();
 
-        _initSems(); // creates necessary semaphores
+        if (_verbose &&
+            _vlevel > VLevel::V1) {
+
+            std::string info = std::string("Client at ") +
+                    _mem_config.mem_path + std::string(" initialized and attached.");
+
+            _journal.log(__FUNCTION__,
+                 info,
+                 LogType::STAT);
+
+        }
+    }
+
+    template <typename Scalar, int Layout>
+    void Client<Scalar, Layout>::_completeAttach()
+    {
 
-        // acquire shared data semaphore or waits for it
-        // (at this point is actually guaranteed to be free anyway)
-        _acquireData(true, true); // blocking
+        _checkVersion(); // checks header compatibility
 
         _checkDType(); // checks data type consistency
 
         _checkMemLayout(); // checks memory layout consistency
 
-        _n_rows = _n_rows_view(0, 0);
-        _n_cols = _n_cols_view(0, 0);
-        _n_clients_view(0, 0) = _n_clients_view(0, 0) + 1; // increase clients counter
-
         // we have now all the info to create the shared tensor
         _initDataMem();
 
@@ -143,22 +136,89 @@ namespace EigenIPC {
                                             _n_cols); // used to hold
         // a copy of the shared tensor data
 
-        // releasing data semaphore so that other clients/the server can access the tensor
-        _releaseData();
+        _last_generation = _header->generation.load(std::memory_order_acquire); // only
+        // writes from now on are reported by waitForUpdate()
 
-        _attached = true;
+        // registration (also updates the clients counter)
+        _client_slot = SyncUtils::clientClaimSlot(_header, _pid,
+                                SyncUtils::procStartTime(_pid));
 
-        if (_verbose &&
-            _vlevel > VLevel::V1) {
+        if (_client_slot < 0) {
 
-            std::string info = std::string("Client at ") +
-                    _mem_config.mem_path + std::string(" initialized and attached.");
+            std::string error = std::string("No client slot left at ") +
+                    _mem_config.mem_path + std::string(" (at most ") +
+                    std::to_string(SyncUtils::MAX_CLIENTS) + std::string(" clients per tensor)");
 
             _journal.log(__FUNCTION__,
-                 info,
-                 LogType::STAT);
+                error,
+                LogType::EXCEP,
+                true); // throw exception
 
         }
+
+        _attached = true;
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool Client<Scalar, Layout>::attachAll(const std::vector<Client*>& clients,
+                                int ms_timeout)
+    {
+
+        long long deadline_ns = ms_timeout >= 0 ?
+                    SyncUtils::nowNs() + ms_timeout * 1000000LL : -1;
+
+        while (true) {
+
+            bool all_attached = true;
+
+            for (Client* client : clients) {
+
+                if (client->_attached) {
+
+                    continue;
+                }
+
+                if (client->_isServerReady()) {
+
+                    client->_completeAttach();
+
+                } else {
+
+                    all_attached = false;
+                }
+
+            }
+
+            if (all_attached) {
+
+                return true;
+            }
+
+            // a single watch for all the servers: each event is checked against
+            // all the clients which are still waiting (and all are checked again
+            // once watching)
+            MemUtils::ShmWatch& watch = MemUtils::shmWatch();
+
+            int wait_ms = SyncUtils::WAIT_CHECK_NS / 1000000; // in case of missed events
+
+            if (deadline_ns >= 0) {
+
+                long long remaining_ns = deadline_ns - SyncUtils::nowNs();
+
+                if (remaining_ns <= 0) {
+
+                    return false; // the clients attached so far stay attached
+                }
+
+                wait_ms = static_cast<int>(std::min<long long>(wait_ms,
+                                (remaining_ns + 999999) / 1000000));
+            }
+
+            watch.wait(wait_ms);
+
+        }
+
     }
 
     template <typename Scalar, int Layout>
@@ -178,13 +238,13 @@ namespace EigenIPC {
 
             }
 
-            _acquireData(true, true); // blocking (probably not necessary, 
-            // int operations should be atomic on 64 bit machines)
+            SyncUtils::clientReleaseSlot(_header, _client_slot); // also updates the
+            // clients counter
 
-            _n_clients_view(0, 0) = _n_clients_view(0, 0) - 1; // increase clients counter
+            _client_slot = -1;
 
-            // releasing data semaphore so that other clients/the server can access the tensor
-            _releaseData();
+            NotifyUtils::notifyDisconnect(_notify_fd, _notify_conn_fd); // the
+            // server drops us at its next update
 
             _attached = false;
 
@@ -241,6 +301,25 @@ namespace EigenIPC {
 
     }
 
+    template <typename Scalar, int Layout>
+    uint64_t Client<Scalar, Layout>::getDataVersion() const {
+
+        if (_header == nullptr) {
+
+            return 0;
+        }
+
+        return _header->data_version.load(std::memory_order_acquire);
+
+    }
+
+    template <typename Scalar, int Layout>
+    SyncMode Client<Scalar, Layout>::getSyncMode() const {
+
+        return _sync_mode;
+
+    }
+
     template <typename Scalar, int Layout>
     std::string Client<Scalar, Layout>::getNamespace() const {
 
@@ -282,171 +361,424 @@ namespace EigenIPC {
                                  int row,
                                  int col) {
 
-        if (_attached) {
+        return _write(data, row, col);
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool Client<Scalar, Layout>::write(const TensorView<Scalar, Layout>& data,
+                                     int row,
+                                     int col) {
+
+        return _write(data, row, col);
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool Client<Scalar, Layout>::read(TRef<Scalar, Layout> output,
+                                    int row, int col) {
+
+        return _read(output, row, col);
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool Client<Scalar, Layout>::read(TensorView<Scalar, Layout>& output,
+                                    int row, int col) {
+
+        return _read(output, row, col);
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool Client<Scalar, Layout>::readChanged(TRef<Scalar, Layout> output,
+                                    uint64_t& since_version,
+                                    std::vector<int>& changed_rows) {
+
+        if (!_attached) {
+
+            _checkIsAttached();
+
+            return false;
+        }
+
+        if (!helpers::canFitTensor(output.rows(), output.cols(),
+                        0, 0,
+                        _n_rows, _n_cols,
+                        _journal,
+                        _return_code,
+                        false,
+                        _vlevel)) {
+
+            return false;
+        }
+
+        // rows with version <= the current data version are
+        // guaranteed to be in the data we copy from
+        uint64_t version = 0;
+
+        bool success_read = false;
+
+        if (_safe && _sync_mode == SyncMode::Ring) {
+
+            // loaded before picking the slot (writers publish the slot
+            // before marking the rows)
+            version = _header->data_version.load(std::memory_order_acquire);
+
+            success_read = SyncUtils::ringRead(_header,
+                            [&](int slot) {
+                                return _copyChanged(output,
+                                            SyncUtils::slotView<Scalar, Layout>(
+                                                _header, slot,
+                                                _n_rows, _n_cols),
+                                            since_version,
+                                            changed_rows);
+                            },
+                            _seq_max_retries,
+                            _return_code);
+
+        } else if (_safe && _sync_mode == SyncMode::SeqLock) {
+
+            // versions are updated within the write -> consistent with the data
+            success_read = SyncUtils::seqRead(_header->seq,
+                            [&]() {
+                                version = _header->data_version.load(
+                                                std::memory_order_relaxed);
+
+                                return _copyChanged(output,
+                                            _tensor_view,
+                                            since_version,
+                                            changed_rows);
+                            },
+                            _seq_max_retries,
+                            _return_code);
+
+        } else {
 
             _data_acquired = true;
 
             if (_safe) {
 
-                // first acquire data semaphore
-                _data_acquired = _acquireData(false, false);
+                // the whole tensor (all stripes, with SyncMode::Striped)
+                _data_acquired = _acquireBlock(0, _n_rows);
             }
 
-            if(_data_acquired) {
+            if (!_data_acquired) {
 
-                bool success_write = MemUtils::write<Scalar, Layout>(
-                                        data,
-                                        _tensor_view,
-                                        row, col,
-                                        _journal,
-                                        _return_code,
-                                        false,
-                                        _vlevel);
+                return false; // failed to acquire lock
+            }
 
-                if (_safe) {
-                    _releaseData();
+            version = _header->data_version.load(std::memory_order_acquire);
+
+            success_read = _copyChanged(output,
+                                _tensor_view,
+                                since_version,
+                                changed_rows);
+
+            if (_safe) {
+                _releaseBlock();
+            }
+
+        }
+
+        if (success_read) {
+
+            since_version = version;
+        }
+
+        return success_read;
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool Client<Scalar, Layout>::_copyChanged(TRef<Scalar, Layout> output,
+                                    const MMap<Scalar, Layout>& data,
+                                    uint64_t since_version,
+                                    std::vector<int>& changed_rows) {
+
+        changed_rows.clear(); // (keeps its capacity)
+
+        const std::atomic<uint64_t>* row_versions = SyncUtils::rowVersions(_header);
+
+        int first = -1; // of the current run of changed rows
+
+        for (int i = 0; i <= _n_rows; ++i) {
+
+            bool changed = i < _n_rows &&
+                    (since_version == 0 ||
+                    row_versions[i].load(std::memory_order_relaxed) > since_version);
+
+            if (changed) {
+
+                changed_rows.push_back(i);
+
+                if (first < 0) {
+                    first = i;
                 }
 
-                return success_write;
+            } else if (first >= 0) {
 
-            } else {
+                // consecutive changed rows are copied at once
+                output.block(first, 0, i - first, _n_cols) =
+                        data.block(first, 0, i - first, _n_cols);
+
+                first = -1;
 
-                return false; // failed to acquire sem
             }
 
         }
 
-        _checkIsAttached(); // cannot write if client is not
-        //attached
+        return true;
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool Client<Scalar, Layout>::waitForUpdate(int ms_timeout) {
+
+        if (_attached) {
+
+            SyncUtils::clientHeartbeat(_header, _client_slot);
+
+            // sleeps on the generation counter in the shared header
+            // (no polling, woken up by the writer)
+            return SyncUtils::waitUpdate(_header,
+                                _last_generation,
+                                ms_timeout);
+
+        }
+
+        _checkIsAttached();
 
         return false;
 
     }
 
     template <typename Scalar, int Layout>
-    bool Client<Scalar, Layout>::write(const TensorView<Scalar, Layout>& data,
-                                     int row,
-                                     int col) {
+    int Client<Scalar, Layout>::getNotifyFd() {
 
-        if (_attached) {
+        if (!_attached) {
 
-            _data_acquired = true;
+            _checkIsAttached();
 
-            if (_safe) {
+            return -1;
+        }
 
-                // first acquire data semaphore
-                _data_acquired = _acquireData(false, false);
-            }
+        if (_notify_fd == -1) {
 
-            if(_data_acquired) {
+            // our own eventfd, handed over to the server (once)
+            _notify_fd = NotifyUtils::notifyConnect(_mem_config.mem_path,
+                                _notify_conn_fd);
+
+        }
+
+        return _notify_fd;
+
+    }
+
+    template <typename Scalar, int Layout>
+    uint64_t Client<Scalar, Layout>::clearNotify() {
+
+        return NotifyUtils::notifyClear(_notify_fd);
+
+    }
+
+    template <typename Scalar, int Layout>
+    template <typename DataT>
+    bool Client<Scalar, Layout>::_ringWrite(const DataT& data,
+                                    int row,
+                                    int col) {
+
+        // writers are serialized by the data lock -> the latest
+        // slot cannot change under our feet
+        int latest = _header->latest.load(std::memory_order_relaxed);
+        int next = SyncUtils::ringNextSlot(_header);
 
-                bool success_write = MemUtils::write<Scalar, Layout>(
+        MMap<Scalar, Layout> next_view = SyncUtils::slotView<Scalar, Layout>(
+                                    _header, next,
+                                    _n_rows, _n_cols);
+
+        std::atomic<uint64_t>& seq = SyncUtils::slots(_header)[next].seq;
+
+        SyncUtils::seqWriteBegin(seq); // lets slow readers of this slot detect the overwrite
+
+        if (data.rows() != _n_rows || data.cols() != _n_cols) {
+
+            // partial write -> the rest of the tensor comes from the latest slot
+            CopyUtils::copy(next_view,
+                                    SyncUtils::slotView<Scalar, Layout>(
+                                        _header, latest,
+                                        _n_rows, _n_cols),
+                                    true); // streaming stores
+
+        }
+
+        bool success_write = MemUtils::write<Scalar, Layout>(
                                         data,
-                                        _tensor_view,
+                                        next_view,
                                         row, col,
                                         _journal,
                                         _return_code,
                                         false,
                                         _vlevel);
 
-                if (_safe) {
-                    _releaseData();
-                }
-
-                return success_write;
+        SyncUtils::seqWriteEnd(seq);
 
-            } else {
-
-                return false; // failed to acquire sem
-            }
+        if (success_write) {
 
+            SyncUtils::ringPublish(_header, next);
         }
 
-        _checkIsAttached();
-
-        return false;
+        return success_write;
 
     }
 
     template <typename Scalar, int Layout>
-    bool Client<Scalar, Layout>::read(TRef<Scalar, Layout> output,
-                                    int row, int col) {
+    template <typename DataT>
+    bool Client<Scalar, Layout>::_write(const DataT& data,
+                                    int row,
+                                    int col) {
 
         if (_attached) {
 
+            SyncUtils::clientHeartbeat(_header, _client_slot);
+
             _data_acquired = true;
 
             if (_safe) {
 
-                // first acquire data semaphore
-                _data_acquired = _acquireData(false, false);
+                // first acquire data lock (with SyncMode::SeqLock
+                // this only serializes concurrent writers: readers never take it)
+                _data_acquired = _acquireBlock(row, data.rows());
             }
 
             if(_data_acquired) {
 
-                bool success_read = MemUtils::read<Scalar, Layout>(
-                            row, col,
-                            output,
-                            _tensor_view,
-                            _journal,
-                            _return_code,
-                            false,
-                            _vlevel);
+                bool seq_locked = _safe && _sync_mode == SyncMode::SeqLock;
+
+                if (seq_locked) {
+                    SyncUtils::seqWriteBegin(_header->seq);
+                }
+
+                bool success_write = (_safe && _sync_mode == SyncMode::Ring) ?
+                                        _ringWrite(data, row, col) :
+                                        MemUtils::write<Scalar, Layout>(
+                                            data,
+                                            _tensor_view,
+                                            row, col,
+                                            _journal,
+                                            _return_code,
+                                            false,
+                                            _vlevel);
+
+                if (success_write) {
+                    SyncUtils::markRows(_header, row, data.rows()); // for readChanged()
+                }
+
+                if (seq_locked) {
+                    SyncUtils::seqWriteEnd(_header->seq);
+                }
 
                 if (_safe) {
-                    _releaseData();
+                    _releaseBlock();
                 }
 
-                return success_read;
+                if (success_write) {
+                    SyncUtils::notifyUpdate(_header); // wakes up waitForUpdate()
+                }
+
+                return success_write;
 
             } else {
 
-                return false; // failed to acquire sem
+                return false; // failed to acquire lock
             }
 
         }
 
-        _checkIsAttached();
+        _checkIsAttached(); // cannot write if client is not
+        //attached
 
         return false;
 
     }
 
     template <typename Scalar, int Layout>
-    bool Client<Scalar, Layout>::read(TensorView<Scalar, Layout>& output,
+    template <typename OutT>
+    bool Client<Scalar, Layout>::_read(OutT& output,
                                     int row, int col) {
 
         if (_attached) {
 
+            SyncUtils::clientHeartbeat(_header, _client_slot);
+
+            if (_safe && _sync_mode == SyncMode::Ring) {
+
+                // lock-free: copies out of the latest published slot
+                return SyncUtils::ringRead(_header,
+                            [&](int slot) {
+                                return MemUtils::read<Scalar, Layout>(
+                                            row, col,
+                                            output,
+                                            SyncUtils::slotView<Scalar, Layout>(
+                                                _header, slot,
+                                                _n_rows, _n_cols),
+                                            _journal,
+                                            _return_code,
+                                            false,
+                                            _vlevel);
+                            },
+                            _seq_max_retries,
+                            _return_code);
+
+            }
+
+            if (_safe && _sync_mode == SyncMode::SeqLock) {
+
+                // lock-free: retries the copy until it's not torn by a write
+                return SyncUtils::seqRead(_header->seq,
+                            [&]() {
+                                return MemUtils::read<Scalar, Layout>(
+                                            row, col,
+                                            output,
+                                            _tensor_view,
+                                            _journal,
+                                            _return_code,
+                                            false,
+                                            _vlevel);
+                            },
+                            _seq_max_retries,
+                            _return_code);
+
+            }
+
             _data_acquired = true;
 
             if (_safe) {
 
-                // first acquire data semaphore
-                _data_acquired = _acquireData(false, false);
+                // first acquire data lock
+                _data_acquired = _acquireBlock(row, output.rows());
             }
 
             if(_data_acquired) {
 
                 bool success_read = MemUtils::read<Scalar, Layout>(
-                                       row, col,
-                                       output,
-                                       _tensor_view,
-                                       _journal,
-                                       _return_code,
-                                       false,
-                                       _vlevel);
+                            row, col,
+                            output,
+                            _tensor_view,
+                            _journal,
+                            _return_code,
+                            false,
+                            _vlevel);
 
                 if (_safe) {
-                    _releaseData();
+                    _releaseBlock();
                 }
 
                 return success_read;
 
             } else {
 
-                return false; // failed to acquire sem
-
+                return false; // failed to acquire lock
             }
 
         }
@@ -455,15 +787,34 @@ namespace EigenIPC {
 
         return false;
 
-    } 
+    }
 
     template <typename Scalar, int Layout>
     void Client<Scalar, Layout>::dataSemAcquire() 
     {
+
+        if (_sync_mode == SyncMode::Striped) {
+
+            // the whole tensor -> all stripes
+            _stripe_first = 0;
+            _stripe_last = _header->n_stripes - 1;
+
+            if (!SyncUtils::acquireStripes(_header,
+                        _stripe_first, _stripe_last,
+                        true, // blocking
+                        _return_code)) {
+
+                MemUtils::failWithCode(_return_code,
+                                   _journal,
+                                   __FUNCTION__);
+
+            }
+
+            return;
+
+        }
         
-        _acquireSemBlocking(_mem_config.mem_path_data_sem,
-                    _data_sem,
-                    _verbose);
+        _acquireData(true, _verbose);
 
     }
 
@@ -471,9 +822,17 @@ namespace EigenIPC {
     void Client<Scalar, Layout>::dataSemRelease() 
     {
 
-        _releaseSem(_mem_config.mem_path_data_sem,
-                    _data_sem,
-                    _verbose);
+        if (_sync_mode == SyncMode::Striped) {
+
+            SyncUtils::releaseStripes(_header,
+                        0, _header->n_stripes - 1,
+                        _return_code);
+
+            return;
+
+        }
+
+        _releaseData();
 
     }
 
@@ -488,12 +847,25 @@ namespace EigenIPC {
                         _mem_config.mem_path +
                         std::string(" to running state...");
 
-        while(!(_isrunning_view(0, 0) > 0)) {
+        if (_isServerReady()) {
+
+            return; // no need to watch anything
+        }
+
+        // woken up as soon as the memory is created or the server runs
+        // (see MemUtils::touchMem()), instead of polling
+        MemUtils::ShmWatch& watch = MemUtils::shmWatch();
+
+        long long log_ns = 0;
+
+        while(!_isServerReady()) { // checked again once watching
             
             if (_verbose &&
                 _vlevel > VLevel::V0) {
 
-                    if (_msg_counter % _msg_sample_interval == 0) {
+                    long long now_ns = SyncUtils::nowNs();
+
+                    if (now_ns - log_ns >= _msg_sample_interval * 1000000LL) {
                         
                         // only log every now and then
                         
@@ -501,31 +873,111 @@ namespace EigenIPC {
                             info,
                             LogType::WARN);
 
+                        log_ns = now_ns;
+
                     }
 
             }
 
-            
-            std::this_thread::sleep_for(std::chrono::milliseconds(1)); // no busy wait
+            watch.wait(SyncUtils::WAIT_CHECK_NS / 1000000); // periodic check,
+            // in case of missed events
 
             _msg_counter++;
 
         }
 
         _msg_counter = 0; // reset counter
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool Client<Scalar, Layout>::_isServerReady()
+    {
+
+        return _mapMem() &&
+            _header->is_running.load(std::memory_order_acquire) > 0;
+
+    }
+
+    template <typename Scalar, int Layout>
+    void Client<Scalar, Layout>::_checkVersion()
+    {
+
+        if (_header->version != SyncUtils::HEADER_VERSION) {
+
+            std::string error = std::string("Server at ") +
+                    _mem_config.mem_path +
+                    std::string(" uses memory header version ") +
+                    std::to_string(_header->version) +
+                    std::string(", while this Client expects version ") +
+                    std::to_string(SyncUtils::HEADER_VERSION);
+
+            _journal.log(__FUNCTION__,
+                         error,
+                         LogType::EXCEP,
+                         true); // actually raise exception
+
+        }
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool Client<Scalar, Layout>::_mapMem()
+    {
+
+        if (_header != nullptr &&
+            !MemUtils::isUnlinked(_data_shm_fd)) {
+
+            return SyncUtils::isHeaderReady(_header);
+        }
+
+        // not mapped yet or stale memory (e.g. the server was closed and created again):
+        // we (re)open the memory, which costs a single shm_open + mmap
+        MemUtils::unmapMem(_header, _mem_size, _data_shm_fd);
+
+        _header = nullptr;
+
+        _return_code = _return_code + ReturnCode::RESET;
+
+        void* mem = MemUtils::openMem(_mem_config.mem_path,
+                            _data_shm_fd,
+                            _mem_size,
+                            _journal,
+                            _return_code,
+                            false, // failures are expected until the server creates the memory
+                            _vlevel);
+
+        _return_code = _return_code + ReturnCode::RESET;
+
+        if (mem == nullptr) {
+
+            return false;
+        }
+
+        if (_mem_size < sizeof(SyncUtils::MemHeader)) { // not sized yet
+
+            MemUtils::unmapMem(mem, _mem_size, _data_shm_fd);
+
+            return false;
+        }
+
+        _header = reinterpret_cast<SyncUtils::MemHeader*>(mem);
+
+        return SyncUtils::isHeaderReady(_header);
+
     }
 
     template <typename Scalar, int Layout>
     void Client<Scalar, Layout>::_checkDType()
     {
-        if (_dtype_view(0, 0) != sizeof(Scalar)) {
+        if (_header->dtype != sizeof(Scalar)) {
 
             // not impeccable: different types may have in general different sizes
 
             std::string error = std::string("Client initialized with element size of ") +
                     std::to_string(sizeof(Scalar)) +
                     std::string(", while the Server was initialized with size ") +
-                    std::to_string(_dtype_view(0, 0));
+                    std::to_string(_header->dtype);
 
             _journal.log(__FUNCTION__,
                          error,
@@ -538,12 +990,12 @@ namespace EigenIPC {
     template <typename Scalar, int Layout>
     void Client<Scalar, Layout>::_checkMemLayout()
     {
-        if (_mem_layout_view(0, 0) != _mem_layout) {
+        if (_header->mem_layout != _mem_layout) {
 
             std::string error = std::string("Client initialized with memory layout ") +
                     MemUtils::getLayoutName(_mem_layout) +
                     std::string(", while the Server was initialized with layout ") +
-                    MemUtils::getLayoutName(_mem_layout_view(0, 0));
+                    MemUtils::getLayoutName(_header->mem_layout);
 
             _journal.log(__FUNCTION__,
                          error,
@@ -555,204 +1007,229 @@ namespace EigenIPC {
     }
 
     template <typename Scalar, int Layout>
-    void Client<Scalar, Layout>::_acquireSemTimeout(const std::string& sem_path,
-                                    sem_t*& sem,
-                                    bool verbose)
+    typename Client<Scalar, Layout>::ReadView Client<Scalar, Layout>::acquireView(
+                                    int row, int col,
+                                    int n_rows, int n_cols)
     {
-        _return_code = _return_code + ReturnCode::RESET;
 
-        MemUtils::acquireSemTimeout(sem_path,
-                        sem,
+        ReadView view; // invalid until the data is actually borrowed
+
+        if (!_attached) {
+
+            _checkIsAttached();
+
+            return view;
+
+        }
+
+        if (!helpers::canFitTensor(_n_rows, _n_cols,
+                        row, col,
+                        n_rows, n_cols,
                         _journal,
                         _return_code,
-                        _sem_timeout,
                         false,
-                        verbose,
-                        _vlevel);
+                        _vlevel)) {
 
-        if (isin(ReturnCode::SEMACQFAIL, _return_code)) {
-
-            MemUtils::failWithCode(_return_code,
-                                   _journal,
-                                   __FUNCTION__); // throws exception
+            return view;
 
         }
 
-        _return_code = _return_code + ReturnCode::RESET;
+        bool acquired = true;
 
-    }
+        if (_safe && _sync_mode == SyncMode::SeqLock) {
 
-    template <typename Scalar, int Layout>
-    bool Client<Scalar, Layout>::_acquireSemOneShot(const std::string& sem_path,
-                                     sem_t*& sem)
-    {
-        _return_code = _return_code + ReturnCode::RESET;
+            acquired = SyncUtils::seqReadBegin(_header->seq,
+                            view._epoch,
+                            _seq_max_retries);
 
-        MemUtils::acquireSemOneShot(sem_path,
-                        sem,
-                        _journal,
-                        _return_code,
-                        _verbose,
-                        VLevel::V0);
+        } else if (_safe && _sync_mode == SyncMode::Ring) {
 
-        if (isin(ReturnCode::SEMACQFAIL,
-                 _return_code)) {
+            acquired = false;
 
-            return false;
+            for (int i = 0; i < _seq_max_retries && !acquired; ++i) {
 
-        }
+                acquired = SyncUtils::ringReadBegin(_header,
+                            view._slot,
+                            view._epoch);
+            }
 
-        _return_code = _return_code + ReturnCode::RESET;
+        } else if (_safe && _sync_mode == SyncMode::Striped) {
 
-        return true;
+            SyncUtils::stripeRange(_header,
+                        row, n_rows,
+                        view._stripe_first, view._stripe_last);
 
-    }
+            acquired = SyncUtils::acquireStripes(_header,
+                        view._stripe_first, view._stripe_last,
+                        false, // nonblocking
+                        _return_code);
 
-    template <typename Scalar, int Layout>
-    void Client<Scalar, Layout>::_acquireSemBlocking(const std::string& sem_path,
-                                    sem_t*& sem,
-                                    bool verbose)
-    {
-        _return_code = _return_code + ReturnCode::RESET;
+        } else if (_safe) {
 
-        MemUtils::acquireSemBlocking(sem_path,
-                        sem,
-                        _journal,
-                        _return_code,
-                        verbose,
-                        _vlevel);
+            acquired = _acquireData(false, false);
 
-        if (isin(ReturnCode::SEMACQFAIL, _return_code)) {
+        }
 
-            MemUtils::failWithCode(_return_code,
-                                   _journal,
-                                   __FUNCTION__);
+        if (!acquired) {
+
+            if (_sync_mode == SyncMode::SeqLock ||
+                    _sync_mode == SyncMode::Ring) {
+
+                _return_code = _return_code + ReturnCode::SEQREADFAIL;
+            }
+
+            return view;
 
         }
 
+        Scalar* data = (_safe && _sync_mode == SyncMode::Ring) ?
+                            SyncUtils::slotView<Scalar, Layout>(_header,
+                                view._slot,
+                                _n_rows, _n_cols).data() :
+                            _tensor_view.data();
+
+        auto block = MMap<Scalar, Layout>(data, _n_rows, _n_cols).block(row, col,
+                                    n_rows, n_cols);
+
+        new (&view._data) ConstBlockView<Scalar, Layout>(block.data(),
+                            n_rows, n_cols,
+                            Eigen::OuterStride<>(block.outerStride()));
+
+        view._client = this;
+
+        return view;
+
     }
 
     template <typename Scalar, int Layout>
-    void Client<Scalar, Layout>::_releaseSem(const std::string& sem_path,
-                                    sem_t*& sem,
-                                    bool verbose)
+    bool Client<Scalar, Layout>::releaseView(ReadView& view)
     {
-        _return_code = _return_code + ReturnCode::RESET;
 
+        if (view._client != this) {
 
-        MemUtils::releaseSem(sem_path,
-                            sem,
-                            _journal,
-                            _return_code,
-                            verbose,
-                            _vlevel);
+            return false; // not borrowed from this client (or already released)
+        }
 
-        _return_code = _return_code + ReturnCode::RESET;
+        view._client = nullptr;
 
+        bool consistent = true;
 
-        if (isin(ReturnCode::SEMRELFAIL, _return_code)) {
+        if (_safe && _sync_mode == SyncMode::SeqLock) {
 
-            MemUtils::failWithCode(_return_code,
-                                   _journal,
-                                   __FUNCTION__);
+            consistent = SyncUtils::seqReadValidate(_header->seq,
+                            view._epoch);
+
+        } else if (_safe && _sync_mode == SyncMode::Ring) {
+
+            consistent = SyncUtils::seqReadValidate(
+                            SyncUtils::slots(_header)[view._slot].seq,
+                            view._epoch);
+
+        } else if (_safe && _sync_mode == SyncMode::Striped) {
+
+            SyncUtils::releaseStripes(_header,
+                        view._stripe_first, view._stripe_last,
+                        _return_code);
+
+        } else if (_safe) {
+
+            _releaseData();
 
         }
 
+        if (!consistent) {
+
+            _return_code = _return_code + ReturnCode::SEQREADFAIL;
+        }
+
+        return consistent;
+
     }
 
     template <typename Scalar, int Layout>
     bool Client<Scalar, Layout>::_acquireData(bool blocking,
-                                bool verbose)
+                            bool verbose)
     {
 
         if (blocking) {
 
-            _acquireSemBlocking(_mem_config.mem_path_data_sem,
-                            _data_sem,
-                            verbose); // this is blocking
+            SyncUtils::lockAcquire(_header->lock,
+                            _pid,
+                            _return_code); // this is blocking
+
+        }
+        else if (!SyncUtils::lockTry(_header->lock,
+                            _pid,
+                            _return_code)) {
 
-            return true;
+            return false;
 
         }
-        else {
 
-            return _acquireSemOneShot(_mem_config.mem_path_data_sem,
-                        _data_sem);
+        if (verbose &&
+            isin(ReturnCode::LOCKOWNERDIED, _return_code)) {
+
+            _return_code = _return_code - ReturnCode::LOCKOWNERDIED;
+
+            std::string warn = std::string("Recovered data lock at ") +
+                    _mem_config.mem_path +
+                    std::string(" from a dead owner. Data may be inconsistent.");
+
+            _journal.log(__FUNCTION__,
+                warn,
+                LogType::WARN);
 
         }
 
+        return true;
+
     }
 
     template <typename Scalar, int Layout>
     void Client<Scalar, Layout>::_releaseData()
     {
 
-        _releaseSem(_mem_config.mem_path_data_sem,
-                    _data_sem,
-                    false // no verbosity (this is called very frequently)
-                    );
+        SyncUtils::lockRelease(_header->lock);
 
     }
 
     template <typename Scalar, int Layout>
-    void Client<Scalar, Layout>::_cleanMetaMem()
+    bool Client<Scalar, Layout>::_acquireBlock(int row, int n_rows)
     {
-        // closing file descriptors and but not unlinking
-        // memory
 
-        _return_code = _return_code + ReturnCode::RESET;
+        if (_sync_mode == SyncMode::Striped) {
 
+            // only the stripes the block falls into
+            SyncUtils::stripeRange(_header,
+                        row, n_rows,
+                        _stripe_first, _stripe_last);
 
-        MemUtils::cleanUpMem(_mem_config.mem_path_nrows,
-                             _nrows_shm_fd,
-                             _journal,
-                             _return_code,
-                             _verbose,
-                             _vlevel,
-                             _unlink_data);
-
-        MemUtils::cleanUpMem(_mem_config.mem_path_ncols,
-                             _ncols_shm_fd,
-                             _journal,
-                             _return_code,
-                             _verbose,
-                             _vlevel,
-                             _unlink_data);
-
-        MemUtils::cleanUpMem(_mem_config.mem_path_clients_counter,
-                             _n_clients_shm_fd,
-                             _journal,
-                             _return_code,
-                             _verbose,
-                             _vlevel,
-                             _unlink_data);
-
-        MemUtils::cleanUpMem(_mem_config.mem_path_dtype,
-                             _dtype_shm_fd,
-                             _journal,
-                             _return_code,
-                             _verbose,
-                             _vlevel,
-                             _unlink_data);
-
-        MemUtils::cleanUpMem(_mem_config.mem_path_isrunning,
-                             _isrunning_shm_fd,
-                             _journal,
-                             _return_code,
-                             _verbose,
-                             _vlevel,
-                             _unlink_data);
-
-        MemUtils::cleanUpMem(_mem_config.mem_path_mem_layout,
-                             _mem_layout_shm_fd,
-                             _journal,
-                             _return_code,
-                             _verbose,
-                             _vlevel,
-                             _unlink_data);
+            return SyncUtils::acquireStripes(_header,
+                        _stripe_first, _stripe_last,
+                        false, // nonblocking
+                        _return_code);
 
-        _return_code = _return_code + ReturnCode::RESET;
+        }
+
+        return _acquireData(false, false);
+
+    }
+
+    template <typename Scalar, int Layout>
+    void Client<Scalar, Layout>::_releaseBlock()
+    {
+
+        if (_sync_mode == SyncMode::Striped) {
+
+            SyncUtils::releaseStripes(_header,
+                        _stripe_first, _stripe_last,
+                        _return_code);
+
+            return;
 
+        }
+
+        _releaseData();
 
     }
 
@@ -774,9 +1251,6 @@ namespace EigenIPC {
 
             _return_code = _return_code + ReturnCode::RESET;
 
-            _cleanMetaMem(); // closes, but doesn't unlink, aux. data
-
-            _closeSems(); // closing semaphores
 
             if (_verbose &&
                 _vlevel > VLevel::V1) {
@@ -809,152 +1283,43 @@ namespace EigenIPC {
             !isin(ReturnCode::MEMMAPFAIL,
                  _return_code)) {
 
-            MemUtils::initMem<Scalar, Layout>(_n_rows,
-                            _n_cols,
-                            _mem_config.mem_path,
-                            _data_shm_fd,
-                            _tensor_view,
-                            _journal,
-                            _return_code,
-                            _verbose,
-                            _vlevel);
+            // memory already mapped and initialized by the server
+            _n_rows = _header->n_rows;
+            _n_cols = _header->n_cols;
 
-            _return_code = _return_code + ReturnCode::RESET;
+            _sync_mode = static_cast<SyncMode>(_header->sync_mode);
 
-        }
-        else {
+            std::size_t data_offset = _header->data_offset;
 
-            MemUtils::failWithCode(_return_code,
-                                   _journal,
-                                   __FUNCTION__);
+            if (_header->slot_stride < sizeof(Scalar) * _n_rows * _n_cols ||
+                _mem_size < data_offset +
+                    _header->n_slots * _header->slot_stride) {
 
-        }
-
-    }
+                _return_code = _return_code + ReturnCode::MEMMAPFAIL;
 
-    template <typename Scalar, int Layout>
-    void Client<Scalar, Layout>::_initMetaMem()
-    {
-        _return_code = _return_code + ReturnCode::RESET;
- // resets return code
-
-        // auxiliary data
-        MemUtils::initMem<int>(1,
-                        1,
-                        _mem_config.mem_path_nrows,
-                        _nrows_shm_fd,
-                        _n_rows_view,
-                        _journal,
-                        _return_code,
-                        _verbose,
-                        _vlevel);
-
-        MemUtils::initMem<int>(1,
-                        1,
-                        _mem_config.mem_path_ncols,
-                        _ncols_shm_fd,
-                        _n_cols_view,
-                        _journal,
-                        _return_code,
-                        _verbose,
-                        _vlevel);
-
-        MemUtils::initMem<int>(1,
-                        1,
-                        _mem_config.mem_path_clients_counter,
-                        _n_clients_shm_fd,
-                        _n_clients_view,
-                        _journal,
-                        _return_code,
-                        _verbose,
-                        _vlevel);
-
-        MemUtils::initMem<int>(1,
-                        1,
-                        _mem_config.mem_path_dtype,
-                        _dtype_shm_fd,
-                        _dtype_view,
-                        _journal,
-                        _return_code,
-                        _verbose,
-                        _vlevel);
-
-        MemUtils::initMem<bool>(1,
-                        1,
-                        _mem_config.mem_path_isrunning,
-                        _isrunning_shm_fd,
-                        _isrunning_view,
-                        _journal,
-                        _return_code,
-                        _verbose,
-                        _vlevel);
-
-        MemUtils::initMem<int>(1,
-                        1,
-                        _mem_config.mem_path_mem_layout,
-                        _mem_layout_shm_fd,
-                        _mem_layout_view,
-                        _journal,
-                        _return_code,
-                        _verbose,
-                        _vlevel);
+                MemUtils::failWithCode(_return_code,
+                                   _journal,
+                                   __FUNCTION__,
+                                   _mem_config.mem_path);
+            }
 
-        if (!isin(ReturnCode::MEMCREATFAIL,
-                _return_code) &&
-            !isin(ReturnCode::MEMSETFAIL,
-                _return_code) &&
-            !isin(ReturnCode::MEMMAPFAIL,
-                 _return_code)) {
+            new (&_tensor_view) MMap<Scalar, Layout>(
+                            reinterpret_cast<Scalar*>(
+                                reinterpret_cast<char*>(_header) + data_offset),
+                            _n_rows,
+                            _n_cols);
 
             _return_code = _return_code + ReturnCode::RESET;
 
-
         }
         else {
 
             MemUtils::failWithCode(_return_code,
                                    _journal,
                                    __FUNCTION__);
-        }
 
-    }
-
-    template <typename Scalar, int Layout>
-    void Client<Scalar, Layout>::_initSems()
-    {
-        _return_code = _return_code + ReturnCode::RESET;
-
-        MemUtils::semInit(_mem_config.mem_path_data_sem,
-                          _data_sem,
-                          _journal,
-                          _return_code,
-                          _verbose,
-                          _vlevel);
-
-        if (isin(ReturnCode::SEMOPENFAIL, _return_code)) {
-
-            MemUtils::failWithCode(_return_code,
-                                   _journal,
-                                   __FUNCTION__,
-                                   _mem_config.mem_path_data_sem);
         }
 
-        _return_code = _return_code + ReturnCode::RESET;
-
-    }
-
-    template <typename Scalar, int Layout>
-    void Client<Scalar, Layout>::_closeSems()
-    {
-        // closes semaphores but doesn't unlink them
-        MemUtils::semClose(_mem_config.mem_path_data_sem,
-                           _data_sem,
-                           _journal,
-                           _return_code,
-                           _verbose,
-                           _vlevel,
-                           false);
-
     }
 
     template <typename Scalar, int Layout>
@@ -17,8 +17,135 @@
 
 #include <EigenIPC/CondVar.hpp>
 
+// private headers
+#include "MemUtils.hpp"
+#include "SyncUtils.hpp"
+
 namespace EigenIPC {
 
+    // NamedMutex
+
+    ConditionVariable::NamedMutex::NamedMutex(NamedMutex&& other) noexcept
+        : _word(other._word),
+        _mem(other._mem),
+        _shm_fd(other._shm_fd),
+        _pid(other._pid),
+        _return_code(other._return_code)
+    {
+        // ownership of the segment is transferred
+        other._word = nullptr;
+        other._mem = nullptr;
+        other._shm_fd = -1;
+    }
+
+    ConditionVariable::NamedMutex::~NamedMutex() {
+
+        if (_mem != nullptr) {
+
+            MemUtils::unmapMem(_mem, SyncUtils::CACHE_LINE, _shm_fd);
+        }
+
+    }
+
+    void ConditionVariable::NamedMutex::lock() {
+
+        SyncUtils::lockAcquire(*_word, _pid, _return_code);
+
+    }
+
+    bool ConditionVariable::NamedMutex::try_lock() {
+
+        return SyncUtils::lockTry(*_word, _pid, _return_code);
+
+    }
+
+    void ConditionVariable::NamedMutex::unlock() {
+
+        SyncUtils::lockRelease(*_word);
+
+    }
+
+    bool ConditionVariable::NamedMutex::isUnlinked() const {
+
+        return _shm_fd < 0 || MemUtils::isUnlinked(_shm_fd);
+
+    }
+
+    // ScopedLock
+
+    ConditionVariable::ScopedLock::ScopedLock(NamedMutex& mutex)
+        : _mutex(&mutex)
+    {
+        lock();
+    }
+
+    ConditionVariable::ScopedLock::ScopedLock(ScopedLock&& other) noexcept
+        : _mutex(other._mutex),
+        _owns(other._owns)
+    {
+        other._owns = false; // ownership is transferred
+    }
+
+    ConditionVariable::ScopedLock& ConditionVariable::ScopedLock::operator=(
+                ScopedLock&& other) noexcept {
+
+        if (this != &other) {
+
+            if (_owns) {
+
+                _mutex->unlock();
+            }
+
+            _mutex = other._mutex;
+            _owns = other._owns;
+
+            other._owns = false;
+
+        }
+
+        return *this;
+
+    }
+
+    ConditionVariable::ScopedLock::~ScopedLock() {
+
+        if (_owns) {
+
+            _mutex->unlock();
+        }
+
+    }
+
+    void ConditionVariable::ScopedLock::lock() {
+
+        if (!_owns) {
+
+            _mutex->lock();
+
+            _owns = true;
+        }
+
+    }
+
+    void ConditionVariable::ScopedLock::unlock() {
+
+        if (_owns) {
+
+            _mutex->unlock();
+
+            _owns = false;
+        }
+
+    }
+
+    bool ConditionVariable::ScopedLock::owns() const {
+
+        return _owns;
+
+    }
+
+    // ConditionVariable
+
     ConditionVariable::ConditionVariable(
                    bool is_server,
                    std::string basename,
@@ -37,48 +164,16 @@ namespace EigenIPC {
 
         if (_is_server) {
 
-            if (_force_reconnection) {
-
-                if (_verbose &&
-                    _vlevel > VLevel::V0) {
-                    std::string warn = _basename + std::string("-") + _namespace + std::string(". About to preemptively ") + 
-                        std::string(" delete mutex and cond var, since force_reconnection was set to true!");
-                    _journal.log(__FUNCTION__,
-                        warn,
-                        LogType::WARN);
-                }
-
-                if (!_cleanup_mem()) {
-                    if (_verbose) {
-                        std::string warn = _basename + std::string("-") + _namespace + std::string(". Could not ") + 
-                            std::string(" delete mutex and cond var!");
-                        _journal.log(__FUNCTION__,
-                            warn,
-                            LogType::WARN), 
-                            true;
-                    }
-                }
-            }
-
-            _cond_ptr = std::make_unique<NamedCondition>(
-                            boost::interprocess::create_only, 
-                            _mem_config.mem_path_cond_var.c_str());
-                            
-            _mutex_ptr = std::make_unique<NamedMutex>(
-                                boost::interprocess::create_only,
-                                _mem_config.mem_path_cond_var_mutex.c_str());
+            _init_state();
 
         } else {
 
-            _cond_ptr = std::make_unique<NamedCondition>(
-                        boost::interprocess::open_only, 
-                        _mem_config.mem_path_cond_var.c_str());
-                        
-            _mutex_ptr = std::make_unique<NamedMutex>(
-                                boost::interprocess::open_only,
-                                _mem_config.mem_path_cond_var_mutex.c_str());
+            _open_state();
         }
 
+        _mutex._word = &_state->mutex;
+        _mutex._pid = static_cast<uint32_t>(getpid());
+
     }
 
     ConditionVariable::~ConditionVariable(){
@@ -93,27 +188,59 @@ namespace EigenIPC {
 
     std::string ConditionVariable::mutex_path() {
 
-        return _mem_config.mem_path_cond_var_mutex;
+        return _mem_config.mem_path_cond_var;
     }
 
     ConditionVariable::NamedMutex ConditionVariable::create_named_mutex(std::string at) {
-        
-        return NamedMutex(boost::interprocess::open_or_create,
-                at.c_str());
+
+        NamedMutex mutex;
+
+        // open or create (a new segment is zero-filled -> unlocked)
+        mutex._shm_fd = shm_open(at.c_str(),
+                            O_CREAT | O_RDWR,
+                            S_IRUSR | S_IWUSR);
+
+        struct stat mem_stat;
+
+        if (mutex._shm_fd == -1 ||
+            fstat(mutex._shm_fd, &mem_stat) == -1 ||
+            (static_cast<std::size_t>(mem_stat.st_size) < SyncUtils::CACHE_LINE &&
+                ftruncate(mutex._shm_fd, SyncUtils::CACHE_LINE) == -1)) {
+
+            throw std::runtime_error("Could not open or create a named mutex at " + at);
+        }
+
+        mutex._mem = mmap(nullptr,
+                        SyncUtils::CACHE_LINE,
+                        PROT_READ | PROT_WRITE,
+                        MAP_SHARED,
+                        mutex._shm_fd,
+                        0);
+
+        if (mutex._mem == MAP_FAILED) {
+
+            mutex._mem = nullptr;
+
+            throw std::runtime_error("Could not map the named mutex at " + at);
+        }
+
+        mutex._word = static_cast<std::atomic<uint32_t>*>(mutex._mem);
+        mutex._pid = static_cast<uint32_t>(getpid());
+
+        return mutex;
+
     }
 
     ConditionVariable::ScopedLock ConditionVariable::lock(NamedMutex& mutex) {
         
         // acquires mutex
-        ScopedLock named_lock(mutex);
-
-        return named_lock;
+        return ScopedLock(mutex);
 
     }
 
     ConditionVariable::ScopedLock ConditionVariable::lock() {
 
-        return ScopedLock(*_mutex_ptr);
+        return ScopedLock(_mutex);
 
     }
 
@@ -125,27 +252,33 @@ namespace EigenIPC {
 
     void ConditionVariable::wait(ScopedLock& named_lock) {
         
-        // acquire mutex
-        _cond_ptr->wait(named_lock);
+        _wait_until(named_lock, -1);
 
     }
 
     void ConditionVariable::wait_for(ScopedLock& named_lock,
                     std::function<bool()> pred) {
-        
-        // acquire mutex
-        _cond_ptr->wait(named_lock, pred);
+
+        long long start_ns = SyncUtils::nowNs();
+
+        if (!_spin_for(named_lock, pred, -1)) {
+
+            while (!pred()) {
+
+                _wait_until(named_lock, -1);
+            }
+
+        }
+
+        SyncUtils::updateAvgWait(_avg_wait_ns, SyncUtils::nowNs() - start_ns);
 
     }
 
     bool ConditionVariable::timedwait(ScopedLock& named_lock,
                     unsigned int ms) {
         
-        _utc_timeout = boost::posix_time::microsec_clock::universal_time() + 
-                boost::posix_time::millisec(ms);
-
-        // acquire mutex
-        return _cond_ptr->timed_wait(named_lock, _utc_timeout);
+        // monotonic deadline (immune to clock adjustments)
+        return _wait_until(named_lock, SyncUtils::nowNs() + ms * 1000000LL);
 
     }
 
@@ -153,38 +286,80 @@ namespace EigenIPC {
                     unsigned int ms,
                     std::function<bool()> pred) {
         
-        _utc_timeout = boost::posix_time::microsec_clock::universal_time() + 
-                boost::posix_time::millisec(ms);
+        long long start_ns = SyncUtils::nowNs();
+
+        long long deadline_ns = start_ns + ms * 1000000LL;
+
+        bool success = _spin_for(named_lock, pred, deadline_ns);
+
+        while (!success) {
 
-        // acquire mutex
-        return _cond_ptr->timed_wait(named_lock, _utc_timeout, pred);
+            success = pred();
+
+            if (!success && !_wait_until(named_lock, deadline_ns)) {
+
+                success = pred(); // timeout
+
+                break;
+            }
+
+        }
+
+        if (success) {
+
+            SyncUtils::updateAvgWait(_avg_wait_ns, SyncUtils::nowNs() - start_ns);
+        }
+
+        return success;
 
     }
 
     void ConditionVariable::notify_one() {
 
-        _cond_ptr->notify_one();
+        SyncUtils::futexNotify(_state->seq, _state->n_waiters, 1);
 
     }
 
     void ConditionVariable::notify_all() {
 
-        _cond_ptr->notify_all();
+        SyncUtils::futexNotify(_state->seq, _state->n_waiters);
+    }
+
+    void ConditionVariable::set_wait_policy(WaitPolicy policy,
+                        int max_spin_us) {
+
+        _wait_policy = policy;
+
+        _max_spin_ns = std::max(0, max_spin_us) * 1000LL;
+
+        _avg_wait_ns = 0.0;
+
     }
 
     void ConditionVariable::close() {
 
-        if (_is_server && !_closed) {
+        if (_closed) {
+
+            return;
+        }
+
+        bool taken_over = MemUtils::isUnlinked(_shm_fd); // by another
+        // server (force_reconnection)
+
+        MemUtils::unmapMem(_state, _mem_size, _shm_fd);
+
+        _state = nullptr;
 
-            if (!_cleanup_mem()) { // clean mutex and condition var
+        if (_is_server && !taken_over) {
+
+            if (!_cleanup_mem()) {
 
                 if (_verbose) {
                     std::string exception = _basename + std::string("-") + _namespace + std::string(". Could not ") + 
                         std::string(" delete mutex and cond var!");
                     _journal.log(__FUNCTION__,
                         exception,
-                        LogType::EXCEP), 
-                        true;
+                        LogType::EXCEP);
                 }
             } 
         }
@@ -198,14 +373,210 @@ namespace EigenIPC {
         return THISNAME;
     }
 
+    void ConditionVariable::_init_state() {
+
+        _return_code = _return_code + ReturnCode::RESET;
+
+        // an already existing segment is either stale or owned by another server
+        int other_fd = -1;
+        std::size_t other_size = 0;
+
+        void* other_mem = MemUtils::openMem(_mem_config.mem_path_cond_var,
+                            other_fd,
+                            other_size,
+                            _journal,
+                            _return_code,
+                            false,
+                            _vlevel);
+
+        if (other_mem != nullptr) {
+
+            SyncUtils::CondVarState* other = static_cast<SyncUtils::CondVarState*>(other_mem);
+
+            bool alive = other_size >= sizeof(SyncUtils::CondVarState) &&
+                    SyncUtils::isCondVarReady(other) &&
+                    SyncUtils::isOwnerAlive(other->owner.load(std::memory_order_relaxed));
+
+            MemUtils::unmapMem(other_mem, other_size, other_fd);
+
+            if (alive && !_force_reconnection) {
+
+                _journal.log(__FUNCTION__,
+                    _basename + std::string("-") + _namespace +
+                    ". A condition variable already exists at " + _mem_config.mem_path_cond_var +
+                    ". Use force_reconnection to take over.",
+                    LogType::EXCEP,
+                    true); // throw exception
+
+            }
+
+            if (_verbose &&
+                _vlevel > VLevel::V0) {
+                std::string warn = _basename + std::string("-") + _namespace + std::string(". About to preemptively ") + 
+                    std::string(" delete mutex and cond var!");
+                _journal.log(__FUNCTION__,
+                    warn,
+                    LogType::WARN);
+            }
+
+            _cleanup_mem();
+
+        }
+
+        _return_code = _return_code + ReturnCode::RESET;
+
+        _mem_size = sizeof(SyncUtils::CondVarState);
+
+        void* mem = MemUtils::initRawMem(_mem_size,
+                            _mem_config.mem_path_cond_var,
+                            _shm_fd,
+                            _journal,
+                            _return_code,
+                            _verbose,
+                            _vlevel);
+
+        if (mem == nullptr) {
+
+            MemUtils::failWithCode(_return_code,
+                                _journal,
+                                __FUNCTION__,
+                                _mem_config.mem_path_cond_var);
+        }
+
+        // memory is zero-initialized by ftruncate (unlocked mutex)
+        _state = new (mem) SyncUtils::CondVarState;
+
+        _state->owner.store(static_cast<uint32_t>(getpid()), std::memory_order_relaxed);
+
+        // clients can now use it
+        _state->magic.store(SyncUtils::CONDVAR_MAGIC, std::memory_order_release);
+
+    }
+
+    void ConditionVariable::_open_state() {
+
+        _return_code = _return_code + ReturnCode::RESET;
+
+        void* mem = MemUtils::openMem(_mem_config.mem_path_cond_var,
+                            _shm_fd,
+                            _mem_size,
+                            _journal,
+                            _return_code,
+                            false,
+                            _vlevel);
+
+        if (mem == nullptr ||
+            _mem_size < sizeof(SyncUtils::CondVarState) ||
+            !SyncUtils::isCondVarReady(static_cast<SyncUtils::CondVarState*>(mem))) {
+
+            MemUtils::unmapMem(mem, _mem_size, _shm_fd);
+
+            _closed = true;
+
+            _journal.log(__FUNCTION__,
+                _basename + std::string("-") + _namespace +
+                ". No condition variable available at " + _mem_config.mem_path_cond_var,
+                LogType::EXCEP,
+                true); // throw exception
+
+        }
+
+        _state = static_cast<SyncUtils::CondVarState*>(mem);
+
+    }
+
+    bool ConditionVariable::_wait_until(ScopedLock& named_lock,
+                    long long deadline_ns) {
+
+        // read with the mutex held: a notification issued after we release it
+        // changes the word, so that the futex wait returns right away
+        uint32_t seq = _state->seq.load(std::memory_order_relaxed);
+
+        // seq_cst (with the notifier's increment and load of n_waiters)
+        _state->n_waiters.fetch_add(1, std::memory_order_seq_cst);
+
+        named_lock.unlock();
+
+        bool notified = true;
+
+        if (deadline_ns < 0) {
+
+            SyncUtils::futexWait(_state->seq, seq, nullptr);
+
+        } else {
+
+            long long remaining_ns = deadline_ns - SyncUtils::nowNs();
+
+            if (remaining_ns > 0) {
+
+                struct timespec wait_time = {
+                    static_cast<time_t>(remaining_ns / 1000000000LL),
+                    static_cast<long>(remaining_ns % 1000000000LL)};
+
+                notified = SyncUtils::futexWait(_state->seq, seq, &wait_time) == 0 ||
+                        errno != ETIMEDOUT;
+
+            } else {
+
+                notified = false;
+            }
+
+        }
+
+        _state->n_waiters.fetch_sub(1, std::memory_order_seq_cst);
+
+        named_lock.lock();
+
+        return notified;
+
+    }
+
+    bool ConditionVariable::_spin_for(ScopedLock& named_lock,
+                    std::function<bool()>& pred,
+                    long long deadline_ns) {
+
+        long long spin_ns = SyncUtils::spinBudget(_wait_policy,
+                                _max_spin_ns, _avg_wait_ns);
+
+        if (spin_ns == 0) {
+
+            return false; // sleep right away
+        }
+
+        long long start_ns = SyncUtils::nowNs();
+
+        while (!pred()) { // evaluated with the mutex held
+
+            // let the notifier in
+            named_lock.unlock();
+
+            for (int i = 0; i < SyncUtils::SPIN_CHECK_PERIOD; ++i) {
+
+                SyncUtils::cpuRelax();
+            }
+
+            named_lock.lock();
+
+            long long now_ns = SyncUtils::nowNs();
+
+            if ((deadline_ns >= 0 && now_ns >= deadline_ns) ||
+                (spin_ns > 0 && now_ns - start_ns >= spin_ns)) {
+
+                return false;
+            }
+
+        }
+
+        return true;
+
+    }
+
     bool ConditionVariable::_cleanup_mem(){
 
         if (_verbose &&
                 _vlevel > VLevel::V1) {
 
-            std::string info = std::string("Cleaning up named mutex at ") + 
-            std::string(_mem_config.mem_path_cond_var_mutex) + 
-            std::string(" and condition variable at ") + 
+            std::string info = std::string("Cleaning up mutex and condition variable at ") + 
             std::string(_mem_config.mem_path_cond_var);
 
             _journal.log(__FUNCTION__,
@@ -214,11 +585,7 @@ namespace EigenIPC {
 
         }
 
-        // Destroy named mutex and named condition variable
-        bool named_mutex_rm_ok = NamedMutex::remove(_mem_config.mem_path_cond_var_mutex.c_str());
-        bool named_cond_rm_ok = NamedCondition::remove(_mem_config.mem_path_cond_var.c_str());
-
-        return named_mutex_rm_ok && named_cond_rm_ok;
+        return shm_unlink(_mem_config.mem_path_cond_var.c_str()) == 0;
     }
 
-}
\ No newline at end of file
+}
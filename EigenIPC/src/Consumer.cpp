@@ -17,6 +17,11 @@
 
 #include <EigenIPC/Consumer.hpp>
 
+// private headers
+#include <MemUtils.hpp>
+#include <SyncUtils.hpp>
+#include <NotifyUtils.hpp>
+
 namespace EigenIPC {
 
     Consumer::Consumer(
@@ -27,18 +32,7 @@ namespace EigenIPC {
         : _verbose(verbose),
         _vlevel(vlevel),
         _journal(Journal(_getThisName())),
-        _trigger_counter_clnt(basename + TRIGGER_BASENAME, 
-            name_space,
-            verbose,
-            vlevel,
-            false),
-        _trigger_counter(1, 1),
-        _ack_counter_clnt(basename + ACK_BASENAME, 
-            name_space,
-            verbose,
-            vlevel,
-            false),
-        _ack_counter(1, 1),
+        _mem_config(basename + BARRIER_BASENAME, name_space),
         _closed(true),
         _basename(basename),
         _namespace(name_space),
@@ -55,18 +49,50 @@ namespace EigenIPC {
     void Consumer::run() {
 
         if (!_is_running) {
-            
-            _trigger_counter_clnt.attach();
-            _ack_counter_clnt.attach();
-            
-            _open_cond_vars(); // we open the condition variables
-            // only after client attachment has succeded (this guarantees mutexes
-            // and cond. vars where created by the producer)
+
+            int msg_counter = 0;
+
+            while (!_open_barrier()) {
+
+                if (_verbose &&
+                    _vlevel > VLevel::V0 &&
+                    msg_counter % 4000 == 0) {
+
+                    // only log every now and then
+                    _journal.log(__FUNCTION__+_unique_id,
+                        "Waiting for the producer to be running...",
+                        LogType::WARN);
+
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(1)); // no busy wait
+
+                msg_counter++;
+
+            }
+
+            uint32_t pid = static_cast<uint32_t>(getpid());
+
+            _slot = SyncUtils::barrierClaimSlot(_barrier, pid,
+                                SyncUtils::procStartTime(pid));
+
+            if (_slot < 0) {
+
+                _close_barrier();
+
+                _journal.log(__FUNCTION__+_unique_id,
+                    "No consumer slot left (at most " +
+                    std::to_string(SyncUtils::BARRIER_MAX_CONSUMERS) + " consumers per producer)",
+                    LogType::EXCEP,
+                    true); // throw exception
+
+            }
 
             _is_running = true;
             _closed = false;
 
-            _internal_trigger_counter = 0;
+            // only triggers from now on
+            _internal_trigger_counter = _barrier->epoch.load(std::memory_order_acquire);
 
             if (_verbose &&
                 _vlevel > VLevel::V1) {
@@ -83,9 +109,11 @@ namespace EigenIPC {
 
         if (!_closed) {
             
-            _trigger_counter_clnt.close();
-            _ack_counter_clnt.close();
+            _close_barrier();
 
+            NotifyUtils::notifyDisconnect(_notify_fd, _notify_conn_fd);
+
+            _is_running = false;
             _closed = true;
         }
     }
@@ -94,24 +122,44 @@ namespace EigenIPC {
 
         _check_running(std::string(__FUNCTION__));
 
-        ScopedLock trigger_lock = _trigger_cond_ptr->lock();
+        uint32_t epoch = 0;
+
+        long long start_ns = SyncUtils::nowNs();
 
-        _trigger_received = false;
+        bool trigger_received = SyncUtils::futexWaitUntil(_barrier->epoch,
+                            _barrier->epoch_waiters,
+                            epoch,
+                            [&](uint32_t value) {
+                                return value != _internal_trigger_counter;
+                            },
+                            [&]() { return SyncUtils::isBarrierAlive(_barrier); },
+                            ms_timeout > 0 ? ms_timeout : -1, // otherwise blocking
+                            SyncUtils::spinBudget(_wait_policy, _max_spin_ns, _avg_wait_ns));
 
-        while (!_trigger_received) {
+        if (!trigger_received) {
 
-            _trigger_received = _check_trigger_received();
+            return false;
+        }
 
-            if (!_trigger_received) {
-                
-                // wait (unlock and lock mutex atomically when
-                // returning)
-                if(!_wait(trigger_lock, ms_timeout)) {
+        // the spin budget follows the observed trigger period
+        SyncUtils::updateAvgWait(_avg_wait_ns, SyncUtils::nowNs() - start_ns);
 
-                    return false;
-                }
+        uint32_t trigger_counter_increment = epoch - _internal_trigger_counter;
+
+        _internal_trigger_counter = epoch;
+
+        if (trigger_counter_increment > 1) {
+
+            std::string excep = std::string("Found trigger increment > 1 (missed triggers). Got ") +
+                std::to_string(trigger_counter_increment);
+
+            _journal.log(__FUNCTION__+_unique_id,
+                excep,
+                LogType::EXCEP, 
+                false); // do not throw exception
+
+            return false;
 
-            }
         }
 
         return true;
@@ -148,109 +196,157 @@ namespace EigenIPC {
 
         _check_running(std::string(__FUNCTION__));
 
-        ScopedLock ack_lock = _ack_cond_ptr->lock();
+        if (_barrier->running.load(std::memory_order_acquire) == 0) {
 
-        return _acknowledge();
+            _journal.log(__FUNCTION__+_unique_id,
+                "Producer is not running anymore!",
+                LogType::EXCEP, 
+                false); // do not throw exception
 
-    }
+            return false;
 
-    bool Consumer::_acknowledge() {
-        
-        _fail_count = 0;
+        }
 
-        if (!_ack_counter_clnt.read(_ack_counter, 0, 0)) {
+        if (_barrier->epoch.load(std::memory_order_acquire) != _internal_trigger_counter) {
 
+            // our ack would be counted for the newer trigger
             _journal.log(__FUNCTION__+_unique_id,
-                "Could not read acknowledge counter!",
-                LogType::EXCEP, 
-                false); // throw exception
+                "Late ack (the producer already triggered again)!",
+                LogType::EXCEP,
+                false); // do not throw exception
 
-            _fail_count += 1;
+            return false;
 
         }
 
-        _ack_counter.array() += 1; // increment shared ack counter and write to memory
-        
-        if (!_ack_counter_clnt.write(_ack_counter, 0, 0)) {
+        _barrier->slots[_slot].ack_ns.store(SyncUtils::nowNs(), std::memory_order_relaxed);
+        _barrier->slots[_slot].ack_epoch.store(_internal_trigger_counter, std::memory_order_release);
+
+        uint64_t bit = uint64_t(1) << _slot;
+
+        bool first_ack = (_barrier->ack_mask.fetch_or(bit, std::memory_order_seq_cst) & bit) == 0;
+
+        if (_barrier->epoch.load(std::memory_order_seq_cst) != _internal_trigger_counter) {
+
+            // the producer triggered again between the check above and our
+            // fetch_or: the bit may have landed in the new round. It is not
+            // counted there (stale ack_epoch), we withdraw it so that our
+            // next ack sets it (and wakes up the producer) again
+            if (first_ack) {
+
+                _barrier->ack_mask.fetch_and(~bit, std::memory_order_seq_cst);
+            }
 
             _journal.log(__FUNCTION__+_unique_id,
-                "Could not write acknowledge counter!",
-                LogType::EXCEP, 
-                false); // throw exception
+                "Late ack (the producer already triggered again)!",
+                LogType::EXCEP,
+                false); // do not throw exception
+
+            return false;
 
-            _fail_count += 1;
-            
         }
 
-        _ack_cond_ptr->notify_one();
+        if (first_ack) {
+
+            // wakes up the producer only if it's sleeping (a repeated
+            // ack does not change anything)
+            SyncUtils::futexNotify(_barrier->acks, _barrier->ack_waiters, 1);
+        }
+
+        return true;
 
-        return _fail_count == 0;
-        
     }
 
-    void Consumer::_open_cond_vars() {
-        
-        bool is_server = false; // this is a consumer
-        _trigger_cond_ptr = std::make_unique<ConditionVariable>(is_server,
-                _basename + TRIGGER_COND_NAME,
-                _namespace,
-                _verbose,
-                _vlevel);
-        _ack_cond_ptr = std::make_unique<ConditionVariable>(is_server,
-                _basename + ACK_COND_NAME,
-                _namespace,
-                _verbose,
-                _vlevel);
+    int Consumer::slot() {
+
+        return _slot;
 
     }
 
-    bool Consumer::_check_trigger_received() {
+    void Consumer::set_wait_policy(WaitPolicy policy,
+                        int max_spin_us) {
 
-        _trigger_counter_clnt.read(_trigger_counter, 0, 0); // reads current value
-        // of trigger counter (only written by Producer)
+        _wait_policy = policy;
 
-        _trigger_counter_increment = _trigger_counter(0, 0) - _internal_trigger_counter;
+        _max_spin_ns = std::max(0, max_spin_us) * 1000LL;
 
-        if (_trigger_counter_increment > 1 || 
-            _trigger_counter_increment < 0) {
-            
-            std::string excep = std::string("Found trigger increment < 0 or > 1. Got ") + 
-                std::to_string(_trigger_counter_increment);
-            _journal.log(__FUNCTION__+_unique_id,
-                excep,
-                LogType::EXCEP, 
-                false); // do throw exception
-            return false;
+        _avg_wait_ns = 0.0;
+
+    }
+
+    int Consumer::get_notify_fd() {
+
+        _check_running(std::string(__FUNCTION__));
+
+        if (_notify_fd == -1) {
+
+            // our own eventfd, handed over to the producer (once)
+            _notify_fd = NotifyUtils::notifyConnect(_mem_config.mem_path,
+                                _notify_conn_fd);
 
         }
 
-        if (_trigger_counter_increment == 1) {
-            
-            _internal_trigger_counter = _trigger_counter(0, 0);
+        return _notify_fd;
 
-            return true;
+    }
+
+    uint64_t Consumer::clear_notify() {
+
+        return NotifyUtils::notifyClear(_notify_fd);
+
+    }
+
+    bool Consumer::_open_barrier() {
+
+        _return_code = _return_code + ReturnCode::RESET;
+
+        void* mem = MemUtils::openMem(_mem_config.mem_path,
+                            _shm_fd,
+                            _mem_size,
+                            _journal,
+                            _return_code,
+                            false,
+                            _vlevel);
+
+        if (mem == nullptr) {
+
+            return false; // not created yet
+        }
+
+        SyncUtils::Barrier* barrier = static_cast<SyncUtils::Barrier*>(mem);
+
+        if (_mem_size < sizeof(SyncUtils::Barrier) ||
+            !SyncUtils::isBarrierReady(barrier) ||
+            !SyncUtils::isBarrierAlive(barrier)) {
+
+            // being initialized or stale
+            MemUtils::unmapMem(mem, _mem_size, _shm_fd);
 
-        } else {
-            
             return false;
+
         }
 
+        _barrier = barrier;
+
+        return true;
+
     }
-    
-    bool Consumer::_wait(ScopedLock& lock, 
-                int ms_timeout) {
 
-        if (ms_timeout > 0) {
+    void Consumer::_close_barrier() {
 
-            _timeout = !(_trigger_cond_ptr->timedwait(lock, ms_timeout)); // wait with timeout
-            
-            return !_timeout;
+        if (_barrier != nullptr) {
 
-        } else {
+            if (_slot >= 0) {
+
+                SyncUtils::barrierReleaseSlot(_barrier, _slot);
+
+                _slot = -1;
+            }
+
+            MemUtils::unmapMem(_barrier, _mem_size, _shm_fd); // (the producer unlinks it)
 
-            _trigger_cond_ptr->wait(lock); // blocking
+            _barrier = nullptr;
 
-            return true;
         }
 
     }
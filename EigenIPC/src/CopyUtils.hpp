@@ -0,0 +1,236 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+//
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+//
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef COPYUTILS_HPP
+#define COPYUTILS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define EIGENIPC_X86 1
+#endif
+
+namespace EigenIPC{
+
+    namespace CopyUtils{
+
+        // copy kernels for tensor blocks which are contiguous in memory (e.g. full rows of
+        // a row-major tensor). Large copies into shared memory use non-temporal (streaming)
+        // stores, so that the writer's caches are not filled with data it will not read again
+
+        constexpr std::size_t STREAM_THRESHOLD = 1 << 20; // [bytes] default minimum size
+        // for streaming stores (roughly where a copy stops fitting in the private caches)
+
+        constexpr std::size_t STREAM_ALIGNMENT = 64; // streaming stores need aligned targets
+
+        enum class Kernel {
+
+            MemCpy, // no streaming stores available
+            SSE2,
+            AVX2,
+            AVX512
+
+        };
+
+        inline std::atomic<std::size_t>& streamThreshold() {
+
+            // can be changed at runtime (e.g. SIZE_MAX disables streaming stores)
+            static std::atomic<std::size_t> threshold(STREAM_THRESHOLD);
+
+            return threshold;
+
+        }
+
+        inline Kernel detectKernel() {
+
+            #ifdef EIGENIPC_X86
+
+                __builtin_cpu_init();
+
+                if (__builtin_cpu_supports("avx512f")) {
+
+                    return Kernel::AVX512;
+                }
+
+                if (__builtin_cpu_supports("avx2")) {
+
+                    return Kernel::AVX2;
+                }
+
+                if (__builtin_cpu_supports("sse2")) {
+
+                    return Kernel::SSE2;
+                }
+
+            #endif
+
+            return Kernel::MemCpy;
+
+        }
+
+        inline Kernel streamKernel() {
+
+            static const Kernel kernel = detectKernel(); // once per process
+
+            return kernel;
+
+        }
+
+        #ifdef EIGENIPC_X86
+
+            // n_bytes is a multiple of STREAM_ALIGNMENT and dst is aligned to it
+
+            __attribute__((target("avx512f")))
+            inline void streamAVX512(char* dst, const char* src, std::size_t n_bytes) {
+
+                for (std::size_t i = 0; i < n_bytes; i += 64) {
+
+                    _mm512_stream_si512(reinterpret_cast<__m512i*>(dst + i),
+                        _mm512_loadu_si512(reinterpret_cast<const void*>(src + i)));
+                }
+
+            }
+
+            __attribute__((target("avx2")))
+            inline void streamAVX2(char* dst, const char* src, std::size_t n_bytes) {
+
+                for (std::size_t i = 0; i < n_bytes; i += 64) {
+
+                    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+
+                    _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i), a);
+                    _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i + 32), b);
+                }
+
+            }
+
+            __attribute__((target("sse2")))
+            inline void streamSSE2(char* dst, const char* src, std::size_t n_bytes) {
+
+                for (std::size_t i = 0; i < n_bytes; i += 16) {
+
+                    _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i),
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+                }
+
+            }
+
+        #endif
+
+        inline void streamCopy(void* dst, const void* src, std::size_t n_bytes) {
+
+            Kernel kernel = streamKernel();
+
+            if (kernel == Kernel::MemCpy) {
+
+                std::memcpy(dst, src, n_bytes);
+
+                return;
+            }
+
+            #ifdef EIGENIPC_X86
+
+                char* d = static_cast<char*>(dst);
+                const char* s = static_cast<const char*>(src);
+
+                // regular copy up to the first aligned address
+                std::size_t head = (STREAM_ALIGNMENT -
+                        reinterpret_cast<std::uintptr_t>(d) % STREAM_ALIGNMENT) % STREAM_ALIGNMENT;
+
+                head = head < n_bytes ? head : n_bytes;
+
+                std::memcpy(d, s, head);
+
+                std::size_t body = (n_bytes - head) / STREAM_ALIGNMENT * STREAM_ALIGNMENT;
+
+                // streaming stores are not ordered with earlier regular stores either:
+                // whatever marked the write as in progress (odd seqlock counter, cleared
+                // ring stamp) has to be visible before any of the new data
+                _mm_sfence();
+
+                switch (kernel) {
+
+                    case Kernel::AVX512:
+                        streamAVX512(d + head, s + head, body);
+                        break;
+
+                    case Kernel::AVX2:
+                        streamAVX2(d + head, s + head, body);
+                        break;
+
+                    default:
+                        streamSSE2(d + head, s + head, body);
+                        break;
+
+                }
+
+                std::memcpy(d + head + body, s + head + body, n_bytes - head - body);
+
+                // streaming stores are weakly ordered: they have to be visible before
+                // the data is published (seqlock/ring counters, lock release)
+                _mm_sfence();
+
+            #endif
+
+        }
+
+        template <typename T>
+        inline bool isContiguous(const T& t) {
+
+            // no gaps between consecutive rows (row-major) or columns (col-major)
+            return t.innerStride() == 1 &&
+                    (t.outerStride() == t.innerSize() || t.outerSize() <= 1);
+
+        }
+
+        template <typename Dst, typename Src>
+        inline void copy(Dst&& dst, const Src& src,
+                        bool streaming = false) {
+
+            // dst and src have the same size and storage order
+            if (isContiguous(dst) && isContiguous(src)) {
+
+                std::size_t n_bytes = src.size() * sizeof(*src.data());
+
+                if (streaming &&
+                    n_bytes >= streamThreshold().load(std::memory_order_relaxed)) {
+
+                    streamCopy(dst.data(), src.data(), n_bytes);
+
+                } else {
+
+                    std::memcpy(dst.data(), src.data(), n_bytes);
+                }
+
+                return;
+
+            }
+
+            dst = src; // generic (strided) Eigen assignment
+
+        }
+
+    }
+
+}
+
+#endif // COPYUTILS_HPP
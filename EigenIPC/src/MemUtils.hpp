@@ -22,6 +22,7 @@
 #include <string>
 #include <stdexcept>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <semaphore.h>
@@ -29,12 +30,18 @@
 #include <cerrno>
 #include <cstring>
 #include <memory>
+#include <thread>
+#include <chrono>
+#include <poll.h>
+#include <sys/inotify.h>
 
 #include <EigenIPC/DTypes.hpp>
 #include <EigenIPC/Journal.hpp>
 #include <EigenIPC/ReturnCodes.hpp>
 #include <EigenIPC/Helpers.hpp>
 
+#include <CopyUtils.hpp>
+
 namespace EigenIPC{
 
     namespace MemUtils{
@@ -72,6 +79,32 @@ namespace EigenIPC{
             }
         }
 
+        inline std::string getDTypeName(int dtype) { // of a DType stored as int
+
+            switch(static_cast<DType>(dtype)) {
+
+                case DType::Float:
+
+                    return "float";
+
+                case DType::Double:
+
+                    return "double";
+
+                case DType::Int:
+
+                    return "int";
+
+                case DType::Bool:
+
+                    return "bool";
+
+                default:
+
+                    return "Unknown data type";
+            }
+        }
+
         inline void failWithCode(ReturnCode fail_code,
                             Journal journal,
                             std::string calling_fun,
@@ -94,23 +127,16 @@ namespace EigenIPC{
 
         // shared mem data utilities
 
-        template <typename Scalar,
-                  int Layout = MemLayoutDefault>
-        void initMem(
-            std::size_t n_rows,
-            std::size_t n_cols,
+        inline void* initRawMem(
+            std::size_t data_size,
             const std::string& mem_path,
             int& shm_fd,
-            MMap<Scalar, Layout>& tensor_view,
             Journal& journal,
             ReturnCode& return_code,
             bool verbose = true,
             VLevel vlevel = Journal::VLevel::V0
             ){
 
-            // Determine the size based on the Scalar type
-            std::size_t data_size = sizeof(Scalar) * n_rows * n_cols;
-
             // Create shared memory
             shm_fd = shm_open(mem_path.c_str(),
                               O_CREAT | O_RDWR,
@@ -130,7 +156,7 @@ namespace EigenIPC{
 
                 return_code = return_code + ReturnCode::MEMCREATFAIL;
 
-                return;
+                return nullptr;
 
             }
 
@@ -149,7 +175,7 @@ namespace EigenIPC{
 
                 return_code = return_code + ReturnCode::MEMSETFAIL;
 
-                return;
+                return nullptr;
 
             }
 
@@ -168,14 +194,14 @@ namespace EigenIPC{
             }
 
             // Map the shared memory
-            Scalar* matrix_data = static_cast<Scalar*>(mmap(nullptr,
-                                                        data_size,
-                                                        PROT_READ | PROT_WRITE,
-                                                        MAP_SHARED,
-                                                        shm_fd,
-                                                        0));
+            void* data = mmap(nullptr,
+                            data_size,
+                            PROT_READ | PROT_WRITE,
+                            MAP_SHARED,
+                            shm_fd,
+                            0);
 
-            if (matrix_data == MAP_FAILED) {
+            if (data == MAP_FAILED) {
 
                 if (verbose) {
                     std::string map_error = "Could not map memory size for " +
@@ -187,15 +213,10 @@ namespace EigenIPC{
 
                 return_code = return_code + ReturnCode::MEMMAPFAIL;
 
-                return;
+                return nullptr;
 
             }
 
-            new (&tensor_view) MMap<Scalar, Layout>(matrix_data,
-                                           n_rows,
-                                           n_cols); // contiguous memory
-            // (no need to specify strides)
-
             return_code = return_code + ReturnCode::MEMMAP;
 
             if (verbose && vlevel > VLevel::V2) {
@@ -209,6 +230,260 @@ namespace EigenIPC{
 
             }
 
+            return data;
+
+        }
+
+        inline void* openMem(
+            const std::string& mem_path,
+            int& shm_fd,
+            std::size_t& mem_size,
+            Journal& journal,
+            ReturnCode& return_code,
+            bool verbose = true,
+            VLevel vlevel = Journal::VLevel::V0
+            ){
+
+            // maps the whole of an already existing (and sized) shared memory,
+            // without creating or resizing it
+
+            shm_fd = shm_open(mem_path.c_str(),
+                              O_RDWR,
+                              0);
+
+            struct stat mem_stat;
+
+            if (shm_fd == -1 ||
+                fstat(shm_fd, &mem_stat) == -1) {
+
+                if (verbose) {
+
+                    std::string error = "Could not open shared memory at " +
+                            mem_path;
+
+                    journal.log(__FUNCTION__,
+                        error,
+                        LogType::EXCEP);
+                }
+
+                return_code = return_code + ReturnCode::MEMOPENFAIL;
+
+                if (shm_fd != -1) {
+
+                    ::close(shm_fd);
+
+                    shm_fd = -1;
+                }
+
+                return nullptr;
+
+            }
+
+            mem_size = static_cast<std::size_t>(mem_stat.st_size);
+
+            return_code = return_code + ReturnCode::MEMOPEN;
+
+            void* data = mmap(nullptr,
+                            mem_size,
+                            PROT_READ | PROT_WRITE,
+                            MAP_SHARED,
+                            shm_fd,
+                            0);
+
+            if (mem_size == 0 || data == MAP_FAILED) {
+
+                if (verbose) {
+                    std::string map_error = "Could not map memory size for " +
+                            mem_path;
+                    journal.log(__FUNCTION__,
+                                map_error,
+                                LogType::EXCEP);
+                }
+
+                return_code = return_code + ReturnCode::MEMMAPFAIL;
+
+                ::close(shm_fd);
+
+                shm_fd = -1;
+
+                return nullptr;
+
+            }
+
+            return_code = return_code + ReturnCode::MEMMAP;
+
+            if (verbose && vlevel > VLevel::V2) {
+
+                std::string info = "Mapped existing shared memory at " +
+                        mem_path;
+
+                journal.log(__FUNCTION__,
+                            info,
+                            LogType::INFO);
+
+            }
+
+            return data;
+
+        }
+
+        inline void unmapMem(void* mem,
+                        std::size_t mem_size,
+                        int& shm_fd) {
+
+            // undoes openMem (no unlinking)
+            if (mem != nullptr && mem_size > 0) {
+
+                munmap(mem, mem_size);
+            }
+
+            if (shm_fd >= 0) {
+
+                ::close(shm_fd);
+
+                shm_fd = -1;
+            }
+
+        }
+
+        inline bool isUnlinked(int shm_fd) {
+
+            // true if the memory behind shm_fd was unlinked (e.g. by its server)
+            struct stat mem_stat;
+
+            return fstat(shm_fd, &mem_stat) == -1 || mem_stat.st_nlink == 0;
+
+        }
+
+        inline void touchMem(int shm_fd) {
+
+            // updates the segment's timestamps: wakes up whoever is
+            // watching the shared memory directory (see ShmWatch)
+            if (shm_fd >= 0) {
+
+                futimens(shm_fd, nullptr);
+            }
+
+        }
+
+        // waits for changes to the shared memory directory (/dev/shm): segments being
+        // created (IN_CREATE), sized (IN_MODIFY) or touched by their owner, e.g. once
+        // ready (IN_ATTRIB, see touchMem()). Used instead of polling for memory which
+        // does not exist yet. Falls back to sleeping if inotify is not available
+        class ShmWatch {
+
+            public:
+
+                ShmWatch() {
+
+                    _fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+                    if (_fd != -1 &&
+                        inotify_add_watch(_fd, "/dev/shm",
+                            IN_CREATE | IN_MODIFY | IN_ATTRIB | IN_MOVED_TO) == -1) {
+
+                        ::close(_fd);
+
+                        _fd = -1;
+                    }
+
+                }
+
+                ~ShmWatch() {
+
+                    if (_fd != -1) {
+
+                        ::close(_fd);
+                    }
+
+                }
+
+                ShmWatch(const ShmWatch&) = delete;
+                ShmWatch& operator=(const ShmWatch&) = delete;
+
+                bool isEventDriven() const { return _fd != -1; }
+
+                void wait(int ms_timeout) {
+
+                    // returns on any change (events are not filtered by name: checking
+                    // again is cheap) or after ms_timeout. Events since the last call
+                    // are not lost (but may cause a spurious return)
+                    if (_fd == -1) {
+
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1)); // polling
+
+                        return;
+                    }
+
+                    pollfd pfd = {_fd, POLLIN, 0};
+
+                    if (poll(&pfd, 1, ms_timeout) > 0) {
+
+                        alignas(inotify_event) char buffer[4096];
+
+                        while (read(_fd, buffer, sizeof(buffer)) > 0) {} // drained
+
+                    }
+
+                }
+
+            private:
+
+                int _fd = -1;
+
+        };
+
+        inline ShmWatch& shmWatch() {
+
+            // created on first use and reused by all the waits of the calling thread:
+            // closing an inotify instance takes milliseconds (the kernel waits for an
+            // RCU grace period), which would add up over many attaches
+            static thread_local ShmWatch watch;
+
+            return watch;
+
+        }
+
+        template <typename Scalar,
+                  int Layout = MemLayoutDefault>
+        void initMem(
+            std::size_t n_rows,
+            std::size_t n_cols,
+            const std::string& mem_path,
+            int& shm_fd,
+            MMap<Scalar, Layout>& tensor_view,
+            Journal& journal,
+            ReturnCode& return_code,
+            bool verbose = true,
+            VLevel vlevel = Journal::VLevel::V0,
+            std::size_t header_size = 0, // bytes reserved before the tensor data
+            std::size_t tail_size = 0 // bytes reserved after the tensor data
+            ){
+
+            // Determine the size based on the Scalar type
+            std::size_t data_size = sizeof(Scalar) * n_rows * n_cols;
+
+            void* mem = initRawMem(header_size + data_size + tail_size,
+                                mem_path,
+                                shm_fd,
+                                journal,
+                                return_code,
+                                verbose,
+                                vlevel);
+
+            if (mem == nullptr) {
+
+                return;
+            }
+
+            Scalar* matrix_data = reinterpret_cast<Scalar*>(
+                                    static_cast<char*>(mem) + header_size);
+
+            new (&tensor_view) MMap<Scalar, Layout>(matrix_data,
+                                           n_rows,
+                                           n_cols); // contiguous memory
+            // (no need to specify strides)
+
         }
 
         inline void cleanUpMem(
@@ -353,9 +628,11 @@ namespace EigenIPC{
 
             if (success) {
 
-                tensor_view.block(row, col,
+                // streaming stores for large contiguous blocks (see CopyUtils)
+                CopyUtils::copy(tensor_view.block(row, col,
                               data.rows(),
-                              data.cols()) = data;
+                              data.cols()), data,
+                              true);
             }
 
             if (!success) {
@@ -389,9 +666,11 @@ namespace EigenIPC{
 
             if (success) {
 
-                tensor_view.block(row, col,
+                // streaming stores for large contiguous blocks (see CopyUtils)
+                CopyUtils::copy(tensor_view.block(row, col,
                               data.rows(),
-                              data.cols()) = data;
+                              data.cols()), data,
+                              true);
             }
 
             if (!success) {
@@ -425,9 +704,10 @@ namespace EigenIPC{
 
             if (success) {
 
-                output = tensor_view.block(row, col,
+                CopyUtils::copy(output, tensor_view.block(row, col,
                                            output.rows(),
-                                           output.cols());
+                                           output.cols())); // the reader
+                // will likely use the data -> regular stores
             }
 
             if (!success) {
@@ -463,9 +743,10 @@ namespace EigenIPC{
 
             if (success) {
 
-                output  = tensor_view.block(row, col,
+                CopyUtils::copy(output, tensor_view.block(row, col,
                                            output.rows(),
-                                           output.cols());
+                                           output.cols())); // the reader
+                // will likely use the data -> regular stores
             }
 
             if (!success) {
@@ -0,0 +1,371 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+//
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+//
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef NOTIFYUTILS_HPP
+#define NOTIFYUTILS_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+
+namespace EigenIPC{
+
+    namespace NotifyUtils{
+
+        // pollable notifications (e.g. for epoll/asyncio event loops). Each reader
+        // creates its own eventfd and hands it over to the writer through a Unix socket
+        // (SCM_RIGHTS), bound to an abstract address derived from the writer's shared
+        // memory path. The writer then bumps all the registered eventfds on each
+        // update. Readers drop out just by closing their end of the connection
+
+        inline std::string socketName(const std::string& mem_path) {
+
+            // abstract addresses are limited to sizeof(sun_path) - 1 bytes: hash
+            // the path (FNV-1a, stable across processes and builds)
+            uint64_t hash = 14695981039346656037ULL;
+
+            for (char c : mem_path) {
+
+                hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+            }
+
+            char name[40];
+
+            snprintf(name, sizeof(name), "EigenIPC-notify-%016llx",
+                static_cast<unsigned long long>(hash));
+
+            return std::string(name);
+
+        }
+
+        inline socklen_t socketAddress(const std::string& name,
+                                sockaddr_un& addr) {
+
+            std::memset(&addr, 0, sizeof(addr));
+
+            addr.sun_family = AF_UNIX;
+
+            // leading '\0' -> abstract namespace (nothing to unlink, released when closed)
+            std::memcpy(addr.sun_path + 1, name.data(), name.size());
+
+            return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + 1 + name.size());
+
+        }
+
+        struct Notifier { // writer side
+
+            int listen_fd = -1;
+
+            std::vector<pollfd> conns; // one per reader
+
+            std::vector<int> event_fds; // the readers' eventfds (-1 until received)
+
+            ~Notifier(); // closes everything
+
+        };
+
+        inline bool notifierOpen(Notifier& notifier,
+                        const std::string& mem_path) {
+
+            sockaddr_un addr;
+            socklen_t addr_len = socketAddress(socketName(mem_path), addr);
+
+            notifier.listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+            if (notifier.listen_fd == -1 ||
+                bind(notifier.listen_fd, reinterpret_cast<sockaddr*>(&addr), addr_len) == -1 ||
+                listen(notifier.listen_fd, SOMAXCONN) == -1) {
+
+                if (notifier.listen_fd != -1) {
+
+                    ::close(notifier.listen_fd);
+                }
+
+                notifier.listen_fd = -1; // e.g. address already used by another writer
+
+                return false;
+            }
+
+            return true;
+
+        }
+
+        inline void notifierDrop(Notifier& notifier,
+                        std::size_t i) {
+
+            ::close(notifier.conns[i].fd);
+
+            if (notifier.event_fds[i] != -1) {
+
+                ::close(notifier.event_fds[i]);
+            }
+
+            notifier.conns[i] = notifier.conns.back();
+            notifier.event_fds[i] = notifier.event_fds.back();
+
+            notifier.conns.pop_back();
+            notifier.event_fds.pop_back();
+
+        }
+
+        inline int receiveFd(int conn_fd) {
+
+            char byte = 0;
+
+            iovec iov = {&byte, 1};
+
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+
+            msghdr msg;
+            std::memset(&msg, 0, sizeof(msg));
+
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+
+            if (recvmsg(conn_fd, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC) != 1) {
+
+                return -1;
+            }
+
+            cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+
+            if (cmsg == nullptr ||
+                cmsg->cmsg_level != SOL_SOCKET ||
+                cmsg->cmsg_type != SCM_RIGHTS) {
+
+                return -1;
+            }
+
+            int fd = -1;
+
+            std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+
+            return fd;
+
+        }
+
+        inline void notifierUpdate(Notifier& notifier) {
+
+            // new readers (their connections are queued on the listening socket)
+            int conn_fd = -1;
+
+            while ((conn_fd = accept4(notifier.listen_fd, nullptr, nullptr,
+                                SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+
+                notifier.conns.push_back({conn_fd, POLLIN, 0});
+                notifier.event_fds.push_back(-1);
+            }
+
+            if (notifier.conns.empty()) {
+
+                return;
+            }
+
+            // a single syscall for all the readers: pending eventfds and hang ups
+            if (poll(notifier.conns.data(), notifier.conns.size(), 0) <= 0) {
+
+                return;
+            }
+
+            for (std::size_t i = notifier.conns.size(); i-- > 0;) {
+
+                short revents = notifier.conns[i].revents;
+
+                if (revents == 0) {
+
+                    continue;
+                }
+
+                if (notifier.event_fds[i] == -1 && (revents & POLLIN)) {
+
+                    notifier.event_fds[i] = receiveFd(notifier.conns[i].fd);
+
+                    if (notifier.event_fds[i] != -1) {
+
+                        continue;
+                    }
+
+                }
+
+                notifierDrop(notifier, i); // reader gone (or misbehaving)
+
+            }
+
+        }
+
+        inline void notifierSignal(Notifier& notifier) {
+
+            if (notifier.listen_fd == -1) {
+
+                return; // not enabled
+            }
+
+            notifierUpdate(notifier);
+
+            uint64_t one = 1;
+
+            for (int event_fd : notifier.event_fds) {
+
+                if (event_fd != -1) {
+
+                    // nonblocking: on (unlikely) overflow the reader is already
+                    // signaled anyway
+                    ssize_t written = write(event_fd, &one, sizeof(one));
+                    (void) written;
+                }
+
+            }
+
+        }
+
+        inline void notifierClose(Notifier& notifier) {
+
+            while (!notifier.conns.empty()) {
+
+                notifierDrop(notifier, notifier.conns.size() - 1);
+            }
+
+            if (notifier.listen_fd != -1) {
+
+                ::close(notifier.listen_fd);
+
+                notifier.listen_fd = -1;
+            }
+
+        }
+
+        inline Notifier::~Notifier() {
+
+            notifierClose(*this);
+
+        }
+
+        // reader side
+
+        inline int notifyConnect(const std::string& mem_path,
+                        int& conn_fd) {
+
+            // returns the reader's eventfd (-1 if the writer does not expose one).
+            // conn_fd has to be kept open for as long as notifications are wanted
+            sockaddr_un addr;
+            socklen_t addr_len = socketAddress(socketName(mem_path), addr);
+
+            conn_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+            if (conn_fd == -1) {
+
+                return -1;
+            }
+
+            int event_fd = -1;
+
+            if (connect(conn_fd, reinterpret_cast<sockaddr*>(&addr), addr_len) == 0) {
+
+                event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            }
+
+            if (event_fd != -1) {
+
+                char byte = 0;
+
+                iovec iov = {&byte, 1};
+
+                alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+                std::memset(control, 0, sizeof(control));
+
+                msghdr msg;
+                std::memset(&msg, 0, sizeof(msg));
+
+                msg.msg_iov = &iov;
+                msg.msg_iovlen = 1;
+                msg.msg_control = control;
+                msg.msg_controllen = sizeof(control);
+
+                cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+
+                cmsg->cmsg_level = SOL_SOCKET;
+                cmsg->cmsg_type = SCM_RIGHTS;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+
+                std::memcpy(CMSG_DATA(cmsg), &event_fd, sizeof(int));
+
+                if (sendmsg(conn_fd, &msg, MSG_NOSIGNAL) == 1) {
+
+                    return event_fd; // the writer picks it up at its next update
+                }
+
+                ::close(event_fd);
+
+            }
+
+            ::close(conn_fd);
+
+            conn_fd = -1;
+
+            return -1;
+
+        }
+
+        inline uint64_t notifyClear(int event_fd) {
+
+            // number of notifications since the last call (0 if none)
+            uint64_t count = 0;
+
+            if (event_fd == -1 ||
+                read(event_fd, &count, sizeof(count)) != sizeof(count)) {
+
+                return 0;
+            }
+
+            return count;
+
+        }
+
+        inline void notifyDisconnect(int& event_fd,
+                            int& conn_fd) {
+
+            if (event_fd != -1) {
+
+                ::close(event_fd);
+            }
+
+            if (conn_fd != -1) {
+
+                ::close(conn_fd);
+            }
+
+            event_fd = -1;
+            conn_fd = -1;
+
+        }
+
+    }
+
+}
+
+#endif // NOTIFYUTILS_HPP
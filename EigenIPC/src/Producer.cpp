@@ -17,6 +17,11 @@
 
 #include <EigenIPC/Producer.hpp>
 
+// private headers
+#include <MemUtils.hpp>
+#include <SyncUtils.hpp>
+#include <NotifyUtils.hpp>
+
 namespace EigenIPC {
 
     Producer::Producer(
@@ -28,27 +33,13 @@ namespace EigenIPC {
         : _verbose(verbose),
         _vlevel(vlevel),
         _journal(Journal(_getThisName())),
-        _trigger_counter_srvr(1, 1,
-            basename + TRIGGER_BASENAME, 
-            name_space,
-            verbose,
-            vlevel,
-            force_reconnection, 
-            false),
-        _trigger_counter(1, 1),
-        _ack_counter_srvr(1, 1,
-            basename + ACK_BASENAME, 
-            name_space,
-            verbose,
-            vlevel,
-            force_reconnection, 
-            false),
-        _ack_counter(1, 1),
+        _mem_config(basename + BARRIER_BASENAME, name_space),
         _closed(true),
         _basename(basename),
         _namespace(name_space),
         _unique_id(std::string("->")+ basename+std::string("-")+name_space),
-        _force_reconnection(force_reconnection)
+        _force_reconnection(force_reconnection),
+        _ack_latency_hist(SyncUtils::BARRIER_MAX_CONSUMERS * N_LATENCY_BINS, 0)
     {
 
     }
@@ -62,17 +53,14 @@ namespace EigenIPC {
 
         if (!_is_running) {
 
-            _create_cond_vars(); // we first create the condition variables
-
-            _trigger_counter_srvr.run();
-            _ack_counter_srvr.run();
-
-            _init_counters();
+            _init_barrier(); // consumers can attach from now on
 
             _is_running = true;
             _closed = false;
 
-            _acks_before = 0;
+            _round_mask = 0;
+            _recorded_mask = 0;
+            _round_epoch = 0;
 
             if (_verbose &&
                 _vlevel > VLevel::V1) {
@@ -89,13 +77,35 @@ namespace EigenIPC {
     void Producer::close() {
 
         if (!_closed) {
-            
-            _trigger_counter_srvr.close();
-            _ack_counter_srvr.close();
 
+            // consumers waiting for triggers give up
+            _barrier->running.store(0, std::memory_order_release);
+
+            SyncUtils::futexWake(_barrier->epoch, INT_MAX);
+            SyncUtils::futexWake(_barrier->acks, INT_MAX);
+
+            if (_notifier) {
+
+                NotifyUtils::notifierSignal(*_notifier); // pollers find out with wait()
+            }
+
+            bool taken_over = MemUtils::isUnlinked(_shm_fd); // by another
+            // producer (force_reconnection)
+
+            MemUtils::unmapMem(_barrier, _mem_size, _shm_fd);
+
+            if (!taken_over) {
+
+                shm_unlink(_mem_config.mem_path.c_str());
+            }
+
+            _barrier = nullptr;
+
+            _is_running = false;
             _closed = true;
         }
-        
+
+        _notifier.reset(); // consumers' eventfds are closed too
     
     }
 
@@ -103,11 +113,29 @@ namespace EigenIPC {
 
         _check_running(std::string(__FUNCTION__));
 
-        ScopedLock trigger_lock = _trigger_cond_ptr->lock();
-        
-        _increment_trigger();
+        _reap_consumers(); // dead consumers are not waited for
+
+        // consumers which register from now on will wait for the next trigger
+        _round_mask = _barrier->registered.load(std::memory_order_acquire);
+        _recorded_mask = 0;
+
+        _trigger_ns = SyncUtils::nowNs();
+
+        _barrier->ack_mask.store(0, std::memory_order_relaxed);
+        _barrier->trigger_ns.store(_trigger_ns, std::memory_order_relaxed);
+
+        // a single atomic increment (plus a wake-up syscall, only if
+        // some consumer is actually sleeping). Also publishes the stores above
+        SyncUtils::futexNotify(_barrier->epoch, _barrier->epoch_waiters);
+
+        _round_epoch = _barrier->epoch.load(std::memory_order_relaxed); // we are
+        // the only ones incrementing it
+
+        if (_notifier) {
+
+            NotifyUtils::notifierSignal(*_notifier); // consumers polling their fds
+        }
 
-        _trigger_cond_ptr->notify_all();
     }
 
     bool Producer::wait_ack_from(int n_consumers,
@@ -115,125 +143,295 @@ namespace EigenIPC {
         
         _check_running(std::string(__FUNCTION__));
 
-        ScopedLock ack_lock = _ack_cond_ptr->lock();
-        
-        _ack_completed = false;
-
-        while (!_ack_completed) {
-            
-            _ack_completed = _check_ack_counter(n_consumers);
-            
-            if (!_ack_completed) {
-                
-                // wait (unlock and lock mutex atomically when
-                // returning)
-                if(!_wait(ack_lock, ms_timeout)) {
-
-                    return false;
-                }
-            }
-            
+        uint32_t acks = 0;
+        uint64_t acked = 0;
+
+        long long start_ns = SyncUtils::nowNs();
+
+        bool ack_completed = SyncUtils::futexWaitUntil(_barrier->acks,
+                            _barrier->ack_waiters,
+                            acks,
+                            [&](uint32_t) {
+                                acked = SyncUtils::barrierAcked(_barrier, _round_epoch);
+                                return __builtin_popcountll(acked) >= n_consumers;
+                            },
+                            []() { return true; }, // dead consumers -> timeout
+                            ms_timeout > 0 ? ms_timeout : -1, // otherwise blocking
+                            SyncUtils::spinBudget(_wait_policy, _max_spin_ns, _avg_wait_ns));
+
+        _record_latencies(acked);
+
+        if (ack_completed) {
+
+            // the spin budget follows the observed ack latency
+            SyncUtils::updateAvgWait(_avg_wait_ns, SyncUtils::nowNs() - start_ns);
         }
 
-        return true;
+        return ack_completed;
         
     }
-    
-    void Producer::_create_cond_vars() {
 
-        bool is_server = true; // this is a consumer
+    bool Producer::wait_ack_all(int ms_timeout) {
 
-        _trigger_cond_ptr = std::make_unique<ConditionVariable>(is_server,
-                            _basename + TRIGGER_COND_NAME,
-                            _namespace,
-                            _verbose,
-                            _vlevel,
-                            _force_reconnection);
+        _check_running(std::string(__FUNCTION__));
+
+        uint32_t acks = 0;
+        uint64_t acked = 0;
+
+        long long start_ns = SyncUtils::nowNs();
+
+        bool ack_completed = SyncUtils::futexWaitUntil(_barrier->acks,
+                            _barrier->ack_waiters,
+                            acks,
+                            [&](uint32_t) {
+                                // consumers closed in the meantime are not waited for
+                                uint64_t expected = _round_mask &
+                                        _barrier->registered.load(std::memory_order_acquire);
+                                acked = SyncUtils::barrierAcked(_barrier, _round_epoch);
+                                return (acked & expected) == expected;
+                            },
+                            [&]() {
+                                _reap_consumers(); // consumers dying in the meantime
+                                return true;
+                            },
+                            ms_timeout > 0 ? ms_timeout : -1, // otherwise blocking
+                            SyncUtils::spinBudget(_wait_policy, _max_spin_ns, _avg_wait_ns));
+
+        _record_latencies(acked);
+
+        if (ack_completed) {
+
+            SyncUtils::updateAvgWait(_avg_wait_ns, SyncUtils::nowNs() - start_ns);
+        }
 
-        _ack_cond_ptr = std::make_unique<ConditionVariable>(is_server,
-                _basename + ACK_COND_NAME,
-                _namespace,
-                _verbose,
-                _vlevel,
-                _force_reconnection);
+        return ack_completed;
 
     }
 
-    void Producer::_init_counters() {
+    std::vector<int> Producer::missing_acks() {
 
-        ScopedLock trigger_lock = _trigger_cond_ptr->lock();
-        _trigger_counter(0, 0) = 0; // initialize shared counter to 0
-        if (!_trigger_counter_srvr.write(_trigger_counter, 0, 0)) {
-            _journal.log(__FUNCTION__+_unique_id,
-                "Could not initialize trigger counter!",
-                LogType::EXCEP, 
-                true); // throw exception
-        }
+        _check_running(std::string(__FUNCTION__));
 
-        ScopedLock ack_lock = _ack_cond_ptr->lock();
-        _ack_counter(0, 0) = 0; // initialize shared counter to 0
-        if (!_ack_counter_srvr.write(_ack_counter, 0, 0)) {
-            _journal.log(__FUNCTION__+_unique_id,
-                "Could not initialize acknowledge counter!",
-                LogType::EXCEP, 
-                true); // throw exception
+        uint64_t missing = _round_mask &
+                _barrier->registered.load(std::memory_order_acquire) &
+                ~SyncUtils::barrierAcked(_barrier, _round_epoch);
+
+        std::vector<int> slots;
+
+        for (; missing != 0; missing &= missing - 1) {
+
+            slots.push_back(__builtin_ctzll(missing));
         }
 
+        return slots;
+
     }
 
-    void Producer::_increment_trigger() {
+    int Producer::n_consumers() {
+
+        _check_running(std::string(__FUNCTION__));
+
+        _reap_consumers(true);
+
+        return __builtin_popcountll(_barrier->registered.load(std::memory_order_acquire));
+
+    }
+
+    std::vector<uint64_t> Producer::ack_latency_histogram(int slot) {
+
+        if (slot < 0 || slot >= SyncUtils::BARRIER_MAX_CONSUMERS) {
 
-        _trigger_counter.array() += 1; // increment counter 
-        if (!_trigger_counter_srvr.write(_trigger_counter, 0, 0)) {
             _journal.log(__FUNCTION__+_unique_id,
-                "Could not increment trigger counter!",
-                LogType::EXCEP, 
+                "Invalid consumer slot " + std::to_string(slot),
+                LogType::EXCEP,
                 true); // throw exception
+
         }
 
+        auto first = _ack_latency_hist.begin() + slot * N_LATENCY_BINS;
+
+        return std::vector<uint64_t>(first, first + N_LATENCY_BINS);
+
     }
 
-    bool Producer::_check_ack_counter(int n_consumers) {
+    void Producer::reset_ack_stats() {
 
-        if (!_ack_counter_srvr.read(_ack_counter, 0, 0)) {
+        std::fill(_ack_latency_hist.begin(), _ack_latency_hist.end(), 0);
 
-            _journal.log(__FUNCTION__+_unique_id,
-                "Could not read acknowledge counter!",
-                LogType::EXCEP, 
-                true); // throw exception
+    }
+
+    void Producer::set_wait_policy(WaitPolicy policy,
+                        int max_spin_us) {
+
+        _wait_policy = policy;
+
+        _max_spin_ns = std::max(0, max_spin_us) * 1000LL;
+
+        _avg_wait_ns = 0.0;
+
+    }
+
+    bool Producer::enable_notify_fd() {
+
+        if (_notifier) {
+
+            return true; // already enabled
         }
 
-        if ((_ack_counter(0, 0) - _acks_before) == n_consumers) {
-            
-            _acks_before = _ack_counter(0, 0);
-            
-            return true;
+        std::unique_ptr<NotifyUtils::Notifier> notifier(new NotifyUtils::Notifier());
 
-        } else {
+        if (!NotifyUtils::notifierOpen(*notifier, _mem_config.mem_path)) {
+
+            if (_verbose) {
+
+                _journal.log(__FUNCTION__+_unique_id,
+                    std::string("Could not expose a notification fd: ") + strerror(errno),
+                    LogType::EXCEP); // nonblocking
+
+            }
 
             return false;
         }
 
+        _notifier = std::move(notifier);
+
+        return true;
+
+    }
+
+    void Producer::_reap_consumers(bool force) {
+
+        long long now_ns = SyncUtils::nowNs();
+
+        if (force || now_ns - _last_reap_ns >= SyncUtils::REAP_PERIOD_NS) {
+
+            SyncUtils::barrierReap(_barrier);
+
+            _last_reap_ns = now_ns;
+        }
+
     }
 
-    bool Producer::_wait(ScopedLock& ack_lock, 
-                int ms_timeout) {
+    void Producer::_init_barrier() {
+
+        _return_code = _return_code + ReturnCode::RESET;
 
-        if (ms_timeout > 0) {
+        // an already existing barrier is either stale or owned by another producer
+        int other_fd = -1;
+        std::size_t other_size = 0;
 
-            _timeout = !(_ack_cond_ptr->timedwait(ack_lock, ms_timeout)); // wait with timeout
-            
-            return !_timeout;
+        void* other_mem = MemUtils::openMem(_mem_config.mem_path,
+                            other_fd,
+                            other_size,
+                            _journal,
+                            _return_code,
+                            false,
+                            _vlevel);
+
+        if (other_mem != nullptr) {
+
+            SyncUtils::Barrier* other = static_cast<SyncUtils::Barrier*>(other_mem);
+
+            if (other_size >= sizeof(SyncUtils::Barrier) &&
+                SyncUtils::isBarrierReady(other) &&
+                SyncUtils::isBarrierAlive(other)) {
+
+                if (!_force_reconnection) {
+
+                    MemUtils::unmapMem(other_mem, other_size, other_fd);
+
+                    _journal.log(__FUNCTION__+_unique_id,
+                        "Another producer is already running at " + _mem_config.mem_path +
+                        ". Use force_reconnection to take over.",
+                        LogType::EXCEP,
+                        true); // throw exception
+
+                }
 
-        } else {
+                // the consumers of the old producer give up
+                other->running.store(0, std::memory_order_release);
 
-            _ack_cond_ptr->wait(ack_lock); // blocking
+                SyncUtils::futexWake(other->epoch, INT_MAX);
+
+            }
+
+            MemUtils::unmapMem(other_mem, other_size, other_fd);
+
+            shm_unlink(_mem_config.mem_path.c_str());
 
-            return true;
         }
 
+        _return_code = _return_code + ReturnCode::RESET;
+
+        _mem_size = sizeof(SyncUtils::Barrier) + _payload_size();
+
+        void* mem = MemUtils::initRawMem(_mem_size,
+                            _mem_config.mem_path,
+                            _shm_fd,
+                            _journal,
+                            _return_code,
+                            _verbose,
+                            _vlevel);
+
+        if (mem == nullptr) {
+
+            MemUtils::failWithCode(_return_code,
+                                _journal,
+                                __FUNCTION__,
+                                _mem_config.mem_path);
+        }
+
+        // memory is zero-initialized by ftruncate
+        _barrier = new (mem) SyncUtils::Barrier;
+
+        _barrier->owner.store(static_cast<uint32_t>(getpid()), std::memory_order_relaxed);
+        _barrier->running.store(1, std::memory_order_relaxed);
+        _barrier->epoch.store(0, std::memory_order_relaxed);
+        _barrier->epoch_waiters.store(0, std::memory_order_relaxed);
+        _barrier->acks.store(0, std::memory_order_relaxed);
+        _barrier->ack_waiters.store(0, std::memory_order_relaxed);
+        _barrier->registered.store(0, std::memory_order_relaxed);
+        _barrier->ack_mask.store(0, std::memory_order_relaxed);
+        _barrier->trigger_ns.store(0, std::memory_order_relaxed);
+
+        _init_payload(_barrier + 1);
+
+        // consumers can now use it
+        _barrier->magic.store(SyncUtils::BARRIER_MAGIC, std::memory_order_release);
+
     }
     
+    std::size_t Producer::_payload_size() {
+
+        return 0;
+
+    }
+
+    void Producer::_init_payload(void* /*payload*/) {
+
+    }
+
+    void Producer::_record_latencies(uint64_t acked) {
+
+        // acks of this round which were not accounted for yet (no allocations)
+        for (uint64_t new_acks = acked & ~_recorded_mask;
+                new_acks != 0; new_acks &= new_acks - 1) {
+
+            int slot = __builtin_ctzll(new_acks);
+
+            long long latency_us = (_barrier->slots[slot].ack_ns.load(std::memory_order_relaxed) -
+                                    _trigger_ns) / 1000;
+
+            int bin = latency_us > 0 ? 64 - __builtin_clzll(latency_us) : 0;
+
+            _ack_latency_hist[slot * N_LATENCY_BINS + std::min(bin, N_LATENCY_BINS - 1)]++;
+
+        }
+
+        _recorded_mask |= acked;
+
+    }
+
     std::string Producer::_getThisName(){
 
         return THISNAME;
@@ -25,6 +25,9 @@
 
 // private headers
 #include <MemUtils.hpp>
+#include <SyncUtils.hpp>
+#include <CopyUtils.hpp>
+#include <NotifyUtils.hpp>
 
 namespace EigenIPC {
 
@@ -36,7 +39,10 @@ namespace EigenIPC {
                    bool verbose,
                    VLevel vlevel,
                    bool force_reconnection,
-                   bool safe)
+                   bool safe,
+                   SyncMode sync_mode,
+                   int n_stripes,
+                   int n_slots)
         : _n_rows(n_rows),
         _n_cols(n_cols),
         _mem_config(basename, name_space),
@@ -45,32 +51,22 @@ namespace EigenIPC {
         _vlevel(vlevel),
         _safe(safe),
         _force_reconnection(force_reconnection),
+        _sync_mode(sync_mode),
+        _n_stripes(std::max(1, std::min(n_stripes, n_rows))), // at most one stripe per row
+        _n_slots(std::max(2, n_slots)), // the latest slot is never written
         _tensor_view(nullptr,
                     n_rows,
                     n_cols),
-        _n_rows_view(nullptr,
-                    1,
-                    1),
-        _n_cols_view(nullptr,
-                    1,
-                    1),
-        _n_clients_view(nullptr,
-                        1,
-                        1),
-        _dtype_view(nullptr,
-                    1,
-                    1),
-        _isrunning_view(nullptr,
-                    1,
-                    1),
-        _mem_layout_view(nullptr,
-                    1,
-                    1),
-        _journal(Journal(_getThisName()))
+        _journal(Journal(_getThisName())),
+        _batch_view(nullptr,
+                    n_rows,
+                    n_cols)
     {
 
         static_assert(MemUtils::IsValidDType<Scalar>::value, "Invalid data type provided.");
 
+        _pid = static_cast<uint32_t>(getpid()); // identifies us as owner of the data lock
+
         if (_force_reconnection &&
                 _verbose &&
                 _vlevel > VLevel::V1)
@@ -104,10 +100,6 @@ namespace EigenIPC {
 
         _initSems(); // creates necessary semaphores
 
-        _acquireSemTimeout(_mem_config.mem_path_data_sem,
-                        _data_sem,
-                        _verbose); 
-
         _return_code = _return_code + ReturnCode::RESET; // resets to None
 
         MemUtils::checkMem(_mem_config.mem_path,
@@ -121,16 +113,15 @@ namespace EigenIPC {
 
         _return_code = _return_code + ReturnCode::RESET;
 
-        // data memory
+        // data memory (with all the metadata in its header)
         _initDataMem();
 
-        // auxiliary data
-        _initMetaMem();
-
         _tensor_copy = Tensor<Scalar, Layout>::Zero(_n_rows,
                                             _n_cols); // used to hold
         // a copy of the shared tensor data
 
+        _batch_rows.assign(_n_rows, 0); // no allocations when batching
+
         _terminated = false; // just in case
 
         if (_verbose &&
@@ -185,13 +176,12 @@ namespace EigenIPC {
             // other servers trying to transition to running state will fail
             // due to the sever semaphore being acquired
 
-            _releaseSem(_mem_config.mem_path_data_sem,
-                        _data_sem,
-                        _verbose); // data can now be acquired by clients
-
             // set the running flag to true
             _running = true;
-            _isrunning_view(0, 0) = 1; // for the clients
+            _header->is_running.store(1, std::memory_order_release); // for the clients
+
+            MemUtils::touchMem(_data_shm_fd); // clients waiting in attach() proceed
+            // right away (no polling)
 
             if (_verbose &&
                 _vlevel > VLevel::V1) {
@@ -216,7 +206,14 @@ namespace EigenIPC {
         if (isRunning()) {
             
             _running = false;
-            _isrunning_view(0, 0) = 0; // for the clients
+            _header->is_running.store(0, std::memory_order_release); // for the clients
+
+            SyncUtils::wakeWaiters(_header); // clients waiting for updates give up
+
+            if (_notifier) {
+
+                NotifyUtils::notifierSignal(*_notifier); // pollers check isRunning()
+            }
 
             MemUtils::releaseSem(_mem_config.mem_path_server_sem,
                                 _srvr_sem,
@@ -257,11 +254,15 @@ namespace EigenIPC {
     void Server<Scalar, Layout>::close()
     {
 
+        commit(); // pending batched writes, if any, are published (and the data released)
+
         stop(); // stop server if running
 
         _cleanMems(); // cleans up all memory,
         // semaphores included (if necessary)
 
+        _notifier.reset(); // readers' eventfds are closed too
+
         if (_verbose &&
             _vlevel > VLevel::V1) {
 
@@ -275,18 +276,97 @@ namespace EigenIPC {
         }
     }
 
+    template <typename Scalar, int Layout>
+    bool Server<Scalar, Layout>::enableNotifyFd() {
+
+        if (_notifier) {
+
+            return true; // already enabled
+        }
+
+        std::unique_ptr<NotifyUtils::Notifier> notifier(new NotifyUtils::Notifier());
+
+        if (!NotifyUtils::notifierOpen(*notifier, _mem_config.mem_path)) {
+
+            if (_verbose) {
+
+                std::string error = std::string("Could not expose a notification fd for ") +
+                        _mem_config.mem_path + std::string(": ") + std::string(strerror(errno));
+
+                _journal.log(__FUNCTION__,
+                     error,
+                     LogType::EXCEP); // nonblocking
+
+            }
+
+            return false;
+        }
+
+        _notifier = std::move(notifier);
+
+        return true;
+
+    }
+
+    template <typename Scalar, int Layout>
+    void Server<Scalar, Layout>::_notifyUpdate() {
+
+        SyncUtils::notifyUpdate(_header); // wakes up waitForUpdate()
+
+        if (_notifier) {
+
+            NotifyUtils::notifierSignal(*_notifier);
+        }
+
+    }
+
     template <typename Scalar, int Layout>
     int Server<Scalar, Layout>::getNClients() {
 
-        _acquireData(true, false);
+        long long now_ns = SyncUtils::nowNs();
 
-        _n_clients = _n_clients_view(0, 0);
+        if (now_ns - _last_reap_ns >= SyncUtils::REAP_PERIOD_NS) {
 
-        _releaseData();
+            // clients which crashed never detach
+            SyncUtils::clientReap(_header);
+
+            _last_reap_ns = now_ns;
+        }
+
+        _n_clients = _header->n_clients.load(std::memory_order_acquire);
 
         return _n_clients;
     }
 
+    template <typename Scalar, int Layout>
+    std::vector<int> Server<Scalar, Layout>::getIdleClients(int ms_idle) {
+
+        std::vector<int> idle;
+
+        SyncUtils::clientReap(_header); // dead clients are not idle, just gone
+
+        _last_reap_ns = SyncUtils::nowNs();
+
+        long long oldest_ns = SyncUtils::coarseNowNs() - ms_idle * 1000000LL;
+
+        for (int slot = 0; slot < SyncUtils::MAX_CLIENTS; ++slot) {
+
+            const SyncUtils::ClientSlot& client = _header->clients[slot];
+
+            uint32_t pid = client.pid.load(std::memory_order_acquire);
+
+            if (pid != 0 &&
+                client.heartbeat_ns.load(std::memory_order_relaxed) < oldest_ns) {
+
+                idle.push_back(static_cast<int>(pid));
+            }
+
+        }
+
+        return idle;
+
+    }
+
     template <typename Scalar, int Layout>
     DType Server<Scalar, Layout>::getScalarType() const {
 
@@ -301,6 +381,25 @@ namespace EigenIPC {
 
     }
 
+    template <typename Scalar, int Layout>
+    uint64_t Server<Scalar, Layout>::getDataVersion() const {
+
+        if (_header == nullptr) {
+
+            return 0;
+        }
+
+        return _header->data_version.load(std::memory_order_acquire);
+
+    }
+
+    template <typename Scalar, int Layout>
+    SyncMode Server<Scalar, Layout>::getSyncMode() const {
+
+        return _sync_mode;
+
+    }
+
     template <typename Scalar, int Layout>
     std::string Server<Scalar, Layout>::getNamespace() const {
 
@@ -320,81 +419,147 @@ namespace EigenIPC {
                                  int row,
                                  int col) {
 
-        if (_running) {
+        return _write(data, row, col);
 
-            _data_acquired = true;
+    }
 
-            if (_safe) {
+    template <typename Scalar, int Layout>
+    bool Server<Scalar, Layout>::write(const TensorView<Scalar, Layout>& data,
+                                     int row,
+                                     int col) {
 
-                // first acquire data semaphore
-                _data_acquired = _acquireData(false, false);
-            }
+        return _write(data, row, col);
 
-            if(_data_acquired) {
+    }
+
+    template <typename Scalar, int Layout>
+    bool Server<Scalar, Layout>::read(TRef<Scalar, Layout> output,
+                                    int row, int col) {
+
+        return _read(output, row, col);
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool Server<Scalar, Layout>::read(TensorView<Scalar, Layout>& output,
+                                    int row, int col) {
+
+        return _read(output, row, col);
+
+    }
+
+    template <typename Scalar, int Layout>
+    template <typename DataT>
+    bool Server<Scalar, Layout>::_ringWrite(const DataT& data,
+                                    int row,
+                                    int col) {
+
+        // writers are serialized by the data lock -> the latest
+        // slot cannot change under our feet
+        int latest = _header->latest.load(std::memory_order_relaxed);
+        int next = SyncUtils::ringNextSlot(_header);
+
+        MMap<Scalar, Layout> next_view = SyncUtils::slotView<Scalar, Layout>(
+                                    _header, next,
+                                    _n_rows, _n_cols);
+
+        std::atomic<uint64_t>& seq = SyncUtils::slots(_header)[next].seq;
+
+        SyncUtils::seqWriteBegin(seq); // lets slow readers of this slot detect the overwrite
 
-                bool success_write = MemUtils::write<Scalar, Layout>(
+        if (data.rows() != _n_rows || data.cols() != _n_cols) {
+
+            // partial write -> the rest of the tensor comes from the latest slot
+            CopyUtils::copy(next_view,
+                                    SyncUtils::slotView<Scalar, Layout>(
+                                        _header, latest,
+                                        _n_rows, _n_cols),
+                                    true); // streaming stores
+
+        }
+
+        bool success_write = MemUtils::write<Scalar, Layout>(
                                         data,
-                                        _tensor_view,
+                                        next_view,
                                         row, col,
                                         _journal,
                                         _return_code,
                                         false,
                                         _vlevel);
 
-                if (_safe) {
-                    _releaseData();
-                }
+        SyncUtils::seqWriteEnd(seq);
 
-                return success_write;
-
-            } else {
-
-                return false; // failed to acquire sem
-            }
+        if (success_write) {
 
+            SyncUtils::ringPublish(_header, next);
         }
 
-        _checkIsRunning();
-
-        return false;
+        return success_write;
 
     }
 
     template <typename Scalar, int Layout>
-    bool Server<Scalar, Layout>::write(const TensorView<Scalar, Layout>& data,
-                                     int row,
-                                     int col) {
+    template <typename DataT>
+    bool Server<Scalar, Layout>::_write(const DataT& data,
+                                    int row,
+                                    int col) {
 
         if (_running) {
 
+            if (_batching) {
+
+                return _batchWrite(data, row, col); // we already hold the data
+            }
+
             _data_acquired = true;
 
             if (_safe) {
 
-                // first acquire data semaphore
-                _data_acquired = _acquireData(false, false);
+                // first acquire data lock (with SyncMode::SeqLock
+                // this only serializes concurrent writers: readers never take it)
+                _data_acquired = _acquireBlock(row, data.rows());
             }
 
             if(_data_acquired) {
 
-                bool success_write = MemUtils::write<Scalar, Layout>(
-                                        data,
-                                        _tensor_view,
-                                        row, col,
-                                        _journal,
-                                        _return_code,
-                                        false,
-                                        _vlevel);
+                bool seq_locked = _safe && _sync_mode == SyncMode::SeqLock;
+
+                if (seq_locked) {
+                    SyncUtils::seqWriteBegin(_header->seq);
+                }
+
+                bool success_write = (_safe && _sync_mode == SyncMode::Ring) ?
+                                        _ringWrite(data, row, col) :
+                                        MemUtils::write<Scalar, Layout>(
+                                            data,
+                                            _tensor_view,
+                                            row, col,
+                                            _journal,
+                                            _return_code,
+                                            false,
+                                            _vlevel);
+
+                if (success_write) {
+                    SyncUtils::markRows(_header, row, data.rows()); // for readChanged()
+                }
+
+                if (seq_locked) {
+                    SyncUtils::seqWriteEnd(_header->seq);
+                }
 
                 if (_safe) {
-                    _releaseData();
+                    _releaseBlock();
+                }
+
+                if (success_write) {
+                    _notifyUpdate(); // wakes up waitForUpdate() and pollers
                 }
 
                 return success_write;
 
             } else {
 
-                return false; // failed to acquire sem
+                return false; // failed to acquire lock
             }
 
         }
@@ -406,17 +571,63 @@ namespace EigenIPC {
     }
 
     template <typename Scalar, int Layout>
-    bool Server<Scalar, Layout>::read(TRef<Scalar, Layout> output,
+    template <typename OutT>
+    bool Server<Scalar, Layout>::_read(OutT& output,
                                     int row, int col) {
 
         if (_running) {
 
+            if (_batching) {
+
+                return false; // the data is ours until commit() (see beginBatch())
+            }
+
+            if (_safe && _sync_mode == SyncMode::Ring) {
+
+                // lock-free: copies out of the latest published slot
+                return SyncUtils::ringRead(_header,
+                            [&](int slot) {
+                                return MemUtils::read<Scalar, Layout>(
+                                            row, col,
+                                            output,
+                                            SyncUtils::slotView<Scalar, Layout>(
+                                                _header, slot,
+                                                _n_rows, _n_cols),
+                                            _journal,
+                                            _return_code,
+                                            false,
+                                            _vlevel);
+                            },
+                            _seq_max_retries,
+                            _return_code);
+
+            }
+
+            if (_safe && _sync_mode == SyncMode::SeqLock) {
+
+                // lock-free: retries the copy until it's not torn by a write
+                return SyncUtils::seqRead(_header->seq,
+                            [&]() {
+                                return MemUtils::read<Scalar, Layout>(
+                                            row, col,
+                                            output,
+                                            _tensor_view,
+                                            _journal,
+                                            _return_code,
+                                            false,
+                                            _vlevel);
+                            },
+                            _seq_max_retries,
+                            _return_code);
+
+            }
+
             _data_acquired = true;
 
             if (_safe) {
 
-                // first acquire data semaphore
-                _data_acquired = _acquireData(false, false);
+                // first acquire data lock
+                _data_acquired = _acquireBlock(row, output.rows());
             }
 
             if(_data_acquired) {
@@ -431,14 +642,14 @@ namespace EigenIPC {
                             _vlevel);
 
                 if (_safe) {
-                    _releaseData();
+                    _releaseBlock();
                 }
 
                 return success_read;
 
             } else {
 
-                return false; // failed to acquire sem
+                return false; // failed to acquire lock
             }
 
         }
@@ -450,67 +661,347 @@ namespace EigenIPC {
     }
 
     template <typename Scalar, int Layout>
-    bool Server<Scalar, Layout>::read(TensorView<Scalar, Layout>& output,
-                                    int row, int col) {
+    void Server<Scalar, Layout>::dataSemAcquire() 
+    {
 
-        if (_running) {
+        if (_sync_mode == SyncMode::Striped) { // (stripes are placed with the
+            // header, at construction)
 
-            _data_acquired = true;
+            // the whole tensor -> all stripes
+            _stripe_first = 0;
+            _stripe_last = _header->n_stripes - 1;
 
-            if (_safe) {
+            if (!SyncUtils::acquireStripes(_header,
+                        _stripe_first, _stripe_last,
+                        true, // blocking
+                        _return_code)) {
+
+                MemUtils::failWithCode(_return_code,
+                                   _journal,
+                                   __FUNCTION__);
 
-                // first acquire data semaphore
-                _data_acquired = _acquireData(false, false);
             }
 
-            if(_data_acquired) {
+            return;
 
-                bool success_read = MemUtils::read<Scalar, Layout>(
-                                       row, col,
-                                       output,
-                                       _tensor_view,
-                                       _journal,
-                                       _return_code,
-                                       false,
-                                       _vlevel);
-                
-                if (_safe) {
-                    _releaseData();
-                }
-                
-                return success_read;
+        }
 
-            } else {
+        _acquireData(true, _verbose);
 
-                return false; // failed to acquire sem
+    }
 
+    template <typename Scalar, int Layout>
+    void Server<Scalar, Layout>::dataSemRelease() 
+    {
+
+        if (_sync_mode == SyncMode::Striped) { // (stripes are placed with the
+            // header, at construction)
+
+            SyncUtils::releaseStripes(_header,
+                        0, _header->n_stripes - 1,
+                        _return_code);
+
+            return;
+
+        }
+
+        _releaseData();
+
+    }
+
+    template <typename Scalar, int Layout>
+    typename Server<Scalar, Layout>::WriteView Server<Scalar, Layout>::acquireView(
+                                    int row, int col,
+                                    int n_rows, int n_cols)
+    {
+
+        WriteView view; // invalid until the data is actually borrowed
+
+        if (!_running) {
+
+            _checkIsRunning();
+
+            return view;
+
+        }
+
+        if (!helpers::canFitTensor(_n_rows, _n_cols,
+                        row, col,
+                        n_rows, n_cols,
+                        _journal,
+                        _return_code,
+                        false,
+                        _vlevel)) {
+
+            return view;
+
+        }
+
+        if (_safe && _sync_mode == SyncMode::Striped) {
+
+            SyncUtils::stripeRange(_header,
+                        row, n_rows,
+                        view._stripe_first, view._stripe_last);
+
+            if (!SyncUtils::acquireStripes(_header,
+                        view._stripe_first, view._stripe_last,
+                        false, // nonblocking
+                        _return_code)) {
+
+                return view;
             }
 
+        } else if (_safe && !_acquireData(false, false)) {
+
+            return view; // (with SeqLock and Ring only serializes writers)
+
         }
 
-        _checkIsRunning();
+        Scalar* data = _tensor_view.data();
 
-        return false;
+        if (_safe && _sync_mode == SyncMode::SeqLock) {
+
+            SyncUtils::seqWriteBegin(_header->seq);
+
+        } else if (_safe && _sync_mode == SyncMode::Ring) {
+
+            int latest = _header->latest.load(std::memory_order_relaxed);
+
+            view._slot = SyncUtils::ringNextSlot(_header);
+
+            SyncUtils::seqWriteBegin(SyncUtils::slots(_header)[view._slot].seq);
+
+            MMap<Scalar, Layout> next_view = SyncUtils::slotView<Scalar, Layout>(
+                                    _header, view._slot,
+                                    _n_rows, _n_cols);
+
+            // the view may only cover part of the tensor -> we start from the latest data
+            CopyUtils::copy(next_view,
+                                    SyncUtils::slotView<Scalar, Layout>(
+                                        _header, latest,
+                                        _n_rows, _n_cols),
+                                    true); // streaming stores
+
+            data = next_view.data();
+
+        }
+
+        auto block = MMap<Scalar, Layout>(data, _n_rows, _n_cols).block(row, col,
+                                    n_rows, n_cols);
+
+        new (&view._data) BlockView<Scalar, Layout>(block.data(),
+                            n_rows, n_cols,
+                            Eigen::OuterStride<>(block.outerStride()));
+
+        view._row = row;
+        view._server = this;
+
+        return view;
 
     }
 
     template <typename Scalar, int Layout>
-    void Server<Scalar, Layout>::dataSemAcquire() 
+    bool Server<Scalar, Layout>::releaseView(WriteView& view)
     {
 
-        _acquireSemBlocking(_mem_config.mem_path_data_sem,
-                    _data_sem,
-                    _verbose);
+        if (view._server != this) {
+
+            return false; // not borrowed from this server (or already released)
+        }
+
+        view._server = nullptr;
+
+        if (_safe && _sync_mode == SyncMode::Striped) {
+
+            SyncUtils::markRows(_header, view._row, view._data.rows());
+
+            SyncUtils::releaseStripes(_header,
+                        view._stripe_first, view._stripe_last,
+                        _return_code);
+
+            _notifyUpdate();
+
+            return true;
+
+        }
+
+        if (_safe && _sync_mode == SyncMode::SeqLock) {
+
+            SyncUtils::seqWriteEnd(_header->seq);
+
+        } else if (_safe && _sync_mode == SyncMode::Ring) {
+
+            SyncUtils::seqWriteEnd(SyncUtils::slots(_header)[view._slot].seq);
+
+            SyncUtils::ringPublish(_header, view._slot);
+
+        }
+
+        SyncUtils::markRows(_header, view._row, view._data.rows()); // after
+        // publishing the data, but before letting other writers in
+
+        if (_safe) {
+
+            _releaseData();
+        }
+
+        _notifyUpdate();
+
+        return true;
 
     }
 
     template <typename Scalar, int Layout>
-    void Server<Scalar, Layout>::dataSemRelease() 
+    bool Server<Scalar, Layout>::beginBatch()
     {
 
-        _releaseSem(_mem_config.mem_path_data_sem,
-                    _data_sem,
-                    _verbose);
+        if (!_running) {
+
+            _checkIsRunning();
+
+            return false;
+        }
+
+        if (_batching) {
+
+            return false; // batches cannot be nested
+        }
+
+        // the whole tensor, since batched writes can go anywhere
+        if (_safe && !_acquireBlock(0, _n_rows)) {
+
+            return false;
+        }
+
+        new (&_batch_view) MMap<Scalar, Layout>(_tensor_view.data(),
+                            _n_rows, _n_cols);
+
+        if (_safe && _sync_mode == SyncMode::SeqLock) {
+
+            SyncUtils::seqWriteBegin(_header->seq); // until commit()
+
+        } else if (_safe && _sync_mode == SyncMode::Ring) {
+
+            int latest = _header->latest.load(std::memory_order_relaxed);
+
+            _batch_slot = SyncUtils::ringNextSlot(_header);
+
+            SyncUtils::seqWriteBegin(SyncUtils::slots(_header)[_batch_slot].seq);
+
+            MMap<Scalar, Layout> next_view = SyncUtils::slotView<Scalar, Layout>(
+                                    _header, _batch_slot,
+                                    _n_rows, _n_cols);
+
+            // writes may only cover part of the tensor -> we start from the latest data
+            CopyUtils::copy(next_view,
+                                    SyncUtils::slotView<Scalar, Layout>(
+                                        _header, latest,
+                                        _n_rows, _n_cols),
+                                    true); // streaming stores
+
+            new (&_batch_view) MMap<Scalar, Layout>(next_view.data(),
+                            _n_rows, _n_cols);
+
+        }
+
+        _batch_first = _n_rows;
+        _batch_last = -1;
+
+        _batching = true;
+
+        return true;
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool Server<Scalar, Layout>::commit()
+    {
+
+        if (!_batching) {
+
+            return false; // no batch to commit
+        }
+
+        _batching = false;
+
+        if (_safe && _sync_mode == SyncMode::SeqLock) {
+
+            SyncUtils::seqWriteEnd(_header->seq);
+
+        } else if (_safe && _sync_mode == SyncMode::Ring) {
+
+            SyncUtils::seqWriteEnd(SyncUtils::slots(_header)[_batch_slot].seq);
+
+            SyncUtils::ringPublish(_header, _batch_slot); // all writes at once
+
+        }
+
+        // one version bump per run of consecutive written rows
+        for (int row = _batch_first; row <= _batch_last; ++row) {
+
+            if (!_batch_rows[row]) {
+
+                continue;
+            }
+
+            int first = row;
+
+            while (row <= _batch_last && _batch_rows[row]) {
+
+                _batch_rows[row++] = 0;
+            }
+
+            SyncUtils::markRows(_header, first, row - first);
+
+        }
+
+        if (_safe) {
+
+            _releaseBlock();
+        }
+
+        if (_batch_last >= 0) {
+
+            _notifyUpdate(); // a single wake-up for the whole batch
+        }
+
+        return true;
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool Server<Scalar, Layout>::isBatching() const
+    {
+
+        return _batching;
+
+    }
+
+    template <typename Scalar, int Layout>
+    template <typename DataT>
+    bool Server<Scalar, Layout>::_batchWrite(const DataT& data,
+                                    int row,
+                                    int col) {
+
+        bool success_write = MemUtils::write<Scalar, Layout>(
+                                    data,
+                                    _batch_view,
+                                    row, col,
+                                    _journal,
+                                    _return_code,
+                                    false,
+                                    _vlevel);
+
+        if (success_write) {
+
+            std::fill(_batch_rows.begin() + row,
+                    _batch_rows.begin() + row + data.rows(), 1);
+
+            _batch_first = std::min(_batch_first, row);
+            _batch_last = std::max(_batch_last, row + static_cast<int>(data.rows()) - 1);
+        }
+
+        return success_write;
 
     }
 
@@ -629,84 +1120,83 @@ namespace EigenIPC {
 
         if (blocking) {
 
-            _acquireSemBlocking(_mem_config.mem_path_data_sem,
-                            _data_sem,
-                            verbose); // this is blocking
+            SyncUtils::lockAcquire(_header->lock,
+                            _pid,
+                            _return_code); // this is blocking
 
-            return true;
+        }
+        else if (!SyncUtils::lockTry(_header->lock,
+                            _pid,
+                            _return_code)) {
+
+            return false;
 
         }
-        else {
 
-            return _acquireSemOneShot(_mem_config.mem_path_data_sem,
-                        _data_sem);
+        if (verbose &&
+            isin(ReturnCode::LOCKOWNERDIED, _return_code)) {
+
+            _return_code = _return_code - ReturnCode::LOCKOWNERDIED;
+
+            std::string warn = std::string("Recovered data lock at ") +
+                    _mem_config.mem_path +
+                    std::string(" from a dead owner. Data may be inconsistent.");
+
+            _journal.log(__FUNCTION__,
+                warn,
+                LogType::WARN);
 
         }
 
+        return true;
+
     }
 
     template <typename Scalar, int Layout>
     void Server<Scalar, Layout>::_releaseData()
     {
 
-        _releaseSem(_mem_config.mem_path_data_sem,
-                    _data_sem,
-                    false // no verbosity (called frequently)
-                    );
+        SyncUtils::lockRelease(_header->lock);
 
     }
 
     template <typename Scalar, int Layout>
-    void Server<Scalar, Layout>::_cleanMetaMem()
+    bool Server<Scalar, Layout>::_acquireBlock(int row, int n_rows)
     {
-        // closing file descriptors and also unlinking
-        // memory
 
-        _return_code = _return_code + ReturnCode::RESET;
+        if (_sync_mode == SyncMode::Striped) {
 
+            // only the stripes the block falls into
+            SyncUtils::stripeRange(_header,
+                        row, n_rows,
+                        _stripe_first, _stripe_last);
 
-        MemUtils::cleanUpMem(_mem_config.mem_path_nrows,
-                             _nrows_shm_fd,
-                             _journal,
-                             _return_code,
-                             _verbose,
-                             _vlevel,
-                             _unlink_data);
+            return SyncUtils::acquireStripes(_header,
+                        _stripe_first, _stripe_last,
+                        false, // nonblocking
+                        _return_code);
 
-        MemUtils::cleanUpMem(_mem_config.mem_path_ncols,
-                             _ncols_shm_fd,
-                             _journal,
-                             _return_code,
-                             _verbose,
-                             _vlevel,
-                             _unlink_data);
+        }
 
-        MemUtils::cleanUpMem(_mem_config.mem_path_clients_counter,
-                             _n_clients_shm_fd,
-                             _journal,
-                             _return_code,
-                             _verbose,
-                             _vlevel,
-                             _unlink_data);
+        return _acquireData(false, false);
 
-        MemUtils::cleanUpMem(_mem_config.mem_path_dtype,
-                             _dtype_shm_fd,
-                             _journal,
-                             _return_code,
-                             _verbose,
-                             _vlevel,
-                             _unlink_data);
+    }
 
-        MemUtils::cleanUpMem(_mem_config.mem_path_mem_layout,
-                             _mem_layout_shm_fd,
-                             _journal,
-                             _return_code,
-                             _verbose,
-                             _vlevel,
-                             _unlink_data);
+    template <typename Scalar, int Layout>
+    void Server<Scalar, Layout>::_releaseBlock()
+    {
 
-        _return_code = _return_code + ReturnCode::RESET;
+        if (_sync_mode == SyncMode::Striped) {
+
+            SyncUtils::releaseStripes(_header,
+                        _stripe_first, _stripe_last,
+                        _return_code);
 
+            return;
+
+        }
+
+        _releaseData();
 
     }
 
@@ -728,9 +1218,6 @@ namespace EigenIPC {
 
             _return_code = _return_code + ReturnCode::RESET;
 
-
-            _cleanMetaMem();
-
             _closeSems(); // closing semaphores
 
             if (_verbose &&
@@ -752,70 +1239,10 @@ namespace EigenIPC {
     }
 
     template <typename Scalar, int Layout>
-    void Server<Scalar, Layout>::_initMetaMem()
+    void Server<Scalar, Layout>::_initDataMem()
     {
-        _return_code = _return_code + ReturnCode::RESET;
- // resets return code
 
-        MemUtils::initMem<int>(1,
-                        1,
-                        _mem_config.mem_path_nrows,
-                        _nrows_shm_fd,
-                        _n_rows_view,
-                        _journal,
-                        _return_code,
-                        _verbose,
-                        _vlevel);
-
-        MemUtils::initMem<int>(1,
-                        1,
-                        _mem_config.mem_path_ncols,
-                        _ncols_shm_fd,
-                        _n_cols_view,
-                        _journal,
-                        _return_code,
-                        _verbose,
-                        _vlevel);
-
-        MemUtils::initMem<int>(1,
-                        1,
-                        _mem_config.mem_path_clients_counter,
-                        _n_clients_shm_fd,
-                        _n_clients_view,
-                        _journal,
-                        _return_code,
-                        _verbose,
-                        _vlevel);
-
-        MemUtils::initMem<int>(1,
-                        1,
-                        _mem_config.mem_path_dtype,
-                        _dtype_shm_fd,
-                        _dtype_view,
-                        _journal,
-                        _return_code,
-                        _verbose,
-                        _vlevel);
-
-        MemUtils::initMem<bool>(1,
-                        1,
-                        _mem_config.mem_path_isrunning,
-                        _isrunning_shm_fd,
-                        _isrunning_view,
-                        _journal,
-                        _return_code,
-                        _verbose,
-                        _vlevel);
-
-        MemUtils::initMem<int>(1,
-                        1,
-                        _mem_config.mem_path_mem_layout,
-                        _mem_layout_shm_fd,
-                        _mem_layout_view,
-                        _journal,
-                        _return_code,
-                        _verbose,
-                        _vlevel);
+        _return_code = _return_code + ReturnCode::RESET;
 
         if (!isin(ReturnCode::MEMCREATFAIL,
                 _return_code) &&
@@ -824,54 +1251,87 @@ namespace EigenIPC {
             !isin(ReturnCode::MEMMAPFAIL,
                  _return_code)) {
 
-            // all memory creations where successful
+            // stripes and slot states, if any, are stored in the header, before the data
+            int n_stripes = _sync_mode == SyncMode::Striped ? _n_stripes : 0;
+            int n_slots = _sync_mode == SyncMode::Ring ? _n_slots : 0;
 
-            _n_rows_view(0, 0) = _n_rows;
-            _n_cols_view(0, 0) = _n_cols;
-            _n_clients_view(0, 0) = 0; // to be improved
-            // (what happens when server crashes and clients remain appended?)
-            _isrunning_view(0, 0) = 0;
+            std::size_t header_size = SyncUtils::headerSize(n_stripes, n_slots,
+                                        _n_rows); // + row versions
 
-            _mem_layout_view(0, 0) = _mem_layout; // mem layout
+            // additional tensor copies are placed after the first one
+            std::size_t data_size = sizeof(Scalar) * _n_rows * _n_cols;
+            std::size_t slot_stride = n_slots > 0 ? SyncUtils::slotStride(data_size) : data_size;
+            std::size_t tail_size = n_slots > 0 ? n_slots * slot_stride - data_size : 0;
 
-            _dtype_view(0, 0) = sizeof(Scalar);
+            MemUtils::initMem<Scalar, Layout>(
+                            _n_rows,
+                            _n_cols,
+                            _mem_config.mem_path,
+                            _data_shm_fd,
+                            _tensor_view,
+                            _journal,
+                            _return_code,
+                            _verbose,
+                            _vlevel,
+                            header_size, // sync header before data
+                            tail_size);
 
-            _return_code = _return_code + ReturnCode::RESET;
+            if (isin(ReturnCode::MEMMAPFAIL, _return_code) ||
+                isin(ReturnCode::MEMSETFAIL, _return_code) ||
+                isin(ReturnCode::MEMCREATFAIL, _return_code)) {
 
-        }
-        else {
+                MemUtils::failWithCode(_return_code,
+                                   _journal,
+                                   __FUNCTION__,
+                                   _mem_config.mem_path);
+            }
 
-            MemUtils::failWithCode(_return_code,
+            // memory is zero-initialized by ftruncate
+            _header = new (reinterpret_cast<char*>(_tensor_view.data()) -
+                            header_size) SyncUtils::MemHeader;
+
+            _header->data_offset = header_size;
+            _header->slot_stride = slot_stride;
+            _header->versions_offset = SyncUtils::headerSize(n_stripes, n_slots);
+            _header->n_slots = std::max(1, n_slots);
+            _header->n_stripes = 0;
+            _header->rows_per_stripe = _n_rows;
+            _header->latest.store(0, std::memory_order_relaxed); // slot 0 is zeroed
+
+            if (n_stripes > 0 &&
+                !SyncUtils::initStripes(_header,
+                            n_stripes, _n_rows,
+                            _return_code)) {
+
+                MemUtils::failWithCode(_return_code,
                                    _journal,
-                                   __FUNCTION__);
+                                   __FUNCTION__,
+                                   _mem_config.mem_path);
+            }
 
-        }
+            _header->dtype = sizeof(Scalar);
+            _header->mem_layout = _mem_layout;
+            _header->n_rows = _n_rows;
+            _header->n_cols = _n_cols;
+            _header->sync_mode = static_cast<int>(_sync_mode);
 
-    }
+            _header->is_running.store(0, std::memory_order_relaxed);
+            _header->n_clients.store(0, std::memory_order_relaxed);
 
-    template <typename Scalar, int Layout>
-    void Server<Scalar, Layout>::_initDataMem()
-    {
+            for (int w = 0; w < SyncUtils::CLIENT_MASK_WORDS; ++w) {
 
-        _return_code = _return_code + ReturnCode::RESET;
+                _header->client_mask[w].store(0, std::memory_order_relaxed);
+            }
+            _header->lock.store(0, std::memory_order_relaxed);
+            _header->seq.store(0, std::memory_order_relaxed);
+            _header->generation.store(0, std::memory_order_relaxed);
+            _header->n_waiters.store(0, std::memory_order_relaxed);
+            _header->data_version.store(0, std::memory_order_relaxed); // rows are
+            // all at version 0
 
-        if (!isin(ReturnCode::MEMCREATFAIL,
-                _return_code) &&
-            !isin(ReturnCode::MEMSETFAIL,
-                _return_code) &&
-            !isin(ReturnCode::MEMMAPFAIL,
-                 _return_code)) {
+            SyncUtils::publishHeader(_header); // clients can now attach
 
-            MemUtils::initMem<Scalar, Layout>(
-                            _n_rows,
-                            _n_cols,
-                            _mem_config.mem_path,
-                            _data_shm_fd,
-                            _tensor_view,
-                            _journal,
-                            _return_code,
-                            _verbose,
-                            _vlevel);
+            MemUtils::touchMem(_data_shm_fd); // wakes up clients waiting for it
 
             _return_code = _return_code + ReturnCode::RESET;
 
@@ -908,23 +1368,6 @@ namespace EigenIPC {
 
         _return_code = _return_code + ReturnCode::RESET;
 
-        MemUtils::semInit(_mem_config.mem_path_data_sem,
-                          _data_sem,
-                          _journal,
-                          _return_code,
-                          _verbose,
-                          _vlevel);
-
-        if (isin(ReturnCode::SEMOPENFAIL, _return_code)) {
-
-            MemUtils::failWithCode(_return_code,
-                                   _journal,
-                                   __FUNCTION__,
-                                   _mem_config.mem_path_data_sem);
-        }
-
-        _return_code = _return_code + ReturnCode::RESET;
-
     }
 
     template <typename Scalar, int Layout>
@@ -941,14 +1384,6 @@ namespace EigenIPC {
                            _vlevel,
                            true);
 
-        MemUtils::semClose(_mem_config.mem_path_data_sem,
-                           _data_sem,
-                           _journal,
-                           _return_code,
-                           _verbose,
-                           _vlevel,
-                           true);
-
     }
 
     template <typename Scalar, int Layout>
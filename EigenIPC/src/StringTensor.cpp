@@ -16,6 +16,12 @@
 // along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
 // 
 
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include <sys/mman.h>
+
 #include <EigenIPC/StringTensor.hpp>
 
 namespace EigenIPC {
@@ -45,9 +51,11 @@ namespace EigenIPC {
                                                    bool verbose,
                                                    VLevel vlevel,
                                                    bool force_reconnection,
-                                                   bool safe) {
+                                                   bool safe,
+                                                   int arena_bytes) {
 
-        return StrServer(_n_rows, length,
+        return StrServer(_n_index_rows + _arena_rows(length, arena_bytes),
+                        length,
                         basename,
                         name_space,
                         verbose,
@@ -64,7 +72,9 @@ namespace EigenIPC {
                                            bool verbose,
                                            VLevel vlevel,
                                            bool safe)
-    : _sh_mem(_initClient(basename, name_space,
+    : _writers_path("/" + name_space + basename + "_str_writers"),
+      _journal(Journal("StringTensor")),
+      _sh_mem(_initClient(basename, name_space,
                          verbose, vlevel,
                          safe)) {
 
@@ -79,15 +89,21 @@ namespace EigenIPC {
                                            bool verbose,
                                            VLevel vlevel,
                                            bool force_reconnection,
-                                           bool safe)
-    : _sh_mem(_initServer(length,
+                                           bool safe,
+                                           int arena_bytes)
+    : _length(length),
+      _is_server(true),
+      _writers_path("/" + name_space + basename + "_str_writers"),
+      _journal(Journal("StringTensor")),
+      _sh_mem(_initServer(length,
                          basename, name_space,
                          verbose, vlevel,
                          force_reconnection,
-                         safe)),
-      _length(length),
-      _buffer(Tensor<int>(_n_rows, length)), // we can initialize buffer
-      _is_server(true){ 
+                         safe,
+                         arena_bytes)),
+      _writers(_openWriters(_writers_path, force_reconnection)) {
+
+        _init_buffers(); // we can initialize buffers
 
     }
 
@@ -98,10 +114,13 @@ namespace EigenIPC {
 
             _sh_mem.attach();
 
+            _writers = _openWriters(_writers_path, false); // the server's
+            // (which exists by now)
+
             _length =_sh_mem.getNCols(); // getting from
             // client (client gets this from server)
 
-            _buffer = Tensor<int>(_n_rows, _length); // we can now initialize the buffer
+            _init_buffers(); // we can now initialize the buffers
 
             _running = true;
         }
@@ -132,6 +151,52 @@ namespace EigenIPC {
         return _sh_mem;
     }
 
+    template <>
+    int StringTensor<StrServer>::getNClients() {
+
+        return _sh_mem.getNClients();
+
+    }
+
+    template <>
+    int StringTensor<StrClient>::getNClients() {
+
+        return -1;
+
+    }
+
+    template <>
+    bool StringTensor<StrServer>::_refresh() {
+
+        // the server has no read views -> we copy the whole tensor
+        if (!_sh_mem.read(_buffer, 0, 0)) {
+
+            return false;
+        }
+
+        return _update_cache(_buffer.data());
+
+    }
+
+    template <>
+    bool StringTensor<StrClient>::_refresh() {
+
+        // zero-copy: strings are copied straight out of the shared memory
+        StrClient::ReadView view = _sh_mem.acquireView(0, 0,
+                                        _n_rows, _length);
+
+        if (!view.isValid()) {
+
+            return false; // data is busy
+        }
+
+        bool success = _update_cache(view.data().data());
+
+        // false if a writer got in the way (e.g. with SyncMode::SeqLock)
+        return _sh_mem.releaseView(view) && success;
+
+    }
+
     // class specialization
     template class StringTensor<StrServer>;
     template class StringTensor<StrClient>;
@@ -149,20 +214,6 @@ namespace EigenIPC {
         
         return _is_server;
     }
-    
-    template <>
-    int StringTensor<StrServer>::getNClients() {
-
-        return _sh_mem.getNClients();
-
-    }
-
-    template <>
-    int StringTensor<StrClient>::getNClients() {
-
-        return -1;
-
-    }
 
     template <typename ShMemType>
     bool StringTensor<ShMemType>::read(std::vector<std::string>& vec,
@@ -171,10 +222,19 @@ namespace EigenIPC {
         // (&& guarantees short-circuit evaluation, i.e.
         // ordered evaluation)
 
-        return isRunning() &&
-               _sh_mem.read(_buffer.block(0, col_index,
-                                                _n_rows, vec.size()), 0, col_index) && // just update the block
-               _decode_vec(vec, col_index);
+        if (!(isRunning() &&
+            _fits(vec.size(), col_index) &&
+            _sync())) {
+
+            return false;
+        }
+
+        for (std::size_t i = 0; i < vec.size(); ++i) {
+
+            vec[i] = _cache[col_index + i];
+        }
+
+        return true;
 
     }
 
@@ -182,21 +242,23 @@ namespace EigenIPC {
     bool StringTensor<ShMemType>::read(std::string& str,
                                        int col_index) {
 
-
-        if (!isRunning() ||
-            col_index < 0 ||
-            col_index >= _length ||
-            !_sh_mem.read(_buffer.block(0, col_index,
-                                              _n_rows, 1), 0, col_index) // just update the right column
-                                ) {
+        if (!(isRunning() &&
+            _fits(1, col_index) &&
+            _sync())) {
 
             return false;
         }
 
-        _decode_str(str, col_index);
+        str = _cache[col_index];
 
         return true;
 
+    }
+
+    template <typename ShMemType>
+    bool StringTensor<ShMemType>::isStale() {
+
+        return !_synced || _sh_mem.getDataVersion() != _synced_version;
 
     }
 
@@ -205,10 +267,8 @@ namespace EigenIPC {
                                         int col_index) {
 
         return isRunning() &&
-               _encode_vec(vec, col_index) &&
-               _sh_mem.write(_buffer.block(0, col_index,
-                                                  _n_rows, vec.size()),
-                                    0, col_index);
+               _fits(vec.size(), col_index) &&
+               _encode(vec.data(), vec.size(), col_index);
 
     }
 
@@ -216,18 +276,9 @@ namespace EigenIPC {
     bool StringTensor<ShMemType>::write(const std::string& str,
                                         int col_index) {
 
-        if (!isRunning() ||
-            col_index < 0 ||
-            col_index >= _length) {
-
-            return false;
-        }
-
-        _encode_str(str, col_index);
-
-        return  _sh_mem.write(_buffer.block(0, col_index,
-                                                  _n_rows, 1),
-                                    0, col_index);
+        return isRunning() &&
+               _fits(1, col_index) &&
+               _encode(&str, 1, col_index);
 
     }
 
@@ -264,118 +315,337 @@ namespace EigenIPC {
 
         _sh_mem.close();
 
+        // the mutex goes with the server, unless a newer one took over
+        // (or we already removed it)
+        if (_is_server && _writers && !_writers->isUnlinked()) {
+
+            shm_unlink(_writers_path.c_str());
+        }
+
     }
 
     template <typename ShMemType>
     Tensor<int> StringTensor<ShMemType>::get_raw_buffer() {
         
         // returns a copy (user must not be allowed to modify
-        // the buffer in unintended ways)
+        // the buffer in unintended ways) of the latest
+        // raw data (index and arena)
+
+        if (isRunning()) {
+
+            _sh_mem.read(_buffer, 0, 0); // if busy, we keep the last copy
+        }
 
         return _buffer;
 
     }
 
     template <typename ShMemType>
-    bool StringTensor<ShMemType>::_encode_vec(const std::vector<std::string>& vec, int col_index) {
+    int StringTensor<ShMemType>::_arena_rows(int length,
+                                             int arena_bytes) {
 
-        if (!_fits(vec, col_index)) {
+        if (length <= 0) {
 
-            return false;
+            return 1; // the Server will complain about the length
+        }
+
+        long long n_bytes = arena_bytes < 0 ?
+                    static_cast<long long>(length) * _default_chars : arena_bytes;
+
+        long long row_bytes = static_cast<long long>(length) * sizeof(int);
+
+        long long n_rows = (n_bytes + row_bytes - 1) / row_bytes;
 
+        return n_rows > 0 ? static_cast<int>(n_rows) : 1;
+
+    }
+
+    template <typename ShMemType>
+    std::unique_ptr<ConditionVariable::NamedMutex> StringTensor<ShMemType>::_openWriters(
+                                                const std::string& path,
+                                                bool fresh) {
+
+        if (fresh) {
+
+            shm_unlink(path.c_str()); // clients of the old server keep theirs
         }
 
-        for (const auto& str : vec) { // for each string
+        return std::make_unique<ConditionVariable::NamedMutex>(
+                        ConditionVariable::create_named_mutex(path));
+
+    }
+
+    template <typename ShMemType>
+    void StringTensor<ShMemType>::_init_buffers() {
+
+        _n_rows = _sh_mem.getNRows();
 
-            _encode_str(str, col_index);
+        _arena_capacity = static_cast<long long>(_n_rows - _n_index_rows) *
+                    _length * sizeof(int);
 
-            ++col_index; // go to next column (i.e. string)
+        _buffer = Tensor<int>::Zero(_n_rows, _length);
+
+        _scratch.reserve(_arena_capacity);
+
+        _cache.assign(_length, std::string());
+        _cache_stamps.assign(_length, -1);
+
+        _synced = false;
+
+    }
+
+    template <typename ShMemType>
+    bool StringTensor<ShMemType>::_fits(int n,
+                                       int index) {
+
+        if (index < 0 || index + n > _length) {
+
+            return false;
         }
 
         return true;
+
     }
 
     template <typename ShMemType>
-    void StringTensor<ShMemType>::_encode_str(const std::string& str,
-                                       int col_index) {
-
-        _buffer.col(col_index).setZero(); // reset buffer
+    long long StringTensor<ShMemType>::_arena_used() {
 
-        for (size_t i = 0, row = 0;
-             i < str.size();
-             i += sizeof(int), ++row) { // increment row counter
-            // and move through the string by sizeof(int)
+        // the arena is filled up to the end of the
+        // last allocated string
+        const int* offsets = _buffer.data();
+        const int* sizes = offsets + _length;
 
-            _tmp_value = 0;
+        long long used = 0;
 
-            for (size_t j = 0;
-                 j < sizeof(int) && i + j < str.size(); // move within the chunk up to string size
-                 ++j) {
+        for (int i = 0; i < _length; ++i) {
 
-                _tmp_value |= // UTF8 encoding
-                       (static_cast<int>(static_cast<unsigned char>(str[i + j])) << (j * 8));
+            if (sizes[i] > 0 && offsets[i] + static_cast<long long>(sizes[i]) > used) {
 
+                used = offsets[i] + static_cast<long long>(sizes[i]);
             }
+        }
+
+        return used;
+
+    }
+
+    template <typename ShMemType>
+    long long StringTensor<ShMemType>::_compact() {
+
+        // packs the live strings at the beginning of the arena
+        // (in index order)
+        int* offsets = _buffer.data();
+        int* sizes = offsets + _length;
+        char* arena = reinterpret_cast<char*>(_buffer.data() + _n_index_rows * _length);
+
+        _scratch.clear();
+
+        for (int i = 0; i < _length; ++i) {
+
+            int offset = static_cast<int>(_scratch.size());
 
-            _buffer(row, col_index) = _tmp_value; // write to tmp buffer
+            if (sizes[i] > 0) {
 
+                _scratch.append(arena + offsets[i], sizes[i]);
+            }
+
+            offsets[i] = offset;
         }
 
+        std::memcpy(arena, _scratch.data(), _scratch.size());
+
+        return _scratch.size();
+
     }
 
     template <typename ShMemType>
-    void StringTensor<ShMemType>::_decode_str(std::string& str,
-                                       int col_index) {
+    bool StringTensor<ShMemType>::_encode(const std::string* strs,
+                                          int n,
+                                          int col_index) {
+
+        // from reading the index to publishing the new one, no other writer
+        // can allocate in (or compact) the arena
+        ConditionVariable::ScopedLock lock(*_writers);
+
+        // we need the current index (the arena only where we touch it, see below)
+        if (!_sh_mem.read(_buffer.topRows(_n_index_rows), 0, 0)) {
+
+            return false;
+        }
+
+        int* offsets = _buffer.data();
+        int* sizes = offsets + _length;
+        int* stamps = sizes + _length;
+        char* arena = reinterpret_cast<char*>(stamps + _length);
+
+        long long needed = 0;
 
-        str.clear();
+        for (int i = 0; i < n; ++i) {
 
-        for (int row = 0; row < _n_rows; ++row) { // for each chunk
+            needed += strs[i].size();
+        }
+
+        long long used = _arena_used();
+
+        bool compacted = false;
 
-            _tmp_value = _buffer(row, col_index);
+        if (used + needed > _arena_capacity) {
 
-            for (size_t j = 0; j < sizeof(int); ++j) {
+            if (!_sh_mem.read(_buffer, 0, 0)) { // the live strings are needed
 
-                char c = (_tmp_value >> (j * 8)) & 0xFF; // decode to UTF8
+                return false;
+            }
 
-                if (c == 0) break;
+            for (int i = 0; i < n; ++i) {
 
-                str.push_back(c); // add to string
+                sizes[col_index + i] = 0; // being overwritten
             }
 
-            if (str.size() % sizeof(int) != 0) break; // exit if out of range
+            used = _compact();
+
+            compacted = true;
+
+            if (used + needed > _arena_capacity) {
+
+                std::string error = std::string("Not enough space in the string arena (") +
+                    std::to_string(used + needed) + std::string(" bytes needed, ") +
+                    std::to_string(_arena_capacity) + std::string(" available)");
+
+                _journal.log(__FUNCTION__,
+                    error,
+                    Journal::LogType::WARN);
+
+                return false;
+            }
 
         }
 
+        long long first = used;
+
+        long long row_bytes = static_cast<long long>(_length) * sizeof(int);
+
+        if (!compacted && first % row_bytes != 0) {
+
+            // the first row we write back also holds the tail of live
+            // strings: our local copy of the arena is not up to date
+            int first_row = _n_index_rows + static_cast<int>(first / row_bytes);
+
+            if (!_sh_mem.read(_buffer.middleRows(first_row, 1), first_row, 0)) {
+
+                return false;
+            }
+
+        }
+
+        for (int i = 0; i < n; ++i) {
+
+            std::memcpy(arena + used, strs[i].data(), strs[i].size());
+
+            offsets[col_index + i] = static_cast<int>(used);
+            sizes[col_index + i] = static_cast<int>(strs[i].size());
+            stamps[col_index + i] = stamps[col_index + i] < INT_MAX ?
+                        stamps[col_index + i] + 1 : 0; // never -1
+
+            used += strs[i].size();
+        }
+
+        if (compacted) {
+
+            return _sh_mem.write(_buffer, 0, 0); // everything moved
+        }
+
+        // first the new strings (in the free part of the arena, i.e. invisible
+        // to readers), then the index (which makes them visible)
+        if (used > first) {
+
+            int first_row = _n_index_rows + static_cast<int>(first / row_bytes);
+            int last_row = _n_index_rows + static_cast<int>((used - 1) / row_bytes);
+
+            if (!_sh_mem.write(_buffer.middleRows(first_row, last_row - first_row + 1),
+                            first_row, 0)) {
+
+                return false;
+            }
+
+        }
+
+        return _sh_mem.write(_buffer.block(0, col_index,
+                                        _n_index_rows, n),
+                            0, col_index);
+
     }
 
     template <typename ShMemType>
-    bool StringTensor<ShMemType>::_decode_vec(std::vector<std::string>& vec,
-                                       int col_index) {
+    bool StringTensor<ShMemType>::_sync() {
 
-        if (!_fits(vec, col_index)) {
+        // loaded before reading: if a write lands in between, we
+        // are just going to refresh again at the next read
+        uint64_t version = _sh_mem.getDataVersion();
+
+        if (_synced && version == _synced_version) {
+
+            return true; // nothing was written since the last read
+        }
+
+        if (!_refresh()) {
+
+            // what we decoded may be torn -> nothing is trusted
+            std::fill(_cache_stamps.begin(), _cache_stamps.end(), -1);
+
+            _synced = false;
 
             return false;
         }
 
-        for (auto& str : vec) { // for each string
+        _synced_version = version;
+        _synced = true;
+
+        return true;
+
+    }
+
+    template <typename ShMemType>
+    bool StringTensor<ShMemType>::_update_cache(const int* data) {
 
-            _decode_str(str, col_index);
+        // only decodes the strings which were written
+        // since they were cached
+        const int* stamps = data + 2 * _length;
 
-            ++col_index; // go to next string (i.e. column)
+        for (int i = 0; i < _length; ++i) {
+
+            if (stamps[i] != _cache_stamps[i]) {
+
+                if (!_decode_str(data, _cache[i], i)) {
+
+                    return false;
+                }
+
+                _cache_stamps[i] = stamps[i];
+            }
         }
 
         return true;
+
     }
 
     template <typename ShMemType>
-    bool StringTensor<ShMemType>::_fits(const std::vector<std::string>& vec,
-                                       int index) {
+    bool StringTensor<ShMemType>::_decode_str(const int* data,
+                                              std::string& str,
+                                              int col_index) {
 
-        if (index + vec.size() > _length) {
+        int offset = data[col_index];
+        int size = data[_length + col_index];
 
-            return false;
+        if (offset < 0 || size < 0 ||
+            offset + static_cast<long long>(size) > _arena_capacity) {
+
+            return false; // not a valid entry (e.g. torn read)
         }
 
+        const char* arena = reinterpret_cast<const char*>(data + _n_index_rows * _length);
+
+        str.assign(arena + offset, size); // single memcpy
+
         return true;
 
     }
@@ -0,0 +1,455 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+//
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+//
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <thread>
+
+#include <sys/mman.h>
+
+#include <EigenIPC/SymbolTable.hpp>
+
+namespace EigenIPC {
+
+    // template specializations
+
+    // constructor specialization for Client
+    template <>
+    SymbolTable<StrClient>::SymbolTable(std::string basename,
+                                        std::string name_space,
+                                        bool verbose,
+                                        VLevel vlevel)
+    : _basename(basename),
+      _namespace(name_space),
+      _mutex_path("/" + name_space + basename + "_writers"),
+      _journal(Journal("SymbolTable")),
+      _strings(basename + "_strings", name_space,
+               verbose, vlevel,
+               true),
+      _index(basename + "_index", name_space,
+             verbose, vlevel,
+             true) {
+
+
+    }
+
+    // constructor specialization for Server
+    template <>
+    SymbolTable<StrServer>::SymbolTable(int capacity,
+                                        std::string basename,
+                                        std::string name_space,
+                                        bool verbose,
+                                        VLevel vlevel,
+                                        bool force_reconnection,
+                                        int arena_bytes)
+    : _capacity(capacity),
+      _n_buckets(_n_buckets_for(capacity)),
+      _is_server(true),
+      _force_reconnection(force_reconnection),
+      _basename(basename),
+      _namespace(name_space),
+      _mutex_path("/" + name_space + basename + "_writers"),
+      _journal(Journal("SymbolTable")),
+      _strings(capacity,
+               basename + "_strings", name_space,
+               verbose, vlevel,
+               force_reconnection,
+               true, // strings may also be written by clients
+               arena_bytes),
+      _index(2, _n_buckets + 1,
+             basename + "_index", name_space,
+             verbose, vlevel,
+             force_reconnection,
+             true) {
+
+        _init_buffers(); // we can initialize buffers
+
+    }
+
+    template <>
+    void SymbolTable<StrClient>::run() {
+
+        if (!_running) {
+
+            _strings.run(); // attaches
+
+            _index.attach();
+
+            _writers = std::make_unique<ConditionVariable::NamedMutex>(
+                        ConditionVariable::create_named_mutex(_mutex_path)); // the
+            // server's (which exists by now)
+
+            _capacity = _strings.getLength(); // getting from
+            // clients (which get this from the servers)
+
+            _n_buckets = _index.getNCols() - 1;
+
+            _init_buffers(); // we can now initialize the buffers
+
+            _running = true;
+        }
+
+    }
+
+    template <>
+    void SymbolTable<StrServer>::run() {
+
+        if (!_running) {
+
+            // before the tables are published, so that clients find the new mutex
+            if (_force_reconnection) {
+
+                shm_unlink(_mutex_path.c_str()); // clients of the old server keep theirs
+            }
+
+            _writers = std::make_unique<ConditionVariable::NamedMutex>(
+                        ConditionVariable::create_named_mutex(_mutex_path));
+
+            _strings.run();
+
+            _index.run();
+
+            _running = true;
+        }
+
+    }
+
+    template <>
+    void SymbolTable<StrServer>::close() {
+
+        if (!_running) {
+
+            return;
+        }
+
+        _strings.close();
+
+        _index.close();
+
+        // the mutex goes with the server, unless a newer one took over
+        if (!_writers->isUnlinked()) {
+
+            shm_unlink(_mutex_path.c_str());
+        }
+
+        _running = false;
+
+    }
+
+    template <>
+    void SymbolTable<StrClient>::close() {
+
+        _strings.close();
+
+        _index.close();
+
+        _running = false;
+
+    }
+
+    // class specialization
+    template class SymbolTable<StrServer>;
+    template class SymbolTable<StrClient>;
+
+    template <typename ShMemType>
+    SymbolTable<ShMemType>::~SymbolTable() {
+
+        close();
+
+    }
+
+    template <typename ShMemType>
+    int SymbolTable<ShMemType>::find(const std::string& str) {
+
+        if (!isRunning() || !_sync()) {
+
+            return -1;
+        }
+
+        int id = -1, bucket = -1;
+
+        _probe_for(str, _hash(str), id, bucket);
+
+        return id;
+
+    }
+
+    template <typename ShMemType>
+    int SymbolTable<ShMemType>::intern(const std::string& str) {
+
+        // (lock-free) fast path: already interned
+        int id = find(str);
+
+        if (id >= 0 || !isRunning()) {
+
+            return id;
+        }
+
+        ConditionVariable::ScopedLock lock(*_writers); // one interner at a time
+
+        if (!_sync()) { // someone may have added it in the meantime
+
+            return -1;
+        }
+
+        int hash = _hash(str);
+
+        int bucket = -1;
+
+        if (!_probe_for(str, hash, id, bucket) || id >= 0) {
+
+            return id; // -1 if we could not tell whether it's there
+        }
+
+        id = _buckets(0, 0); // next ID
+
+        if (id >= _capacity || bucket < 0) {
+
+            std::string error = std::string("Symbol table is full (") +
+                std::to_string(_capacity) + std::string(" symbols): could not intern ") +
+                str;
+
+            _journal.log(__FUNCTION__,
+                error,
+                Journal::LogType::WARN);
+
+            return -1;
+        }
+
+        // first the string, then its bucket (which makes it visible to
+        // lookups) and finally the count
+        if (!_retry([&]() { return _strings.write(str, id); })) {
+
+            return -1;
+        }
+
+        _buckets(0, bucket) = id + 1;
+        _buckets(1, bucket) = hash;
+        _buckets(0, 0) = id + 1;
+
+        bool success = _retry([&]() {
+                        return _index.write(_buckets.block(0, bucket, 2, 1), 0, bucket); }) &&
+                    _retry([&]() {
+                        return _index.write(_buckets.block(0, 0, 1, 1), 0, 0); });
+
+        if (!success) {
+
+            _synced = false; // our copy is not what's in the index
+
+            return -1;
+        }
+
+        // nobody else wrote the index since we synced (we hold the
+        // writers' lock) -> our copy is up to date
+        _synced_version = _index.getDataVersion();
+
+        return id;
+
+    }
+
+    template <typename ShMemType>
+    bool SymbolTable<ShMemType>::name(int id,
+                                      std::string& str) {
+
+        return isRunning() &&
+               id >= 0 && id < size() &&
+               _retry([&]() { return _strings.read(str, id); });
+
+    }
+
+    template <typename ShMemType>
+    int SymbolTable<ShMemType>::size() {
+
+        if (!isRunning() || !_sync()) {
+
+            return 0;
+        }
+
+        return _buckets(0, 0);
+
+    }
+
+    template <typename ShMemType>
+    int SymbolTable<ShMemType>::getCapacity() {
+
+        return _capacity;
+
+    }
+
+    template <typename ShMemType>
+    bool SymbolTable<ShMemType>::isRunning() {
+
+        return _running;
+
+    }
+
+    template <typename ShMemType>
+    bool SymbolTable<ShMemType>::isServer() {
+
+        return _is_server;
+
+    }
+
+    template <typename ShMemType>
+    std::string SymbolTable<ShMemType>::getNamespace() const {
+
+        return _namespace;
+
+    }
+
+    template <typename ShMemType>
+    std::string SymbolTable<ShMemType>::getBasename() const {
+
+        return _basename;
+
+    }
+
+    template <typename ShMemType>
+    int SymbolTable<ShMemType>::_n_buckets_for(int capacity) {
+
+        // load factor <= 0.5
+        int n_buckets = 2;
+
+        while (n_buckets < 2 * capacity) {
+
+            n_buckets *= 2;
+        }
+
+        return n_buckets;
+
+    }
+
+    template <typename ShMemType>
+    int SymbolTable<ShMemType>::_hash(const std::string& str) {
+
+        // FNV-1a
+        uint32_t hash = 2166136261u;
+
+        for (unsigned char c : str) {
+
+            hash = (hash ^ c) * 16777619u;
+        }
+
+        return static_cast<int>(hash & 0x7FFFFFFFu);
+
+    }
+
+    template <typename ShMemType>
+    bool SymbolTable<ShMemType>::_sync() {
+
+        // loaded before reading: if a write lands in between,
+        // we are just going to read again next time
+        uint64_t version = _index.getDataVersion();
+
+        if (_synced && version == _synced_version) {
+
+            return true; // nothing was interned since
+        }
+
+        if (!_retry([&]() { return _index.read(_buckets, 0, 0); })) {
+
+            return false;
+        }
+
+        _synced_version = version;
+        _synced = true;
+
+        return true;
+
+    }
+
+    template <typename ShMemType>
+    template <typename F>
+    bool SymbolTable<ShMemType>::_retry(F&& access) {
+
+        for (int i = 0; i < _max_retries; ++i) {
+
+            if (access()) {
+
+                return true;
+            }
+
+            std::this_thread::yield(); // busy (being accessed by someone else)
+        }
+
+        _journal.log(__FUNCTION__,
+            "Shared memory still busy after " + std::to_string(_max_retries) +
+            " attempts",
+            Journal::LogType::WARN);
+
+        return false;
+
+    }
+
+    template <typename ShMemType>
+    bool SymbolTable<ShMemType>::_probe_for(const std::string& str,
+                                            int hash,
+                                            int& id,
+                                            int& bucket) {
+
+        // linear probing (buckets are columns 1 to _n_buckets)
+        int mask = _n_buckets - 1;
+
+        int b = hash & mask;
+
+        id = -1;
+        bucket = -1;
+
+        for (int i = 0; i < _n_buckets; ++i) {
+
+            int candidate = _buckets(0, 1 + b) - 1;
+
+            if (candidate < 0) {
+
+                bucket = 1 + b; // empty: str is not there
+
+                return true;
+            }
+
+            if (_buckets(1, 1 + b) == hash) {
+
+                if (!_retry([&]() { return _strings.read(_probe, candidate); })) {
+
+                    return false;
+                }
+
+                if (_probe == str) {
+
+                    id = candidate;
+
+                    return true;
+                }
+
+            }
+
+            b = (b + 1) & mask;
+        }
+
+        return true; // no empty buckets (not reachable with capacity
+        // < _n_buckets)
+
+    }
+
+    template <typename ShMemType>
+    void SymbolTable<ShMemType>::_init_buffers() {
+
+        _buckets = Tensor<int>::Zero(2, _n_buckets + 1);
+
+        _synced = false;
+
+    }
+
+}
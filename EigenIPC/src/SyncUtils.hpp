@@ -0,0 +1,1584 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+//
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+//
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef SYNCUTILS_HPP
+#define SYNCUTILS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include <EigenIPC/DTypes.hpp>
+#include <EigenIPC/ReturnCodes.hpp>
+
+namespace EigenIPC{
+
+    namespace SyncUtils{
+
+        constexpr std::size_t CACHE_LINE = 64;
+
+        constexpr uint32_t HEADER_MAGIC = 0x45495043; // "EIPC"
+        constexpr uint32_t HEADER_VERSION = 4; // to be bumped at every change of MemHeader
+
+        constexpr int MAX_CLIENTS = 128; // per tensor (capacity of the client registry)
+        constexpr int CLIENT_MASK_WORDS = MAX_CLIENTS / 64;
+
+        constexpr long long REAP_PERIOD_NS = 100000000; // [ns] minimum period between
+        // scans for dead clients/consumers
+
+        // registry entry of an attached client, on its own cache line (heartbeats
+        // of different clients do not false-share)
+        struct alignas(CACHE_LINE) ClientSlot {
+
+            std::atomic<uint32_t> pid; // 0 while free (or being claimed)
+            std::atomic<uint64_t> start_time; // of the process (against PID reuse)
+            std::atomic<long long> heartbeat_ns; // last access (CLOCK_MONOTONIC_COARSE)
+
+        };
+
+        // metadata and synchronization state shared by all the processes accessing a tensor.
+        // It lives at the beginning of the (single) shared segment of the tensor, before the data
+        struct alignas(CACHE_LINE) MemHeader {
+
+            // written once by the server, before publishing the header (magic)
+            std::atomic<uint32_t> magic; // HEADER_MAGIC once the header is valid
+            uint32_t version; // HEADER_VERSION of the server
+
+            int dtype; // size of the scalar type
+            int mem_layout;
+
+            int n_rows;
+            int n_cols;
+
+            int sync_mode; // SyncMode chosen by the server
+
+            int n_stripes; // number of row stripes (SyncMode::Striped)
+            int rows_per_stripe;
+
+            int n_slots; // number of tensor copies (1 unless SyncMode::Ring)
+
+            uint64_t data_offset; // [bytes] from the segment start to the tensor data
+            uint64_t slot_stride; // [bytes] between consecutive tensor copies
+            uint64_t versions_offset; // [bytes] from the segment start to the row versions
+
+            // server/clients state
+            alignas(CACHE_LINE) std::atomic<int> is_running;
+            std::atomic<int> n_clients; // exact: updated together with the registry
+
+            // client registry: one bit per slot in use
+            alignas(CACHE_LINE) std::atomic<uint64_t> client_mask[CLIENT_MASK_WORDS];
+            ClientSlot clients[MAX_CLIENTS];
+
+            // data lock (futex word): 0 if free, otherwise the owner's PID,
+            // plus LOCK_WAITERS if someone might be sleeping on it
+            alignas(CACHE_LINE) std::atomic<uint32_t> lock;
+
+            // seqlock sequence counter (odd while a write is in progress).
+            // Kept on its own cache line so that polling readers do not
+            // false-share with the rest of the header
+            alignas(CACHE_LINE) std::atomic<uint64_t> seq;
+
+            // last published slot (SyncMode::Ring)
+            alignas(CACHE_LINE) std::atomic<int> latest;
+
+            // change notification (futex word): bumped after every write
+            alignas(CACHE_LINE) std::atomic<uint32_t> generation;
+            std::atomic<uint32_t> n_waiters; // processes that might be sleeping
+            // on generation (writers skip the wake syscall if there are none)
+
+            // version of the last write: each row records the version
+            // of the last write which touched it (see markRows())
+            alignas(CACHE_LINE) std::atomic<uint64_t> data_version;
+
+        };
+
+        static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                "64 bit atomics need to be lock-free to be shared between processes");
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                "the data lock is used as a futex word");
+
+        constexpr uint32_t LOCK_WAITERS = 1U << 31;
+
+        constexpr int LOCK_SPINS = 100; // spins before sleeping on a contended lock
+        constexpr long LOCK_CHECK_NS = 10000000; // [ns] period for checking if
+        // the owner of a contended lock is still alive
+
+        // one process-shared (unnamed) semaphore per row stripe, each on
+        // its own cache line. Stripes are stored right after the MemHeader
+        struct alignas(CACHE_LINE) Stripe {
+
+            sem_t sem;
+
+        };
+
+        // per-slot seqlock counter (SyncMode::Ring). Stored after the stripes
+        struct alignas(CACHE_LINE) Slot {
+
+            std::atomic<uint64_t> seq;
+
+        };
+
+        inline bool isHeaderReady(const MemHeader* header) {
+
+            return header->magic.load(std::memory_order_acquire) == HEADER_MAGIC;
+
+        }
+
+        inline void publishHeader(MemHeader* header) {
+
+            header->version = HEADER_VERSION;
+
+            // all the fields written before are visible to whoever sees the magic
+            header->magic.store(HEADER_MAGIC, std::memory_order_release);
+
+        }
+
+        inline std::size_t headerSize(int n_stripes = 0,
+                                int n_slots = 0,
+                                int n_rows = 0) {
+
+            // multiple of CACHE_LINE because of alignas
+            std::size_t size = sizeof(MemHeader) + n_stripes * sizeof(Stripe) +
+                    n_slots * sizeof(Slot);
+
+            // row versions are stored last (padded to a whole cache line)
+            std::size_t versions_size = n_rows * sizeof(std::atomic<uint64_t>);
+
+            return size + (versions_size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+
+        }
+
+        inline Stripe* stripes(MemHeader* header) {
+
+            return reinterpret_cast<Stripe*>(reinterpret_cast<char*>(header) +
+                        sizeof(MemHeader));
+
+        }
+
+        inline Slot* slots(MemHeader* header) {
+
+            return reinterpret_cast<Slot*>(stripes(header) + header->n_stripes);
+
+        }
+
+        inline std::atomic<uint64_t>* rowVersions(MemHeader* header) {
+
+            return reinterpret_cast<std::atomic<uint64_t>*>(
+                        reinterpret_cast<char*>(header) + header->versions_offset);
+
+        }
+
+        inline std::size_t slotStride(std::size_t data_size) {
+
+            // each copy starts on its own cache line
+            return (data_size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+
+        }
+
+        template <typename Scalar, int Layout>
+        MMap<Scalar, Layout> slotView(MemHeader* header,
+                                int slot,
+                                int n_rows, int n_cols) {
+
+            return MMap<Scalar, Layout>(reinterpret_cast<Scalar*>(
+                        reinterpret_cast<char*>(header) +
+                        header->data_offset + slot * header->slot_stride),
+                        n_rows, n_cols);
+
+        }
+
+        inline int rowsPerStripe(int n_rows, int n_stripes) {
+
+            return (n_rows + n_stripes - 1) / n_stripes; // ceil
+
+        }
+
+        inline void cpuRelax() {
+
+            #if defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+            #elif defined(__aarch64__)
+                asm volatile("yield" ::: "memory");
+            #else
+                std::atomic_signal_fence(std::memory_order_seq_cst);
+            #endif
+
+        }
+
+        // futex based data lock (robust to the death of its owner)
+
+        inline long futexWait(std::atomic<uint32_t>& word,
+                        uint32_t expected,
+                        const struct timespec* timeout) {
+
+            // not FUTEX_PRIVATE: the word is shared between processes
+            return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word),
+                        FUTEX_WAIT, expected, timeout, nullptr, 0);
+
+        }
+
+        inline long futexWake(std::atomic<uint32_t>& word,
+                        int n_waiters) {
+
+            return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word),
+                        FUTEX_WAKE, n_waiters, nullptr, nullptr, 0);
+
+        }
+
+        inline bool isOwnerAlive(uint32_t word) {
+
+            pid_t owner = static_cast<pid_t>(word & ~LOCK_WAITERS);
+
+            return owner == 0 || kill(owner, 0) == 0 || errno != ESRCH;
+
+        }
+
+        inline uint64_t procStartTime(uint32_t pid) {
+
+            // field 22 of /proc/<pid>/stat [clock ticks since boot]. 0 if not available
+            char path[32];
+
+            snprintf(path, sizeof(path), "/proc/%u/stat", pid);
+
+            int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+            if (fd == -1) {
+
+                return 0;
+            }
+
+            char buffer[1024];
+
+            ssize_t n = read(fd, buffer, sizeof(buffer) - 1);
+
+            close(fd);
+
+            if (n <= 0) {
+
+                return 0;
+            }
+
+            buffer[n] = '\0';
+
+            // the command name (field 2) may contain spaces and parentheses
+            const char* field = strrchr(buffer, ')');
+
+            for (int i = 2; field != nullptr && i < 22; ++i) {
+
+                field = strchr(field + 1, ' ');
+            }
+
+            return field != nullptr ? strtoull(field + 1, nullptr, 10) : 0;
+
+        }
+
+        inline bool isProcessAlive(uint32_t pid,
+                        uint64_t start_time) {
+
+            if (kill(static_cast<pid_t>(pid), 0) != 0 && errno == ESRCH) {
+
+                return false;
+            }
+
+            // a different process may have been given the same PID
+            uint64_t current = start_time != 0 ? procStartTime(pid) : 0;
+
+            return current == 0 || current == start_time;
+
+        }
+
+        inline bool lockRecover(std::atomic<uint32_t>& lock,
+                        uint32_t word,
+                        uint32_t pid,
+                        ReturnCode& return_code) {
+
+            // the owner died while holding the lock -> we inherit it (the data
+            // it was accessing may be left inconsistent)
+            if (!isOwnerAlive(word) &&
+                lock.compare_exchange_strong(word, pid | (word & LOCK_WAITERS),
+                        std::memory_order_acquire,
+                        std::memory_order_relaxed)) {
+
+                return_code = return_code + ReturnCode::LOCKOWNERDIED;
+
+                return true;
+
+            }
+
+            return false;
+
+        }
+
+        inline bool lockTry(std::atomic<uint32_t>& lock,
+                        uint32_t pid,
+                        ReturnCode& return_code) {
+
+            uint32_t word = 0;
+
+            // uncontended fast path: a single CAS, no syscalls
+            if (lock.compare_exchange_strong(word, pid,
+                        std::memory_order_acquire,
+                        std::memory_order_relaxed)) {
+
+                return true;
+            }
+
+            return lockRecover(lock, word, pid, return_code);
+
+        }
+
+        inline void lockAcquire(std::atomic<uint32_t>& lock,
+                        uint32_t pid,
+                        ReturnCode& return_code) {
+
+            uint32_t word = 0;
+
+            for (int i = 0; i < LOCK_SPINS; ++i) {
+
+                word = 0;
+
+                if (lock.load(std::memory_order_relaxed) == 0 &&
+                    lock.compare_exchange_weak(word, pid,
+                        std::memory_order_acquire,
+                        std::memory_order_relaxed)) {
+
+                    return;
+                }
+
+                cpuRelax();
+
+            }
+
+            const struct timespec check_period = {0, LOCK_CHECK_NS};
+
+            while (true) {
+
+                word = lock.load(std::memory_order_relaxed);
+
+                if (word == 0) {
+
+                    // others may still be sleeping -> we keep the flag so that
+                    // they are woken up on release
+                    if (lock.compare_exchange_weak(word, pid | LOCK_WAITERS,
+                            std::memory_order_acquire,
+                            std::memory_order_relaxed)) {
+
+                        return;
+                    }
+
+                    continue;
+
+                }
+
+                if (!(word & LOCK_WAITERS) &&
+                    !lock.compare_exchange_weak(word, word | LOCK_WAITERS,
+                            std::memory_order_relaxed,
+                            std::memory_order_relaxed)) {
+
+                    continue;
+                }
+
+                if (lockRecover(lock, word | LOCK_WAITERS, pid, return_code)) {
+
+                    return;
+                }
+
+                // sleeps until woken up by the owner or, periodically, to check on it
+                futexWait(lock, word | LOCK_WAITERS, &check_period);
+
+            }
+
+        }
+
+        inline void lockRelease(std::atomic<uint32_t>& lock) {
+
+            if (lock.exchange(0, std::memory_order_release) & LOCK_WAITERS) {
+
+                futexWake(lock, 1);
+            }
+
+        }
+
+        // generic futex wait on a counter (any number of waiters)
+
+        constexpr long WAIT_CHECK_NS = 10000000; // [ns] period for checking if
+        // whoever should wake us up is still there
+
+        inline long long nowNs() {
+
+            struct timespec now;
+
+            clock_gettime(CLOCK_MONOTONIC, &now); // immune to clock adjustments
+
+            return now.tv_sec * 1000000000LL + now.tv_nsec;
+
+        }
+
+        inline long long coarseNowNs() {
+
+            struct timespec now;
+
+            clock_gettime(CLOCK_MONOTONIC_COARSE, &now); // a few ns (tick resolution)
+
+            return now.tv_sec * 1000000000LL + now.tv_nsec;
+
+        }
+
+        // spin budgets (WaitPolicy)
+
+        constexpr long long SPIN_MAX_NS = 20000; // [ns] default maximum spin budget
+        constexpr long long SPIN_MIN_NS = 1000; // [ns] minimum spin budget (SpinThenBlock)
+        constexpr int SPIN_CHECK_PERIOD = 64; // spins between checks of the clock
+
+        inline long long spinBudget(WaitPolicy policy,
+                        long long max_spin_ns,
+                        double avg_wait_ns) {
+
+            // [ns] to spin before sleeping: 0 -> no spinning, < 0 -> spin only
+            switch (policy) {
+
+                case WaitPolicy::Block:
+                    return 0;
+
+                case WaitPolicy::Spin:
+                    return -1;
+
+                default:
+                    break;
+
+            }
+
+            // spinning only pays off if the wait is expected to end within the
+            // maximum budget: otherwise we would burn the CPU and sleep anyway
+            long long budget = std::max(static_cast<long long>(2.0 * avg_wait_ns),
+                                    SPIN_MIN_NS);
+
+            return budget <= max_spin_ns ? budget : 0;
+
+        }
+
+        inline void updateAvgWait(double& avg_wait_ns,
+                        long long wait_ns) {
+
+            // exponential moving average of the last (~8) waits
+            avg_wait_ns += 0.125 * (static_cast<double>(wait_ns) - avg_wait_ns);
+
+        }
+
+        template <typename Done, typename Alive>
+        inline bool futexWaitUntil(std::atomic<uint32_t>& word,
+                        std::atomic<uint32_t>& n_waiters,
+                        uint32_t& value,
+                        Done done, // done(value) -> stop waiting
+                        Alive alive, // !alive() -> give up
+                        int ms_timeout = -1, // < 0 -> no timeout
+                        long long spin_ns = 0) { // see spinBudget()
+
+            // fast path
+            value = word.load(std::memory_order_acquire);
+
+            if (done(value)) {
+
+                return true;
+            }
+
+            long long start_ns = nowNs();
+
+            long long deadline_ns = ms_timeout >= 0 ?
+                        start_ns + ms_timeout * 1000000LL : -1;
+
+            // spin phase. alive() may be a syscall (e.g. kill(pid, 0)): it is
+            // only checked every WAIT_CHECK_NS, as when sleeping (budgeted
+            // spins are shorter than that, so they usually never check it)
+            long long alive_check_ns = start_ns;
+
+            for (int i = 1; spin_ns != 0; ++i) {
+
+                cpuRelax();
+
+                value = word.load(std::memory_order_acquire);
+
+                if (done(value)) {
+
+                    return true;
+                }
+
+                if (i % SPIN_CHECK_PERIOD == 0) {
+
+                    long long now_ns = nowNs(); // (vDSO, no syscall)
+
+                    if (deadline_ns >= 0 && now_ns >= deadline_ns) {
+
+                        return false; // timeout
+                    }
+
+                    if (now_ns - alive_check_ns >= WAIT_CHECK_NS) {
+
+                        if (!alive()) {
+
+                            return false; // nothing is coming
+                        }
+
+                        alive_check_ns = now_ns;
+                    }
+
+                    if (spin_ns > 0 && now_ns - start_ns >= spin_ns) {
+
+                        break; // budget exhausted -> we sleep
+                    }
+
+                }
+
+            }
+
+            // seq_cst (with the waker's increment and load of n_waiters): either
+            // we see the new value or the waker sees us and issues the wake-up
+            n_waiters.fetch_add(1, std::memory_order_seq_cst);
+
+            bool success = false;
+
+            while (true) {
+
+                value = word.load(std::memory_order_seq_cst);
+
+                if (done(value)) {
+
+                    success = true;
+
+                    break;
+                }
+
+                if (!alive()) {
+
+                    break; // nothing is coming
+                }
+
+                // we wake up periodically anyway, since the waker
+                // might be gone without notifying us
+                struct timespec wait_time = {0, WAIT_CHECK_NS};
+
+                if (deadline_ns >= 0) {
+
+                    long long remaining_ns = deadline_ns - nowNs();
+
+                    if (remaining_ns <= 0) {
+
+                        break; // timeout
+                    }
+
+                    wait_time.tv_nsec = std::min<long long>(remaining_ns,
+                                            WAIT_CHECK_NS);
+
+                }
+
+                // returns immediately if the word is not value anymore
+                futexWait(word, value, &wait_time);
+
+            }
+
+            n_waiters.fetch_sub(1, std::memory_order_seq_cst);
+
+            return success;
+
+        }
+
+        inline void futexNotify(std::atomic<uint32_t>& word,
+                        std::atomic<uint32_t>& n_waiters,
+                        int n_wake = INT_MAX) {
+
+            // seq_cst: either the waiter sees the new value or we see the waiter
+            word.fetch_add(1, std::memory_order_seq_cst);
+
+            if (n_waiters.load(std::memory_order_seq_cst) > 0) {
+
+                futexWake(word, n_wake); // only if someone might be sleeping
+            }
+
+        }
+
+        // client registry (one slot per attached client)
+
+        inline int clientReap(MemHeader* header) {
+
+            // frees the slots of dead clients. Returns how many were found
+            int n_reaped = 0;
+
+            for (int w = 0; w < CLIENT_MASK_WORDS; ++w) {
+
+                uint64_t mask = header->client_mask[w].load(std::memory_order_acquire);
+
+                while (mask != 0) {
+
+                    int bit = __builtin_ctzll(mask);
+
+                    mask &= mask - 1;
+
+                    ClientSlot& slot = header->clients[w * 64 + bit];
+
+                    uint32_t pid = slot.pid.load(std::memory_order_acquire);
+
+                    // pid == 0 -> still being claimed. Only one reaper wins the exchange
+                    if (pid != 0 &&
+                        !isProcessAlive(pid, slot.start_time.load(std::memory_order_relaxed)) &&
+                        slot.pid.compare_exchange_strong(pid, 0, std::memory_order_acq_rel)) {
+
+                        header->client_mask[w].fetch_and(~(uint64_t(1) << bit),
+                                    std::memory_order_release);
+
+                        header->n_clients.fetch_sub(1, std::memory_order_acq_rel);
+
+                        n_reaped++;
+                    }
+
+                }
+
+            }
+
+            return n_reaped;
+
+        }
+
+        inline int clientClaimSlot(MemHeader* header,
+                        uint32_t pid,
+                        uint64_t start_time) {
+
+            // lowest free slot, otherwise one left behind by a dead client
+            for (int attempt = 0; attempt < 2; ++attempt) {
+
+                for (int w = 0; w < CLIENT_MASK_WORDS; ++w) {
+
+                    uint64_t mask = header->client_mask[w].load(std::memory_order_acquire);
+
+                    while (~mask != 0) {
+
+                        int bit = __builtin_ctzll(~mask);
+
+                        if (header->client_mask[w].compare_exchange_weak(mask,
+                                mask | (uint64_t(1) << bit),
+                                std::memory_order_acq_rel,
+                                std::memory_order_acquire)) {
+
+                            ClientSlot& slot = header->clients[w * 64 + bit];
+
+                            slot.start_time.store(start_time, std::memory_order_relaxed);
+                            slot.heartbeat_ns.store(coarseNowNs(), std::memory_order_relaxed);
+                            slot.pid.store(pid, std::memory_order_release); // slot complete
+
+                            header->n_clients.fetch_add(1, std::memory_order_acq_rel);
+
+                            return w * 64 + bit;
+                        }
+
+                    }
+
+                }
+
+                if (clientReap(header) == 0) {
+
+                    break;
+                }
+
+            }
+
+            return -1; // all slots taken by live clients
+
+        }
+
+        inline void clientReleaseSlot(MemHeader* header,
+                        int slot) {
+
+            header->clients[slot].pid.store(0, std::memory_order_relaxed);
+
+            header->client_mask[slot / 64].fetch_and(~(uint64_t(1) << (slot % 64)),
+                        std::memory_order_release);
+
+            header->n_clients.fetch_sub(1, std::memory_order_acq_rel);
+
+        }
+
+        inline void clientHeartbeat(MemHeader* header,
+                        int slot) {
+
+            header->clients[slot].heartbeat_ns.store(coarseNowNs(), std::memory_order_relaxed);
+
+        }
+
+        // change notification (any number of writers and waiters)
+
+        inline void notifyUpdate(MemHeader* header) {
+
+            futexNotify(header->generation, header->n_waiters);
+
+        }
+
+        inline void wakeWaiters(MemHeader* header) {
+
+            // no new data, but waiters re-check the state of the server
+            futexWake(header->generation, INT_MAX);
+
+        }
+
+        inline bool waitUpdate(MemHeader* header,
+                        uint32_t& last_generation,
+                        int ms_timeout = -1) {
+
+            uint32_t generation = last_generation;
+
+            bool updated = futexWaitUntil(header->generation,
+                            header->n_waiters,
+                            generation,
+                            [&](uint32_t value) { return value != last_generation; },
+                            [&]() { return header->is_running.load(
+                                        std::memory_order_acquire) > 0; },
+                            ms_timeout);
+
+            if (updated) {
+
+                last_generation = generation;
+            }
+
+            return updated;
+
+        }
+
+        // trigger/ack barrier between a producer and its consumers
+
+        constexpr uint32_t BARRIER_MAGIC = 0x45494242; // "EIBB"
+
+        constexpr int BARRIER_MAX_CONSUMERS = 64; // one bit each in the ack mask
+
+        // written by a single consumer (own cache line -> no false sharing on acks)
+        struct alignas(CACHE_LINE) BarrierSlot {
+
+            std::atomic<uint32_t> pid; // of the consumer holding the slot
+            std::atomic<uint64_t> start_time; // of its process (against PID reuse)
+            std::atomic<long long> ack_ns; // time of its last ack (CLOCK_MONOTONIC)
+            std::atomic<uint32_t> ack_epoch; // trigger its last ack refers to
+
+        };
+
+        // in its own shared segment
+        struct alignas(CACHE_LINE) Barrier {
+
+            std::atomic<uint32_t> magic; // BARRIER_MAGIC once initialized
+            std::atomic<uint32_t> owner; // PID of the producer
+            std::atomic<uint32_t> running; // 0 once the producer is closed
+
+            std::atomic<uint32_t> epoch; // incremented at every trigger (futex word)
+            std::atomic<uint32_t> epoch_waiters;
+
+            std::atomic<uint32_t> acks; // incremented at every ack (futex word)
+            std::atomic<uint32_t> ack_waiters;
+
+            // one bit per consumer slot
+            alignas(CACHE_LINE) std::atomic<uint64_t> registered; // slots in use
+            std::atomic<uint64_t> ack_mask; // slots which acked the current trigger
+            // (cleared by the producer at every trigger). Only bits whose slot's
+            // ack_epoch matches the epoch count (see barrierAcked())
+
+            std::atomic<long long> trigger_ns; // time of the last trigger (CLOCK_MONOTONIC)
+
+            BarrierSlot slots[BARRIER_MAX_CONSUMERS];
+
+        };
+
+        static_assert(sizeof(Barrier) == (2 + BARRIER_MAX_CONSUMERS) * CACHE_LINE,
+                "unexpected barrier layout");
+
+        inline bool isBarrierReady(const Barrier* barrier) {
+
+            return barrier->magic.load(std::memory_order_acquire) == BARRIER_MAGIC;
+
+        }
+
+        inline bool isBarrierAlive(const Barrier* barrier) {
+
+            return barrier->running.load(std::memory_order_acquire) > 0 &&
+                    isOwnerAlive(barrier->owner.load(std::memory_order_relaxed));
+
+        }
+
+        inline uint64_t barrierAcked(const Barrier* barrier,
+                        uint32_t epoch) {
+
+            // acks of the given trigger. A consumer acking a trigger which was
+            // superseded in the meantime may set its bit after the mask was
+            // cleared: such bits are stamped with an older epoch and ignored
+            // (and withdrawn right after by the consumer)
+            uint64_t acked = 0;
+
+            for (uint64_t bits = barrier->ack_mask.load(std::memory_order_seq_cst);
+                    bits != 0; bits &= bits - 1) {
+
+                int slot = __builtin_ctzll(bits);
+
+                if (barrier->slots[slot].ack_epoch.load(std::memory_order_acquire) == epoch) {
+
+                    acked |= uint64_t(1) << slot;
+                }
+
+            }
+
+            return acked;
+
+        }
+
+        inline int barrierReap(Barrier* barrier) {
+
+            // frees the slots of dead consumers (so that they are not waited for).
+            // Returns how many were found
+            int n_reaped = 0;
+
+            uint64_t registered = barrier->registered.load(std::memory_order_acquire);
+
+            while (registered != 0) {
+
+                int slot = __builtin_ctzll(registered);
+
+                registered &= registered - 1;
+
+                BarrierSlot& entry = barrier->slots[slot];
+
+                uint32_t pid = entry.pid.load(std::memory_order_acquire);
+
+                // pid == 0 -> still being claimed. Only one reaper wins the exchange
+                if (pid != 0 &&
+                    !isProcessAlive(pid, entry.start_time.load(std::memory_order_relaxed)) &&
+                    entry.pid.compare_exchange_strong(pid, 0, std::memory_order_acq_rel)) {
+
+                    barrier->registered.fetch_and(~(uint64_t(1) << slot),
+                                std::memory_order_release);
+
+                    n_reaped++;
+                }
+
+            }
+
+            return n_reaped;
+
+        }
+
+        inline int barrierClaimSlot(Barrier* barrier,
+                        uint32_t pid,
+                        uint64_t start_time) {
+
+            // lowest free slot, otherwise one left behind by a dead consumer
+            for (int attempt = 0; attempt < 2; ++attempt) {
+
+                uint64_t registered = barrier->registered.load(std::memory_order_acquire);
+
+                while (~registered != 0) {
+
+                    int slot = __builtin_ctzll(~registered);
+
+                    if (barrier->registered.compare_exchange_weak(registered,
+                            registered | (uint64_t(1) << slot),
+                            std::memory_order_acq_rel,
+                            std::memory_order_acquire)) {
+
+                        barrier->slots[slot].start_time.store(start_time, std::memory_order_relaxed);
+                        barrier->slots[slot].pid.store(pid, std::memory_order_release);
+
+                        return slot;
+                    }
+
+                }
+
+                if (barrierReap(barrier) == 0) {
+
+                    break;
+                }
+
+            }
+
+            return -1; // all slots taken by live consumers
+
+        }
+
+        inline void barrierReleaseSlot(Barrier* barrier,
+                        int slot) {
+
+            barrier->slots[slot].pid.store(0, std::memory_order_relaxed);
+
+            barrier->registered.fetch_and(~(uint64_t(1) << slot),
+                        std::memory_order_release);
+
+        }
+
+        // tensor payload carried by the barrier (TensorProducer/TensorConsumer): stored
+        // right after it, in the same segment. The producer fills the slot
+        // (epoch + 1) % n_slots and stamps it with that epoch before triggering
+        struct alignas(CACHE_LINE) TensorPayload {
+
+            int dtype; // DType of Scalar
+            int mem_layout;
+            int n_rows;
+            int n_cols;
+            int n_slots;
+
+            std::size_t slot_stride; // [bytes] between the data of consecutive slots
+
+        };
+
+        // epoch of the data in a slot (0 while it is being written)
+        struct alignas(CACHE_LINE) PayloadStamp {
+
+            std::atomic<uint32_t> epoch;
+
+        };
+
+        inline std::size_t payloadSize(int n_slots,
+                            std::size_t data_size) {
+
+            return sizeof(TensorPayload) + n_slots * sizeof(PayloadStamp) +
+                    n_slots * slotStride(data_size);
+
+        }
+
+        inline TensorPayload* barrierPayload(Barrier* barrier) {
+
+            return reinterpret_cast<TensorPayload*>(barrier + 1);
+
+        }
+
+        inline PayloadStamp* payloadStamps(TensorPayload* payload) {
+
+            return reinterpret_cast<PayloadStamp*>(payload + 1);
+
+        }
+
+        inline char* payloadData(TensorPayload* payload,
+                        int slot) {
+
+            return reinterpret_cast<char*>(payloadStamps(payload) + payload->n_slots) +
+                    slot * payload->slot_stride;
+
+        }
+
+        // bounded MPMC queue of fixed-shape tensors (TensorQueue). Each cell carries a
+        // sequence number which tells producers and consumers, racing on their own
+        // position counter, whose turn it is (D. Vyukov's bounded MPMC queue)
+
+        constexpr uint32_t QUEUE_MAGIC = 0x45495151; // "EIQQ"
+
+        struct alignas(CACHE_LINE) QueueHeader {
+
+            // written once by the creator, before publishing the header (magic)
+            std::atomic<uint32_t> magic; // QUEUE_MAGIC once initialized
+            std::atomic<uint32_t> owner; // PID of the creator
+            std::atomic<uint32_t> running; // 0 once the creator closed the queue
+
+            int dtype; // DType of Scalar
+            int mem_layout;
+            int n_rows;
+            int n_cols;
+            int capacity; // number of cells
+
+            std::size_t slot_stride; // [bytes] between the data of consecutive cells
+
+            // producers and consumers only contend among themselves
+            alignas(CACHE_LINE) std::atomic<uint64_t> enqueue_pos;
+            alignas(CACHE_LINE) std::atomic<uint64_t> dequeue_pos;
+
+            // futex words for blocking pushes/pops, bumped by every push (pop)
+            alignas(CACHE_LINE) std::atomic<uint32_t> pushes;
+            std::atomic<uint32_t> push_waiters; // consumers waiting for data
+            alignas(CACHE_LINE) std::atomic<uint32_t> pops;
+            std::atomic<uint32_t> pop_waiters; // producers waiting for room
+
+        };
+
+        struct alignas(CACHE_LINE) QueueCell {
+
+            std::atomic<uint64_t> seq; // == pos -> free for the push at pos,
+            // == pos + 1 -> holds the data pushed at pos
+
+        };
+
+        inline std::size_t queueSize(int capacity,
+                            std::size_t data_size) {
+
+            return sizeof(QueueHeader) + capacity * sizeof(QueueCell) +
+                    capacity * slotStride(data_size);
+
+        }
+
+        inline QueueCell* queueCells(QueueHeader* header) {
+
+            return reinterpret_cast<QueueCell*>(header + 1);
+
+        }
+
+        inline char* queueData(QueueHeader* header,
+                        int cell) {
+
+            return reinterpret_cast<char*>(queueCells(header) + header->capacity) +
+                    cell * header->slot_stride;
+
+        }
+
+        inline bool isQueueReady(const QueueHeader* header) {
+
+            return header->magic.load(std::memory_order_acquire) == QUEUE_MAGIC;
+
+        }
+
+        inline bool isQueueAlive(const QueueHeader* header) {
+
+            return header->running.load(std::memory_order_acquire) > 0 &&
+                    isOwnerAlive(header->owner.load(std::memory_order_relaxed));
+
+        }
+
+        inline bool queueClaimPush(QueueHeader* header,
+                        uint64_t& pos) {
+
+            // nonblocking: false if the queue is full
+            pos = header->enqueue_pos.load(std::memory_order_relaxed);
+
+            while (true) {
+
+                uint64_t seq = queueCells(header)[pos % header->capacity].seq.load(
+                                    std::memory_order_acquire);
+
+                int64_t diff = static_cast<int64_t>(seq - pos);
+
+                if (diff == 0) {
+
+                    if (header->enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                            std::memory_order_relaxed)) {
+
+                        return true; // the cell is ours
+                    }
+
+                } else if (diff < 0) {
+
+                    return false; // not popped yet since the last lap
+
+                } else {
+
+                    pos = header->enqueue_pos.load(std::memory_order_relaxed);
+                }
+
+            }
+
+        }
+
+        inline void queueCommitPush(QueueHeader* header,
+                        uint64_t pos) {
+
+            queueCells(header)[pos % header->capacity].seq.store(pos + 1,
+                                std::memory_order_release);
+
+            futexNotify(header->pushes, header->push_waiters, 1);
+
+        }
+
+        inline int queueClaimPop(QueueHeader* header,
+                        uint64_t& pos,
+                        int max_items) {
+
+            // nonblocking: claims up to max_items consecutive ready cells, which
+            // do not wrap around the end of the ring (contiguous in memory). Returns
+            // how many were claimed (0 if the queue is empty)
+            pos = header->dequeue_pos.load(std::memory_order_relaxed);
+
+            while (true) {
+
+                QueueCell* cells = queueCells(header);
+
+                int first = pos % header->capacity;
+                int max_n = std::min(max_items, header->capacity - first);
+
+                int n = 0;
+
+                while (n < max_n &&
+                    cells[first + n].seq.load(std::memory_order_acquire) == pos + n + 1) {
+
+                    ++n;
+                }
+
+                if (n == 0) {
+
+                    uint64_t seq = cells[first].seq.load(std::memory_order_acquire);
+
+                    if (static_cast<int64_t>(seq - (pos + 1)) < 0) {
+
+                        return 0; // not pushed yet
+                    }
+
+                    pos = header->dequeue_pos.load(std::memory_order_relaxed); // we are late
+
+                    continue;
+
+                }
+
+                if (header->dequeue_pos.compare_exchange_weak(pos, pos + n,
+                        std::memory_order_relaxed)) {
+
+                    return n; // the cells are ours
+                }
+
+            }
+
+        }
+
+        inline void queueCommitPop(QueueHeader* header,
+                        uint64_t pos,
+                        int n_items) {
+
+            QueueCell* cells = queueCells(header);
+
+            for (int i = 0; i < n_items; ++i) {
+
+                // free for the push one lap ahead
+                cells[(pos + i) % header->capacity].seq.store(pos + i + header->capacity,
+                                    std::memory_order_release);
+            }
+
+            futexNotify(header->pops, header->pop_waiters, n_items);
+
+        }
+
+        // single-writer broadcast ring (BroadcastRing): every reader sees every sample
+        // through its own cursor, and the writer never waits for readers. Each cell
+        // is a seqlock stamped with the sequence number of its sample (+ 1)
+
+        constexpr uint32_t BROADCAST_MAGIC = 0x45494252; // "EIBR"
+
+        struct alignas(CACHE_LINE) BroadcastHeader {
+
+            // written once by the writer, before publishing the header (magic)
+            std::atomic<uint32_t> magic; // BROADCAST_MAGIC once initialized
+            std::atomic<uint32_t> owner; // PID of the writer
+            std::atomic<uint32_t> running; // 0 once the writer is closed
+
+            int dtype; // DType of Scalar
+            int mem_layout;
+            int n_rows;
+            int n_cols;
+            int capacity; // number of cells
+
+            std::size_t slot_stride; // [bytes] between the data of consecutive cells
+
+            // sequence number of the next sample (i.e. number of samples written)
+            alignas(CACHE_LINE) std::atomic<uint64_t> head;
+
+            // futex word for blocking reads, bumped at every append
+            alignas(CACHE_LINE) std::atomic<uint32_t> appends;
+            std::atomic<uint32_t> n_waiters;
+
+        };
+
+        inline std::size_t broadcastSize(int capacity,
+                            std::size_t data_size) {
+
+            return sizeof(BroadcastHeader) + capacity * sizeof(Slot) +
+                    capacity * slotStride(data_size);
+
+        }
+
+        inline Slot* broadcastCells(BroadcastHeader* header) {
+
+            return reinterpret_cast<Slot*>(header + 1);
+
+        }
+
+        inline char* broadcastData(BroadcastHeader* header,
+                        int cell) {
+
+            return reinterpret_cast<char*>(broadcastCells(header) + header->capacity) +
+                    cell * header->slot_stride;
+
+        }
+
+        inline bool isBroadcastReady(const BroadcastHeader* header) {
+
+            return header->magic.load(std::memory_order_acquire) == BROADCAST_MAGIC;
+
+        }
+
+        inline bool isBroadcastAlive(const BroadcastHeader* header) {
+
+            return header->running.load(std::memory_order_acquire) > 0 &&
+                    isOwnerAlive(header->owner.load(std::memory_order_relaxed));
+
+        }
+
+        inline void broadcastWriteBegin(BroadcastHeader* header,
+                        uint64_t seq) {
+
+            // readers still copying the previous sample of the cell will notice
+            broadcastCells(header)[seq % header->capacity].seq.store(0,
+                                std::memory_order_relaxed);
+
+            // data stores cannot be reordered before the stamp is cleared
+            std::atomic_thread_fence(std::memory_order_release);
+
+        }
+
+        inline void broadcastWriteEnd(BroadcastHeader* header,
+                        uint64_t seq) {
+
+            broadcastCells(header)[seq % header->capacity].seq.store(seq + 1,
+                                std::memory_order_release);
+
+            header->head.store(seq + 1, std::memory_order_release);
+
+            futexNotify(header->appends, header->n_waiters);
+
+        }
+
+        inline bool broadcastReadBegin(BroadcastHeader* header,
+                        uint64_t seq) {
+
+            // false if the cell does not hold sample seq (anymore)
+            return broadcastCells(header)[seq % header->capacity].seq.load(
+                        std::memory_order_acquire) == seq + 1;
+
+        }
+
+        inline bool broadcastReadValidate(BroadcastHeader* header,
+                        uint64_t seq) {
+
+            // data loads cannot be reordered after the stamp check
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            return broadcastCells(header)[seq % header->capacity].seq.load(
+                        std::memory_order_relaxed) == seq + 1;
+
+        }
+
+        // process-shared mutex + condition variable (ConditionVariable), in a single segment
+
+        constexpr uint32_t CONDVAR_MAGIC = 0x45494356; // "EICV"
+
+        struct alignas(CACHE_LINE) CondVarState {
+
+            std::atomic<uint32_t> magic; // CONDVAR_MAGIC once initialized
+            std::atomic<uint32_t> owner; // PID of the server
+
+            // mutex (same futex lock as the tensors' data lock)
+            alignas(CACHE_LINE) std::atomic<uint32_t> mutex;
+
+            // futex word, bumped by every notification
+            alignas(CACHE_LINE) std::atomic<uint32_t> seq;
+            std::atomic<uint32_t> n_waiters;
+
+        };
+
+        inline bool isCondVarReady(const CondVarState* state) {
+
+            return state->magic.load(std::memory_order_acquire) == CONDVAR_MAGIC;
+
+        }
+
+        // dirty rows tracking
+
+        inline void markRows(MemHeader* header,
+                        int row, int n_rows) {
+
+            // to be called by writers after the data is written (and published, with
+            // SyncMode::Ring), while still holding the lock(s) protecting the rows
+            uint64_t version = header->data_version.load(std::memory_order_relaxed) + 1;
+
+            std::atomic<uint64_t>* versions = rowVersions(header);
+
+            for (int i = row; i < row + n_rows; ++i) {
+
+                versions[i].store(version, std::memory_order_relaxed);
+            }
+
+            // publishes the row versions. Writers of disjoint stripes may run concurrently
+            // (SyncMode::Striped) -> the version never goes back
+            uint64_t current = version - 1;
+
+            while (current < version &&
+                !header->data_version.compare_exchange_weak(current, version,
+                        std::memory_order_release,
+                        std::memory_order_relaxed)) {}
+
+        }
+
+        // seqlock (single writer at a time, any number of wait-free readers)
+
+        inline void seqWriteBegin(std::atomic<uint64_t>& seq) {
+
+            // odd value -> write in progress
+            seq.store(seq.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+
+            // data stores cannot be reordered before the odd seq is visible
+            std::atomic_thread_fence(std::memory_order_release);
+
+        }
+
+        inline void seqWriteEnd(std::atomic<uint64_t>& seq) {
+
+            // even value -> data is consistent again
+            seq.store(seq.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
+
+        }
+
+        inline bool seqReadBegin(const std::atomic<uint64_t>& seq,
+                        uint64_t& start,
+                        int max_spins) {
+
+            // waits (spinning) for any pending write to complete
+            for (int i = 0; i < max_spins; ++i) {
+
+                start = seq.load(std::memory_order_acquire);
+
+                if ((start & 1ULL) == 0) {
+
+                    return true;
+                }
+
+                cpuRelax();
+
+            }
+
+            return false; // writer never completed (or died mid-write)
+
+        }
+
+        inline bool seqReadValidate(const std::atomic<uint64_t>& seq,
+                        uint64_t start) {
+
+            // data loads cannot be reordered after the seq check
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            return seq.load(std::memory_order_relaxed) == start;
+
+        }
+
+        // runs copy_fun (the actual, non-synchronized, copy) until it observes
+        // a snapshot of the shared data which no write overlapped, without any syscall.
+        // copy_fun returns false on failure (e.g. out of bounds), in which case no retry happens
+        template <typename CopyFun>
+        bool seqRead(const std::atomic<uint64_t>& seq,
+                    CopyFun&& copy_fun,
+                    int max_retries,
+                    ReturnCode& return_code) {
+
+            uint64_t start = 0;
+
+            for (int i = 0; i < max_retries; ++i) {
+
+                if (!seqReadBegin(seq, start, max_retries)) {
+
+                    break;
+                }
+
+                if (!copy_fun()) {
+
+                    return false;
+                }
+
+                if (seqReadValidate(seq, start)) {
+
+                    return true;
+                }
+
+                cpuRelax();
+
+            }
+
+            return_code = return_code + ReturnCode::SEQREADFAIL;
+
+            return false;
+
+        }
+
+        // ring publication (N copies of the tensor: writers, serialized between
+        // them, fill the slot after the latest one and then publish it; readers
+        // copy from the latest published slot and never wait for writers. A read is retried
+        // only if the writer wraps around the whole ring while it is copying)
+
+        inline int ringNextSlot(const MemHeader* header) {
+
+            return (header->latest.load(std::memory_order_relaxed) + 1) %
+                    header->n_slots;
+
+        }
+
+        inline void ringPublish(MemHeader* header,
+                        int slot) {
+
+            header->latest.store(slot, std::memory_order_release);
+
+        }
+
+        inline bool ringReadBegin(MemHeader* header,
+                        int& slot,
+                        uint64_t& start) {
+
+            slot = header->latest.load(std::memory_order_acquire);
+
+            // the latest slot is never being written, unless the
+            // writer has already lapped us -> the caller should just move on to the new latest
+            return seqReadBegin(slots(header)[slot].seq, start, 1);
+
+        }
+
+        // copy_fun(slot) performs the actual copy out of the given slot
+        template <typename CopyFun>
+        bool ringRead(MemHeader* header,
+                    CopyFun&& copy_fun,
+                    int max_retries,
+                    ReturnCode& return_code) {
+
+            int slot = 0;
+            uint64_t start = 0;
+
+            for (int i = 0; i < max_retries; ++i) {
+
+                if (ringReadBegin(header, slot, start)) {
+
+                    if (!copy_fun(slot)) {
+
+                        return false;
+                    }
+
+                    if (seqReadValidate(slots(header)[slot].seq, start)) {
+
+                        return true;
+                    }
+
+                }
+
+                cpuRelax();
+
+            }
+
+            return_code = return_code + ReturnCode::SEQREADFAIL;
+
+            return false;
+
+        }
+
+        // striped locking (only the stripes touched by a block are acquired, in
+        // increasing order so that concurrent multi-stripe acquisitions cannot deadlock)
+
+        inline bool initStripes(MemHeader* header,
+                        int n_stripes,
+                        int n_rows,
+                        ReturnCode& return_code) {
+
+            header->n_stripes = n_stripes;
+            header->rows_per_stripe = rowsPerStripe(n_rows, n_stripes);
+
+            Stripe* stripe = stripes(header);
+
+            for (int i = 0; i < n_stripes; ++i) {
+
+                if (sem_init(&stripe[i].sem, 1, 1) == -1) { // shared between processes
+
+                    return_code = return_code + ReturnCode::SEMOPENFAIL;
+
+                    return false;
+                }
+
+            }
+
+            return_code = return_code + ReturnCode::SEMOPEN;
+
+            return true;
+
+        }
+
+        inline void stripeRange(const MemHeader* header,
+                        int row, int n_rows,
+                        int& first, int& last) {
+
+            // out of bounds blocks are caught later by the bound checks on
+            // the data, here we just avoid touching non existing stripes
+            first = std::max(0, std::min(row / header->rows_per_stripe,
+                            header->n_stripes - 1));
+            last = std::max(first, std::min((row + std::max(n_rows, 1) - 1) / header->rows_per_stripe,
+                            header->n_stripes - 1));
+
+        }
+
+        inline void releaseStripes(MemHeader* header,
+                        int first, int last,
+                        ReturnCode& return_code) {
+
+            Stripe* stripe = stripes(header);
+
+            for (int i = last; i >= first; --i) {
+
+                if (sem_post(&stripe[i].sem) == -1) {
+
+                    return_code = return_code + ReturnCode::SEMRELFAIL;
+                }
+
+            }
+
+        }
+
+        inline bool acquireStripes(MemHeader* header,
+                        int first, int last,
+                        bool blocking,
+                        ReturnCode& return_code) {
+
+            Stripe* stripe = stripes(header);
+
+            return_code = return_code + ReturnCode::SEMACQTRY;
+
+            for (int i = first; i <= last; ++i) {
+
+                int result = blocking ? sem_wait(&stripe[i].sem) :
+                            sem_trywait(&stripe[i].sem);
+
+                if (result == -1) {
+
+                    // giving back what we got so far
+                    releaseStripes(header, first, i - 1, return_code);
+
+                    return_code = return_code + ReturnCode::SEMACQFAIL;
+
+                    return false;
+
+                }
+
+            }
+
+            return_code = return_code + ReturnCode::SEMACQ;
+
+            return true;
+
+        }
+
+    }
+
+}
+
+#endif // SYNCUTILS_HPP
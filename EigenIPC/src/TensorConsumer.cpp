@@ -0,0 +1,180 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+// 
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+// 
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+// 
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <EigenIPC/TensorConsumer.hpp>
+
+// private headers
+#include <MemUtils.hpp>
+#include <SyncUtils.hpp>
+
+namespace EigenIPC {
+
+    template <typename Scalar, int Layout>
+    TensorConsumer<Scalar, Layout>::TensorConsumer(std::string basename,
+                std::string name_space,
+                bool verbose,
+                VLevel vlevel)
+        : Consumer(basename, name_space,
+                verbose, vlevel),
+        _data_view(nullptr, 0, 0)
+    {
+
+    }
+
+    template <typename Scalar, int Layout>
+    void TensorConsumer<Scalar, Layout>::run() {
+
+        if (!_is_running) {
+
+            Consumer::run();
+
+            _open_payload();
+
+        }
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool TensorConsumer<Scalar, Layout>::wait(int ms_timeout) {
+
+        if (!Consumer::wait(ms_timeout)) {
+
+            return false;
+        }
+
+        uint32_t epoch = _internal_trigger_counter;
+
+        _data_slot = epoch % _payload->n_slots;
+
+        if (SyncUtils::payloadStamps(_payload)[_data_slot].epoch.load(
+                std::memory_order_acquire) != epoch) {
+
+            _journal.log(__FUNCTION__+_unique_id,
+                "No data was published with this trigger (or it was already overwritten)!",
+                LogType::EXCEP,
+                false); // do not throw exception
+
+            return false;
+
+        }
+
+        new (&_data_view) CMMap<Scalar, Layout>(reinterpret_cast<const Scalar*>(
+                    SyncUtils::payloadData(_payload, _data_slot)),
+                    _n_rows, _n_cols);
+
+        return true;
+
+    }
+
+    template <typename Scalar, int Layout>
+    const CMMap<Scalar, Layout>& TensorConsumer<Scalar, Layout>::data() const {
+
+        return _data_view;
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool TensorConsumer<Scalar, Layout>::isValid() {
+
+        _check_running(std::string(__FUNCTION__));
+
+        // reads of the data cannot be reordered after the stamp check
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        return SyncUtils::payloadStamps(_payload)[_data_slot].epoch.load(
+                    std::memory_order_relaxed) == _internal_trigger_counter;
+
+    }
+
+    template <typename Scalar, int Layout>
+    int TensorConsumer<Scalar, Layout>::getNRows() {
+
+        return _n_rows;
+    }
+
+    template <typename Scalar, int Layout>
+    int TensorConsumer<Scalar, Layout>::getNCols() {
+
+        return _n_cols;
+    }
+
+    template <typename Scalar, int Layout>
+    void TensorConsumer<Scalar, Layout>::_open_payload() {
+
+        std::string error;
+
+        if (_mem_size < sizeof(SyncUtils::Barrier) + sizeof(SyncUtils::TensorPayload)) {
+
+            error = "The producer does not carry a tensor (not a TensorProducer)";
+
+        } else {
+
+            _payload = SyncUtils::barrierPayload(_barrier);
+
+            if (_payload->dtype != static_cast<int>(CppTypeToDType<Scalar>::value)) {
+
+                error = std::string("TensorConsumer initialized with data type ") +
+                        MemUtils::getDTypeName(static_cast<int>(CppTypeToDType<Scalar>::value)) +
+                        std::string(", while the TensorProducer was initialized with ") +
+                        MemUtils::getDTypeName(_payload->dtype);
+
+            } else if (_payload->mem_layout != Layout) {
+
+                error = "Memory layout is not consistent with the one of the TensorProducer";
+
+            } else if (_mem_size < sizeof(SyncUtils::Barrier) +
+                    SyncUtils::payloadSize(_payload->n_slots,
+                                _payload->n_rows * _payload->n_cols * sizeof(Scalar))) {
+
+                error = "The shared segment is too small for the advertised tensor";
+
+            }
+
+        }
+
+        if (!error.empty()) {
+
+            close();
+
+            _journal.log(__FUNCTION__+_unique_id,
+                error,
+                LogType::EXCEP,
+                true); // throw exception
+
+        }
+
+        _n_rows = _payload->n_rows;
+        _n_cols = _payload->n_cols;
+
+        _data_slot = 0;
+
+        new (&_data_view) CMMap<Scalar, Layout>(nullptr, 0, 0); // nothing received yet
+
+    }
+
+    // explicit instantiations for specific supported types
+    // and layouts
+    template class TensorConsumer<double, ColMajor>;
+    template class TensorConsumer<float, ColMajor>;
+    template class TensorConsumer<int, ColMajor>;
+    template class TensorConsumer<bool, ColMajor>;
+
+    template class TensorConsumer<double, RowMajor>;
+    template class TensorConsumer<float, RowMajor>;
+    template class TensorConsumer<int, RowMajor>;
+    template class TensorConsumer<bool, RowMajor>;
+}
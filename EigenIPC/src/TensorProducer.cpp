@@ -0,0 +1,174 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+// 
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+// 
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+// 
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <EigenIPC/TensorProducer.hpp>
+
+// private headers
+#include <SyncUtils.hpp>
+#include <CopyUtils.hpp>
+
+namespace EigenIPC {
+
+    template <typename Scalar, int Layout>
+    TensorProducer<Scalar, Layout>::TensorProducer(int n_rows,
+                int n_cols,
+                std::string basename,
+                std::string name_space,
+                bool verbose,
+                VLevel vlevel,
+                bool force_reconnection,
+                int n_slots)
+        : Producer(basename, name_space,
+                verbose, vlevel,
+                force_reconnection),
+        _n_rows(n_rows),
+        _n_cols(n_cols),
+        _n_slots(n_slots)
+    {
+
+        if (_n_rows <= 0 || _n_cols <= 0 || _n_slots < 2) {
+
+            _journal.log(__FUNCTION__+_unique_id,
+                "Invalid tensor size or number of slots (at least 2 are needed)",
+                LogType::EXCEP,
+                true); // throw exception
+
+        }
+
+    }
+
+    template <typename Scalar, int Layout>
+    MMap<Scalar, Layout> TensorProducer<Scalar, Layout>::next() {
+
+        _check_running(std::string(__FUNCTION__));
+
+        if (_next_slot < 0) {
+
+            // we are the only ones incrementing the epoch
+            uint32_t epoch = _barrier->epoch.load(std::memory_order_relaxed) + 1;
+
+            _next_slot = epoch % _n_slots;
+
+            SyncUtils::PayloadStamp& stamp = SyncUtils::payloadStamps(_payload)[_next_slot];
+
+            // consumers still viewing the slot will see it invalidated
+            stamp.epoch.store(0, std::memory_order_relaxed);
+
+            // data stores cannot be reordered before the stamp is cleared
+            std::atomic_thread_fence(std::memory_order_release);
+
+        }
+
+        return MMap<Scalar, Layout>(reinterpret_cast<Scalar*>(
+                    SyncUtils::payloadData(_payload, _next_slot)),
+                    _n_rows, _n_cols);
+
+    }
+
+    template <typename Scalar, int Layout>
+    void TensorProducer<Scalar, Layout>::publish() {
+
+        _check_running(std::string(__FUNCTION__));
+
+        if (_next_slot < 0) {
+
+            _journal.log(__FUNCTION__+_unique_id,
+                "Nothing to publish. Did you call the next() method?",
+                LogType::EXCEP,
+                true); // throw exception
+
+        }
+
+        uint32_t epoch = _barrier->epoch.load(std::memory_order_relaxed) + 1;
+
+        // the data belongs to the trigger which is about to be issued
+        SyncUtils::payloadStamps(_payload)[_next_slot].epoch.store(epoch,
+                                std::memory_order_release);
+
+        _next_slot = -1;
+
+        trigger();
+
+    }
+
+    template <typename Scalar, int Layout>
+    void TensorProducer<Scalar, Layout>::publish(const TRef<Scalar, Layout> data) {
+
+        if (data.rows() != _n_rows || data.cols() != _n_cols) {
+
+            _journal.log(__FUNCTION__+_unique_id,
+                "Data size does not match the one of the shared tensor",
+                LogType::EXCEP,
+                true); // throw exception
+
+        }
+
+        CopyUtils::copy(next(), data, true);
+
+        publish();
+
+    }
+
+    template <typename Scalar, int Layout>
+    int TensorProducer<Scalar, Layout>::getNRows() {
+
+        return _n_rows;
+    }
+
+    template <typename Scalar, int Layout>
+    int TensorProducer<Scalar, Layout>::getNCols() {
+
+        return _n_cols;
+    }
+
+    template <typename Scalar, int Layout>
+    std::size_t TensorProducer<Scalar, Layout>::_payload_size() {
+
+        return SyncUtils::payloadSize(_n_slots,
+                    _n_rows * _n_cols * sizeof(Scalar));
+
+    }
+
+    template <typename Scalar, int Layout>
+    void TensorProducer<Scalar, Layout>::_init_payload(void* payload) {
+
+        // memory is zero-initialized by ftruncate (all slots unstamped)
+        _payload = new (payload) SyncUtils::TensorPayload;
+
+        _payload->dtype = static_cast<int>(CppTypeToDType<Scalar>::value);
+        _payload->mem_layout = Layout;
+        _payload->n_rows = _n_rows;
+        _payload->n_cols = _n_cols;
+        _payload->n_slots = _n_slots;
+        _payload->slot_stride = SyncUtils::slotStride(_n_rows * _n_cols * sizeof(Scalar));
+
+        _next_slot = -1;
+
+    }
+
+    // explicit instantiations for specific supported types
+    // and layouts
+    template class TensorProducer<double, ColMajor>;
+    template class TensorProducer<float, ColMajor>;
+    template class TensorProducer<int, ColMajor>;
+    template class TensorProducer<bool, ColMajor>;
+
+    template class TensorProducer<double, RowMajor>;
+    template class TensorProducer<float, RowMajor>;
+    template class TensorProducer<int, RowMajor>;
+    template class TensorProducer<bool, RowMajor>;
+}
@@ -0,0 +1,649 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+// 
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+// 
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+// 
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <EigenIPC/TensorQueue.hpp>
+
+// private headers
+#include <MemUtils.hpp>
+#include <SyncUtils.hpp>
+#include <CopyUtils.hpp>
+
+namespace EigenIPC {
+
+    template <typename Scalar, int Layout>
+    CMMap<Scalar, Layout> TensorQueue<Scalar, Layout>::Batch::data(int i) const {
+
+        return CMMap<Scalar, Layout>(_queue->_cellView(_pos + i).data(),
+                    _queue->_n_rows, _queue->_n_cols);
+
+    }
+
+    template <typename Scalar, int Layout>
+    void TensorQueue<Scalar, Layout>::Batch::release() {
+
+        if (_isValid()) { // the queue's memory may be gone otherwise
+
+            _queue->_commitPop(_pos, _n_items);
+        }
+
+        _queue = nullptr;
+
+        _queue_open.reset();
+
+    }
+
+    template <typename Scalar, int Layout>
+    TensorQueue<Scalar, Layout>::TensorQueue(std::string basename,
+                std::string name_space,
+                bool verbose,
+                VLevel vlevel)
+        : _verbose(verbose),
+        _basename(basename),
+        _namespace(name_space),
+        _unique_id(std::string("->")+ basename+std::string("-")+name_space),
+        _vlevel(vlevel),
+        _journal(Journal(_getThisName())),
+        _mem_config(basename + QUEUE_BASENAME, name_space)
+    {
+
+    }
+
+    template <typename Scalar, int Layout>
+    TensorQueue<Scalar, Layout>::~TensorQueue() {
+
+        close();
+    }
+
+    template <typename Scalar, int Layout>
+    void TensorQueue<Scalar, Layout>::create(int n_rows,
+                int n_cols,
+                int capacity,
+                bool force_reconnection) {
+
+        if (_is_running) {
+
+            return;
+        }
+
+        if (n_rows <= 0 || n_cols <= 0 || capacity <= 0) {
+
+            _journal.log(__FUNCTION__+_unique_id,
+                "Invalid tensor size or capacity",
+                LogType::EXCEP,
+                true); // throw exception
+
+        }
+
+        _return_code = _return_code + ReturnCode::RESET;
+
+        // an already existing queue is either stale or owned by someone else
+        int other_fd = -1;
+        std::size_t other_size = 0;
+
+        void* other_mem = MemUtils::openMem(_mem_config.mem_path,
+                            other_fd,
+                            other_size,
+                            _journal,
+                            _return_code,
+                            false,
+                            _vlevel);
+
+        if (other_mem != nullptr) {
+
+            SyncUtils::QueueHeader* other = static_cast<SyncUtils::QueueHeader*>(other_mem);
+
+            if (other_size >= sizeof(SyncUtils::QueueHeader) &&
+                SyncUtils::isQueueReady(other) &&
+                SyncUtils::isQueueAlive(other)) {
+
+                if (!force_reconnection) {
+
+                    MemUtils::unmapMem(other_mem, other_size, other_fd);
+
+                    _journal.log(__FUNCTION__+_unique_id,
+                        "A queue already exists at " + _mem_config.mem_path +
+                        ". Use force_reconnection to take over.",
+                        LogType::EXCEP,
+                        true); // throw exception
+
+                }
+
+                // whoever is waiting on the old queue gives up
+                other->running.store(0, std::memory_order_release);
+
+                SyncUtils::futexWake(other->pushes, INT_MAX);
+                SyncUtils::futexWake(other->pops, INT_MAX);
+
+            }
+
+            MemUtils::unmapMem(other_mem, other_size, other_fd);
+
+            shm_unlink(_mem_config.mem_path.c_str());
+
+        }
+
+        _return_code = _return_code + ReturnCode::RESET;
+
+        std::size_t data_size = n_rows * n_cols * sizeof(Scalar);
+
+        _mem_size = SyncUtils::queueSize(capacity, data_size);
+
+        void* mem = MemUtils::initRawMem(_mem_size,
+                            _mem_config.mem_path,
+                            _shm_fd,
+                            _journal,
+                            _return_code,
+                            _verbose,
+                            _vlevel);
+
+        if (mem == nullptr) {
+
+            MemUtils::failWithCode(_return_code,
+                                _journal,
+                                __FUNCTION__,
+                                _mem_config.mem_path);
+        }
+
+        // memory is zero-initialized by ftruncate
+        _header = new (mem) SyncUtils::QueueHeader;
+
+        _header->owner.store(static_cast<uint32_t>(getpid()), std::memory_order_relaxed);
+        _header->running.store(1, std::memory_order_relaxed);
+
+        _header->dtype = static_cast<int>(CppTypeToDType<Scalar>::value);
+        _header->mem_layout = Layout;
+        _header->n_rows = n_rows;
+        _header->n_cols = n_cols;
+        _header->capacity = capacity;
+        _header->slot_stride = SyncUtils::slotStride(data_size);
+
+        _header->enqueue_pos.store(0, std::memory_order_relaxed);
+        _header->dequeue_pos.store(0, std::memory_order_relaxed);
+
+        SyncUtils::QueueCell* cells = SyncUtils::queueCells(_header);
+
+        for (int i = 0; i < capacity; ++i) {
+
+            cells[i].seq.store(i, std::memory_order_relaxed); // free for the first lap
+        }
+
+        // producers and consumers can now use it
+        _header->magic.store(SyncUtils::QUEUE_MAGIC, std::memory_order_release);
+
+        _n_rows = n_rows;
+        _n_cols = n_cols;
+        _capacity = capacity;
+
+        _is_owner = true;
+        _is_running = true;
+
+        _open = std::make_shared<bool>(true);
+
+        if (_verbose &&
+            _vlevel > VLevel::V1) {
+
+            _journal.log(__FUNCTION__+_unique_id,
+                "Created queue at " + _mem_config.mem_path,
+                LogType::STAT);
+
+        }
+
+    }
+
+    template <typename Scalar, int Layout>
+    void TensorQueue<Scalar, Layout>::attach() {
+
+        if (_is_running) {
+
+            return;
+        }
+
+        int msg_counter = 0;
+
+        while (!_openQueue()) {
+
+            if (_verbose &&
+                _vlevel > VLevel::V0 &&
+                msg_counter % 4000 == 0) {
+
+                // only log every now and then
+                _journal.log(__FUNCTION__+_unique_id,
+                    "Waiting for the queue to be created...",
+                    LogType::WARN);
+
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1)); // no busy wait
+
+            msg_counter++;
+
+        }
+
+        std::string error;
+
+        if (_header->dtype != static_cast<int>(CppTypeToDType<Scalar>::value)) {
+
+            error = std::string("TensorQueue attached with data type ") +
+                    MemUtils::getDTypeName(static_cast<int>(CppTypeToDType<Scalar>::value)) +
+                    std::string(", while it was created with ") +
+                    MemUtils::getDTypeName(_header->dtype);
+
+        } else if (_header->mem_layout != Layout) {
+
+            error = "Memory layout is not consistent with the one of the queue creator";
+
+        } else if (_mem_size < SyncUtils::queueSize(_header->capacity,
+                    _header->n_rows * _header->n_cols * sizeof(Scalar))) {
+
+            error = "The shared segment is too small for the advertised queue";
+
+        }
+
+        if (!error.empty()) {
+
+            MemUtils::unmapMem(_header, _mem_size, _shm_fd);
+
+            _header = nullptr;
+
+            _journal.log(__FUNCTION__+_unique_id,
+                error,
+                LogType::EXCEP,
+                true); // throw exception
+
+        }
+
+        _n_rows = _header->n_rows;
+        _n_cols = _header->n_cols;
+        _capacity = _header->capacity;
+
+        _is_owner = false;
+        _is_running = true;
+
+        _open = std::make_shared<bool>(true);
+
+    }
+
+    template <typename Scalar, int Layout>
+    void TensorQueue<Scalar, Layout>::close() {
+
+        if (!_is_running) {
+
+            return;
+        }
+
+        *_open = false; // outstanding batches are invalidated
+
+        _open.reset();
+
+        if (_is_owner) {
+
+            // whoever is waiting gives up
+            _header->running.store(0, std::memory_order_release);
+
+            SyncUtils::futexWake(_header->pushes, INT_MAX);
+            SyncUtils::futexWake(_header->pops, INT_MAX);
+
+        }
+
+        bool taken_over = MemUtils::isUnlinked(_shm_fd); // by another
+        // creator (force_reconnection)
+
+        MemUtils::unmapMem(_header, _mem_size, _shm_fd);
+
+        if (_is_owner && !taken_over) {
+
+            shm_unlink(_mem_config.mem_path.c_str());
+        }
+
+        _header = nullptr;
+
+        _is_running = false;
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool TensorQueue<Scalar, Layout>::isRunning() {
+
+        return _is_running && SyncUtils::isQueueAlive(_header);
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool TensorQueue<Scalar, Layout>::tryPush(const TRef<Scalar, Layout> data) {
+
+        _checkRunning(std::string(__FUNCTION__));
+
+        _checkSize(data.rows(), data.cols(), std::string(__FUNCTION__));
+
+        uint64_t pos = 0;
+
+        if (!SyncUtils::queueClaimPush(_header, pos)) {
+
+            return false;
+        }
+
+        CopyUtils::copy(_cellView(pos), data, true);
+
+        SyncUtils::queueCommitPush(_header, pos);
+
+        return true;
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool TensorQueue<Scalar, Layout>::push(const TRef<Scalar, Layout> data,
+                int ms_timeout) {
+
+        _checkRunning(std::string(__FUNCTION__));
+
+        _checkSize(data.rows(), data.cols(), std::string(__FUNCTION__));
+
+        uint64_t pos = 0;
+        uint32_t pops = 0;
+
+        long long start_ns = SyncUtils::nowNs();
+
+        // every pop bumps the futex word
+        bool claimed = SyncUtils::futexWaitUntil(_header->pops,
+                            _header->pop_waiters,
+                            pops,
+                            [&](uint32_t) { return SyncUtils::queueClaimPush(_header, pos); },
+                            [&]() { return SyncUtils::isQueueAlive(_header); },
+                            ms_timeout,
+                            SyncUtils::spinBudget(_wait_policy, _max_spin_ns, _avg_wait_ns));
+
+        if (!claimed) {
+
+            return false;
+        }
+
+        SyncUtils::updateAvgWait(_avg_wait_ns, SyncUtils::nowNs() - start_ns);
+
+        CopyUtils::copy(_cellView(pos), data, true);
+
+        SyncUtils::queueCommitPush(_header, pos);
+
+        return true;
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool TensorQueue<Scalar, Layout>::tryPop(TRef<Scalar, Layout> output) {
+
+        _checkRunning(std::string(__FUNCTION__));
+
+        _checkSize(output.rows(), output.cols(), std::string(__FUNCTION__));
+
+        uint64_t pos = 0;
+
+        if (SyncUtils::queueClaimPop(_header, pos, 1) == 0) {
+
+            return false;
+        }
+
+        CopyUtils::copy(output, _cellView(pos));
+
+        _commitPop(pos, 1);
+
+        return true;
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool TensorQueue<Scalar, Layout>::pop(TRef<Scalar, Layout> output,
+                int ms_timeout) {
+
+        _checkRunning(std::string(__FUNCTION__));
+
+        _checkSize(output.rows(), output.cols(), std::string(__FUNCTION__));
+
+        uint64_t pos = 0;
+        uint32_t pushes = 0;
+
+        long long start_ns = SyncUtils::nowNs();
+
+        // every push bumps the futex word
+        bool claimed = SyncUtils::futexWaitUntil(_header->pushes,
+                            _header->push_waiters,
+                            pushes,
+                            [&](uint32_t) { return SyncUtils::queueClaimPop(_header, pos, 1) > 0; },
+                            [&]() { return SyncUtils::isQueueAlive(_header); },
+                            ms_timeout,
+                            SyncUtils::spinBudget(_wait_policy, _max_spin_ns, _avg_wait_ns));
+
+        if (!claimed) {
+
+            return false;
+        }
+
+        SyncUtils::updateAvgWait(_avg_wait_ns, SyncUtils::nowNs() - start_ns);
+
+        CopyUtils::copy(output, _cellView(pos));
+
+        _commitPop(pos, 1);
+
+        return true;
+
+    }
+
+    template <typename Scalar, int Layout>
+    typename TensorQueue<Scalar, Layout>::Batch TensorQueue<Scalar, Layout>::tryPopBatch(
+                int max_items) {
+
+        _checkRunning(std::string(__FUNCTION__));
+
+        Batch batch;
+
+        if (max_items > 0) {
+
+            batch._n_items = SyncUtils::queueClaimPop(_header, batch._pos, max_items);
+
+            if (batch._n_items > 0) {
+
+                batch._queue = this;
+                batch._queue_open = _open;
+            }
+
+        }
+
+        return batch;
+
+    }
+
+    template <typename Scalar, int Layout>
+    typename TensorQueue<Scalar, Layout>::Batch TensorQueue<Scalar, Layout>::popBatch(
+                int max_items,
+                int ms_timeout) {
+
+        _checkRunning(std::string(__FUNCTION__));
+
+        Batch batch;
+
+        if (max_items <= 0) {
+
+            return batch;
+        }
+
+        uint32_t pushes = 0;
+
+        long long start_ns = SyncUtils::nowNs();
+
+        bool claimed = SyncUtils::futexWaitUntil(_header->pushes,
+                            _header->push_waiters,
+                            pushes,
+                            [&](uint32_t) {
+                                batch._n_items = SyncUtils::queueClaimPop(_header,
+                                                        batch._pos, max_items);
+                                return batch._n_items > 0;
+                            },
+                            [&]() { return SyncUtils::isQueueAlive(_header); },
+                            ms_timeout,
+                            SyncUtils::spinBudget(_wait_policy, _max_spin_ns, _avg_wait_ns));
+
+        if (claimed) {
+
+            SyncUtils::updateAvgWait(_avg_wait_ns, SyncUtils::nowNs() - start_ns);
+
+            batch._queue = this;
+            batch._queue_open = _open;
+        }
+
+        return batch;
+
+    }
+
+    template <typename Scalar, int Layout>
+    int TensorQueue<Scalar, Layout>::size() {
+
+        _checkRunning(std::string(__FUNCTION__));
+
+        // dequeue_pos first: the difference cannot go negative
+        uint64_t dequeue_pos = _header->dequeue_pos.load(std::memory_order_acquire);
+        uint64_t enqueue_pos = _header->enqueue_pos.load(std::memory_order_acquire);
+
+        return static_cast<int>(std::min<uint64_t>(enqueue_pos - dequeue_pos, _capacity));
+
+    }
+
+    template <typename Scalar, int Layout>
+    int TensorQueue<Scalar, Layout>::getCapacity() {
+
+        return _capacity;
+    }
+
+    template <typename Scalar, int Layout>
+    int TensorQueue<Scalar, Layout>::getNRows() {
+
+        return _n_rows;
+    }
+
+    template <typename Scalar, int Layout>
+    int TensorQueue<Scalar, Layout>::getNCols() {
+
+        return _n_cols;
+    }
+
+    template <typename Scalar, int Layout>
+    void TensorQueue<Scalar, Layout>::set_wait_policy(WaitPolicy policy,
+                int max_spin_us) {
+
+        _wait_policy = policy;
+
+        _max_spin_ns = std::max(0, max_spin_us) * 1000LL;
+
+        _avg_wait_ns = 0.0;
+
+    }
+
+    template <typename Scalar, int Layout>
+    MMap<Scalar, Layout> TensorQueue<Scalar, Layout>::_cellView(uint64_t pos) {
+
+        return MMap<Scalar, Layout>(reinterpret_cast<Scalar*>(
+                    SyncUtils::queueData(_header, pos % _capacity)),
+                    _n_rows, _n_cols);
+
+    }
+
+    template <typename Scalar, int Layout>
+    void TensorQueue<Scalar, Layout>::_commitPop(uint64_t pos, int n_items) {
+
+        SyncUtils::queueCommitPop(_header, pos, n_items);
+
+    }
+
+    template <typename Scalar, int Layout>
+    bool TensorQueue<Scalar, Layout>::_openQueue() {
+
+        _return_code = _return_code + ReturnCode::RESET;
+
+        void* mem = MemUtils::openMem(_mem_config.mem_path,
+                            _shm_fd,
+                            _mem_size,
+                            _journal,
+                            _return_code,
+                            false,
+                            _vlevel);
+
+        if (mem == nullptr) {
+
+            return false; // not created yet
+        }
+
+        SyncUtils::QueueHeader* header = static_cast<SyncUtils::QueueHeader*>(mem);
+
+        if (_mem_size < sizeof(SyncUtils::QueueHeader) ||
+            !SyncUtils::isQueueReady(header) ||
+            !SyncUtils::isQueueAlive(header)) {
+
+            // being initialized or stale
+            MemUtils::unmapMem(mem, _mem_size, _shm_fd);
+
+            return false;
+
+        }
+
+        _header = header;
+
+        return true;
+
+    }
+
+    template <typename Scalar, int Layout>
+    void TensorQueue<Scalar, Layout>::_checkSize(int rows, int cols,
+                std::string calling_method) {
+
+        if (rows != _n_rows || cols != _n_cols) {
+
+            _journal.log(calling_method+_unique_id,
+                "Tensor size does not match the one of the queue",
+                LogType::EXCEP,
+                true); // throw exception
+
+        }
+    }
+
+    template <typename Scalar, int Layout>
+    void TensorQueue<Scalar, Layout>::_checkRunning(std::string calling_method) {
+
+        if (!_is_running) {
+
+            _journal.log(calling_method+_unique_id,
+                "Not running. Did you call create() or attach()?",
+                LogType::EXCEP,
+                true); // throw exception
+
+        }
+    }
+
+    template <typename Scalar, int Layout>
+    std::string TensorQueue<Scalar, Layout>::_getThisName() {
+
+        return THISNAME;
+    }
+
+    // explicit instantiations for specific supported types
+    // and layouts
+    template class TensorQueue<double, ColMajor>;
+    template class TensorQueue<float, ColMajor>;
+    template class TensorQueue<int, ColMajor>;
+    template class TensorQueue<bool, ColMajor>;
+
+    template class TensorQueue<double, RowMajor>;
+    template class TensorQueue<float, RowMajor>;
+    template class TensorQueue<int, RowMajor>;
+    template class TensorQueue<bool, RowMajor>;
+}
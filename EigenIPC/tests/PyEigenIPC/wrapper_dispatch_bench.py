@@ -0,0 +1,111 @@
+import unittest
+import numpy as np
+
+import timeit
+
+from EigenIPC.PyEigenIPC import *
+
+namespace = "WrapperDispatchBench"
+
+N_ITERATIONS = 100000
+
+MAX_WRAPPED_TYPED_RATIO = 2.0 # a wrapped call is a typed call plus a variant dispatch
+
+class TestWrapperDispatch(unittest.TestCase):
+
+    # per-call overhead of the type-agnostic Server/Client wrappers
+    # wrt the typed bindings returned by the factories (1x1 accesses, so
+    # that the timings are dominated by the dispatch)
+
+    def setUp(self):
+
+        self.typed_server = ServerFactory(1, 1,
+                                    basename="Dispatch",
+                                    namespace=namespace,
+                                    verbose=False,
+                                    force_reconnection=True,
+                                    dtype=dtype.Float,
+                                    layout=RowMajor)
+
+        self.typed_client = ClientFactory(basename="Dispatch",
+                                    namespace=namespace,
+                                    verbose=False,
+                                    dtype=dtype.Float,
+                                    layout=RowMajor)
+
+        self.server = Server(self.typed_server)
+        self.client = Client(self.typed_client)
+
+        self.server.run()
+        self.client.attach()
+
+        self.data = np.full((1, 1), 3.0, dtype=np.float32)
+        self.output = np.zeros((1, 1), dtype=np.float32)
+
+    def tearDown(self):
+
+        self.client.close()
+        self.server.close()
+
+    def time_per_call(self, f):
+
+        return timeit.timeit(f, number=N_ITERATIONS) / N_ITERATIONS * 1e9 # [ns]
+
+    def attr_write(self, data, row, col):
+
+        # what the wrappers used to do on each call: query the dtype, then
+        # look the typed method up by name
+        self.typed_server.getScalarType()
+        return getattr(self.typed_server, "write")(data, row, col)
+
+    def attr_read(self, output, row, col):
+
+        self.typed_client.getScalarType()
+        return getattr(self.typed_client, "read")(output, row, col)
+
+    def test_wrappers_are_consistent(self):
+
+        self.assertEqual(self.server.getScalarType(), dtype.Float)
+        self.assertEqual(self.client.getNRows(), 1)
+
+        self.assertTrue(self.server.write(self.data, 0, 0))
+        self.assertTrue(self.client.read(self.output, 0, 0))
+        self.assertEqual(self.output[0, 0], 3.0)
+
+        with self.assertRaises(Exception): # dtypes must match
+            self.server.write(np.zeros((1, 1), dtype=np.float64), 0, 0)
+
+    def test_dispatch_overhead(self):
+
+        baseline = self.time_per_call(lambda: self.typed_server.getNRows())
+
+        typed_write = self.time_per_call(lambda: self.typed_server.write(self.data, 0, 0))
+        wrapped_write = self.time_per_call(lambda: self.server.write(self.data, 0, 0))
+
+        typed_read = self.time_per_call(lambda: self.typed_client.read(self.output, 0, 0))
+        wrapped_read = self.time_per_call(lambda: self.client.read(self.output, 0, 0))
+
+        # previous dispatch (emulated from python, hence an approximation)
+        attr_write = self.time_per_call(lambda: self.attr_write(self.data, 0, 0))
+        attr_read = self.time_per_call(lambda: self.attr_read(self.output, 0, 0))
+
+        wrapped_query = self.time_per_call(lambda: self.server.getNRows())
+
+        print(f"\ntrivial typed call (getNRows): {baseline:.1f} ns")
+        print(f"wrapped getNRows: {wrapped_query:.1f} ns")
+        print(f"write (1x1): typed {typed_write:.1f} ns, wrapped {wrapped_write:.1f} ns " +
+              f"(ratio {wrapped_write / typed_write:.2f}), attribute lookup {attr_write:.1f} ns " +
+              f"(ratio {attr_write / typed_write:.2f})")
+        print(f"read (1x1): typed {typed_read:.1f} ns, wrapped {wrapped_read:.1f} ns " +
+              f"(ratio {wrapped_read / typed_read:.2f}), attribute lookup {attr_read:.1f} ns " +
+              f"(ratio {attr_read / typed_read:.2f})")
+
+        self.assertLess(wrapped_write / typed_write, MAX_WRAPPED_TYPED_RATIO)
+        self.assertLess(wrapped_read / typed_read, MAX_WRAPPED_TYPED_RATIO)
+
+        self.assertLess(wrapped_write, attr_write)
+        self.assertLess(wrapped_read, attr_read)
+
+if __name__ == "__main__":
+
+    unittest.main()
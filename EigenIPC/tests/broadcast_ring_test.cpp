@@ -0,0 +1,260 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+// 
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+// 
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+// 
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+
+#include <EigenIPC/BroadcastRing.hpp>
+#include <EigenIPC/Journal.hpp>
+
+using namespace EigenIPC;
+
+using VLevel = Journal::VLevel;
+
+static std::string name_space = "BroadcastRingTests";
+
+int N_READERS = 3;
+int N_SAMPLES = 2000;
+
+int TIMEOUT = 5000; // [ms]
+
+TEST(BroadcastRingTest, EveryReaderSeesEverySample) {
+
+    BroadcastRing<float, RowMajor> writer("Everyone", name_space);
+
+    writer.create(8, 3, N_SAMPLES + 1); // large enough for no overruns
+
+    std::atomic<int> n_ready(0);
+    std::atomic<int> n_failures(0);
+
+    std::vector<std::thread> readers;
+
+    for (int r = 0; r < N_READERS; ++r) {
+
+        readers.emplace_back([&]() {
+
+            BroadcastRing<float, RowMajor> reader("Everyone", name_space);
+
+            reader.attach();
+
+            n_ready++;
+
+            Tensor<float, RowMajor> output(8, 3);
+
+            for (int i = 0; i < N_SAMPLES; ++i) {
+
+                if (!reader.read(output, TIMEOUT) ||
+                    !(output.array() == static_cast<float>(i)).all()) {
+
+                    n_failures++;
+
+                    break;
+                }
+
+            }
+
+            if (reader.getLost() != 0 || reader.getCursor() != static_cast<uint64_t>(N_SAMPLES)) {
+
+                n_failures++;
+            }
+
+            reader.close();
+
+        });
+
+    }
+
+    while (n_ready < N_READERS) {
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    Tensor<float, RowMajor> data(8, 3);
+
+    for (int i = 0; i < N_SAMPLES; ++i) {
+
+        data.setConstant(static_cast<float>(i));
+
+        ASSERT_EQ(writer.append(data), i);
+    }
+
+    for (auto& reader : readers) {
+
+        reader.join();
+    }
+
+    ASSERT_EQ(n_failures, 0);
+
+    writer.close();
+
+}
+
+TEST(BroadcastRingTest, OverrunsAreReported) {
+
+    BroadcastRing<int, ColMajor> writer("Overrun", name_space);
+
+    writer.create(2, 2, 4);
+
+    BroadcastRing<int, ColMajor> reader("Overrun", name_space);
+
+    reader.attach();
+
+    Tensor<int, ColMajor> data(2, 2);
+
+    for (int i = 0; i < 10; ++i) {
+
+        data.setConstant(i);
+
+        writer.append(data);
+    }
+
+    Tensor<int, ColMajor> output(2, 2);
+
+    // the writer did not wait: only the last capacity - 1 samples are left
+    for (int i = 7; i < 10; ++i) {
+
+        ASSERT_TRUE(reader.tryRead(output));
+
+        ASSERT_EQ(output(1, 1), i);
+    }
+
+    ASSERT_EQ(reader.getLost(), 7);
+
+    ASSERT_FALSE(reader.tryRead(output)); // up to date
+    ASSERT_FALSE(reader.read(output, 10));
+
+    reader.close();
+    writer.close();
+
+}
+
+TEST(BroadcastRingTest, LateReadersCatchUp) {
+
+    BroadcastRing<double, RowMajor> writer("CatchUp", name_space);
+
+    writer.create(1, 4, 8);
+
+    Tensor<double, RowMajor> data(1, 4);
+
+    for (int i = 0; i < 10; ++i) {
+
+        data.setConstant(i);
+
+        writer.append(data);
+    }
+
+    BroadcastRing<double, RowMajor> reader("CatchUp", name_space);
+
+    reader.attach();
+
+    ASSERT_EQ(reader.getCursor(), 10); // only new samples
+
+    std::vector<Tensor<double, RowMajor>> outputs;
+
+    ASSERT_EQ(reader.readLast(outputs, 5), 5);
+
+    for (int i = 0; i < 5; ++i) {
+
+        ASSERT_EQ(outputs[i](0, 3), 5 + i);
+    }
+
+    ASSERT_EQ(reader.readLast(outputs, 100), 7); // capacity - 1
+
+    ASSERT_EQ(outputs[0](0, 0), 3);
+    ASSERT_EQ(outputs[6](0, 0), 9);
+
+    ASSERT_EQ(reader.getLost(), 0);
+
+    data.setConstant(10);
+
+    writer.append(data);
+
+    Tensor<double, RowMajor> output(1, 4);
+
+    ASSERT_TRUE(reader.read(output, TIMEOUT));
+    ASSERT_EQ(output(0, 0), 10);
+
+    reader.close();
+    writer.close();
+
+}
+
+TEST(BroadcastRingTest, ReadersGiveUpOnClose) {
+
+    BroadcastRing<int, ColMajor> writer("GiveUp", name_space);
+
+    writer.create(1, 1, 2);
+
+    BroadcastRing<int, ColMajor> reader("GiveUp", name_space);
+
+    reader.attach();
+
+    std::thread closer([&]() {
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+        writer.close();
+
+    });
+
+    Tensor<int, ColMajor> output(1, 1);
+
+    ASSERT_FALSE(reader.read(output)); // no timeout
+
+    closer.join();
+
+    ASSERT_FALSE(reader.isRunning());
+
+    reader.close();
+
+}
+
+TEST(BroadcastRingTest, SingleWriter) {
+
+    BroadcastRing<float, ColMajor> writer("Writer", name_space);
+
+    writer.create(2, 2, 4);
+
+    BroadcastRing<float, ColMajor> other("Writer", name_space);
+    ASSERT_THROW(other.create(2, 2, 4), std::runtime_error);
+
+    BroadcastRing<float, ColMajor> reader("Writer", name_space);
+
+    reader.attach();
+
+    Tensor<float, ColMajor> data = Tensor<float, ColMajor>::Zero(2, 2);
+
+    ASSERT_THROW(reader.append(data), std::runtime_error);
+
+    BroadcastRing<double, ColMajor> wrong_type("Writer", name_space);
+    ASSERT_THROW(wrong_type.attach(), std::runtime_error);
+
+    BroadcastRing<int, ColMajor> same_size("Writer", name_space); // as float
+    ASSERT_THROW(same_size.attach(), std::runtime_error);
+
+    reader.close();
+    writer.close();
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
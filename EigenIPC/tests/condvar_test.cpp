@@ -0,0 +1,391 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+// 
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+// 
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+// 
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+
+#include <EigenIPC/CondVar.hpp>
+#include <EigenIPC/Journal.hpp>
+
+#if __has_include(<boost/interprocess/sync/named_condition.hpp>)
+    #include <boost/interprocess/sync/named_mutex.hpp>
+    #include <boost/interprocess/sync/named_condition.hpp>
+    #include <boost/interprocess/sync/scoped_lock.hpp>
+    #define EIGENIPC_BOOST_BENCH 1
+#endif
+
+using namespace EigenIPC;
+
+using VLevel = Journal::VLevel;
+
+static std::string name_space = "CondVarTests";
+
+int N_WAITERS = 3;
+int N_ROUNDS = 2000;
+
+int TIMEOUT = 5000; // [ms]
+
+double median(std::vector<double>& samples) {
+
+    std::sort(samples.begin(), samples.end());
+
+    return samples[samples.size() / 2];
+
+}
+
+TEST(CondVarTest, TimedWaitTimesOut) {
+
+    ConditionVariable cv(true, "Timeout", name_space);
+
+    auto lock = cv.lock();
+
+    auto start = std::chrono::steady_clock::now();
+
+    ASSERT_FALSE(cv.timedwait(lock, 50));
+
+    ASSERT_TRUE(lock.owns()); // reacquired on return
+
+    ASSERT_FALSE(cv.timedwait_for(lock, 50, [] { return false; }));
+
+    double elapsed_ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+
+    ASSERT_GE(elapsed_ms, 100.0);
+
+    lock.unlock();
+
+    cv.close();
+
+}
+
+TEST(CondVarTest, NotifyAllWakesEveryWaiter) {
+
+    ConditionVariable server_cv(true, "NotifyAll", name_space);
+
+    // shared flag, protected by the named mutex
+    int round = 0;
+
+    std::atomic<int> n_woken(0);
+
+    std::vector<std::thread> waiters;
+
+    for (int w = 0; w < N_WAITERS; ++w) {
+
+        waiters.emplace_back([&]() {
+
+            ConditionVariable client_cv(false, "NotifyAll", name_space);
+
+            auto lock = client_cv.lock();
+
+            if (client_cv.timedwait_for(lock, TIMEOUT, [&] { return round > 0; })) {
+
+                n_woken++;
+            }
+
+            lock.unlock();
+
+            client_cv.close();
+
+        });
+
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    {
+        auto lock = server_cv.lock();
+
+        round = 1;
+    }
+
+    server_cv.notify_all();
+
+    for (auto& waiter : waiters) {
+
+        waiter.join();
+    }
+
+    ASSERT_EQ(n_woken, N_WAITERS);
+
+    server_cv.close();
+
+}
+
+TEST(CondVarTest, NotifyOneWakesOneWaiter) {
+
+    ConditionVariable server_cv(true, "NotifyOne", name_space);
+
+    int tokens = 0; // protected by the named mutex
+
+    std::atomic<int> n_served(0);
+
+    std::vector<std::thread> waiters;
+
+    for (int w = 0; w < N_WAITERS; ++w) {
+
+        waiters.emplace_back([&]() {
+
+            ConditionVariable client_cv(false, "NotifyOne", name_space);
+
+            auto lock = client_cv.lock();
+
+            if (client_cv.timedwait_for(lock, TIMEOUT, [&] { return tokens > 0; })) {
+
+                tokens--;
+
+                n_served++;
+            }
+
+            lock.unlock();
+
+            client_cv.close();
+
+        });
+
+    }
+
+    for (int w = 0; w < N_WAITERS; ++w) {
+
+        {
+            auto lock = server_cv.lock();
+
+            tokens++;
+        }
+
+        server_cv.notify_one();
+    }
+
+    for (auto& waiter : waiters) {
+
+        waiter.join();
+    }
+
+    ASSERT_EQ(n_served, N_WAITERS);
+    ASSERT_EQ(tokens, 0);
+
+    server_cv.close();
+
+}
+
+TEST(CondVarTest, NamedMutexIsExclusive) {
+
+    std::string path = "/CondVarTestsStandaloneMutex";
+
+    auto mutex = ConditionVariable::create_named_mutex(path);
+
+    int counter = 0;
+
+    std::vector<std::thread> workers;
+
+    for (int w = 0; w < N_WAITERS; ++w) {
+
+        workers.emplace_back([&]() {
+
+            auto other = ConditionVariable::create_named_mutex(path); // same word
+
+            for (int i = 0; i < N_ROUNDS; ++i) {
+
+                auto lock = ConditionVariable::lock(other);
+
+                counter++;
+            }
+
+        });
+
+    }
+
+    for (auto& worker : workers) {
+
+        worker.join();
+    }
+
+    ASSERT_EQ(counter, N_WAITERS * N_ROUNDS);
+
+    ASSERT_TRUE(mutex.try_lock());
+    ASSERT_FALSE(mutex.try_lock()); // not recursive
+
+    mutex.unlock();
+
+    shm_unlink(path.c_str());
+
+}
+
+TEST(CondVarTest, SingleServerPerCondVar) {
+
+    ConditionVariable server_cv(true, "Exclusive", name_space);
+
+    ASSERT_THROW(ConditionVariable(true, "Exclusive", name_space), std::runtime_error);
+
+    ConditionVariable client_cv(false, "Exclusive", name_space);
+
+    // forced takeover (e.g. after a crash)
+    ConditionVariable new_server_cv(true, "Exclusive", name_space,
+                        false, VLevel::V0, true);
+
+    server_cv.close(); // does not remove the new segment
+
+    ConditionVariable new_client_cv(false, "Exclusive", name_space);
+
+    new_client_cv.close();
+    client_cv.close();
+    new_server_cv.close();
+
+    ASSERT_THROW(ConditionVariable(false, "Exclusive", name_space), std::runtime_error);
+
+}
+
+TEST(CondVarTest, WakeLatency) {
+
+    // ping-pong between two threads: each round trip is made of two
+    // notifications, each of which has to wake a sleeping waiter
+
+    ConditionVariable server_cv(true, "Latency", name_space);
+
+    server_cv.set_wait_policy(WaitPolicy::Block); // measure the futex path
+
+    int turn = 0; // protected by the named mutex
+
+    std::thread ponger([&]() {
+
+        ConditionVariable client_cv(false, "Latency", name_space);
+
+        client_cv.set_wait_policy(WaitPolicy::Block);
+
+        for (int i = 0; i < N_ROUNDS; ++i) {
+
+            auto lock = client_cv.lock();
+
+            client_cv.wait_for(lock, [&] { return turn == 1; });
+
+            turn = 0;
+
+            lock.unlock();
+
+            client_cv.notify_one();
+        }
+
+        client_cv.close();
+
+    });
+
+    std::vector<double> round_trips;
+
+    for (int i = 0; i < N_ROUNDS; ++i) {
+
+        auto start = std::chrono::steady_clock::now();
+
+        auto lock = server_cv.lock();
+
+        turn = 1;
+
+        lock.unlock();
+
+        server_cv.notify_one();
+
+        lock.lock();
+
+        ASSERT_TRUE(server_cv.timedwait_for(lock, TIMEOUT, [&] { return turn == 0; }));
+
+        lock.unlock();
+
+        round_trips.push_back(std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - start).count());
+
+    }
+
+    ponger.join();
+
+    std::cout << "futex condvar round trip (median) [us]: " << median(round_trips) << std::endl;
+
+    server_cv.close();
+
+    #ifdef EIGENIPC_BOOST_BENCH
+
+        // same exchange on top of boost's emulated named condition
+        using namespace boost::interprocess;
+
+        named_mutex::remove("CondVarTestsBoostMutex");
+        named_condition::remove("CondVarTestsBoostCond");
+
+        named_mutex boost_mutex(create_only, "CondVarTestsBoostMutex");
+        named_condition boost_cond(create_only, "CondVarTestsBoostCond");
+
+        turn = 0;
+
+        std::thread boost_ponger([&]() {
+
+            for (int i = 0; i < N_ROUNDS; ++i) {
+
+                scoped_lock<named_mutex> lock(boost_mutex);
+
+                boost_cond.wait(lock, [&] { return turn == 1; });
+
+                turn = 0;
+
+                lock.unlock();
+
+                boost_cond.notify_one();
+            }
+
+        });
+
+        std::vector<double> boost_round_trips;
+
+        for (int i = 0; i < N_ROUNDS; ++i) {
+
+            auto start = std::chrono::steady_clock::now();
+
+            scoped_lock<named_mutex> lock(boost_mutex);
+
+            turn = 1;
+
+            lock.unlock();
+
+            boost_cond.notify_one();
+
+            lock.lock();
+
+            boost_cond.wait(lock, [&] { return turn == 0; });
+
+            lock.unlock();
+
+            boost_round_trips.push_back(std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - start).count());
+
+        }
+
+        boost_ponger.join();
+
+        std::cout << "boost named_condition round trip (median) [us]: " <<
+                median(boost_round_trips) << std::endl;
+
+        named_mutex::remove("CondVarTestsBoostMutex");
+        named_condition::remove("CondVarTestsBoostCond");
+
+    #endif
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
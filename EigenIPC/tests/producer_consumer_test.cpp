@@ -0,0 +1,879 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+//
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+//
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <sys/epoll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <EigenIPC/Producer.hpp>
+#include <EigenIPC/Consumer.hpp>
+#include <EigenIPC/CondVar.hpp>
+#include <EigenIPC/TensorProducer.hpp>
+#include <EigenIPC/TensorConsumer.hpp>
+#include <EigenIPC/Journal.hpp>
+
+using namespace EigenIPC;
+
+using VLevel = Journal::VLevel;
+
+static std::string name_space = "ProducerConsumerTests";
+
+int N_CONSUMERS = 16;
+int N_ROUNDS = 2000;
+
+int TIMEOUT = 5000; // [ms]
+
+TEST(ProducerConsumerTest, TriggerAckRounds) {
+
+    Producer producer("Rounds", name_space);
+
+    producer.run();
+
+    std::atomic<int> n_ready(0);
+    std::atomic<int> n_failures(0);
+
+    std::vector<std::thread> consumers;
+
+    for (int i = 0; i < N_CONSUMERS; ++i) {
+
+        consumers.emplace_back([&]() {
+
+            Consumer consumer("Rounds", name_space);
+
+            consumer.run();
+
+            n_ready++;
+
+            for (int round = 0; round < N_ROUNDS; ++round) {
+
+                if (!consumer.wait(TIMEOUT) || !consumer.ack()) {
+
+                    n_failures++;
+
+                    break;
+                }
+
+            }
+
+            consumer.close();
+
+        });
+
+    }
+
+    while (n_ready < N_CONSUMERS) {
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (int round = 0; round < N_ROUNDS; ++round) {
+
+        producer.trigger();
+
+        ASSERT_TRUE(producer.wait_ack_from(N_CONSUMERS, TIMEOUT));
+
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+
+    for (auto& consumer : consumers) {
+
+        consumer.join();
+    }
+
+    double round_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            end - start).count() / N_ROUNDS;
+
+    std::cout << "Average trigger/ack round with " << N_CONSUMERS <<
+                " consumers: " << round_time / 1000.0 << " us" << std::endl;
+
+    ASSERT_EQ(n_failures, 0);
+
+    producer.close();
+
+}
+
+TEST(ProducerConsumerTest, AllWaitPoliciesCompleteRounds) {
+
+    int n_consumers = 2;
+    int n_rounds = 200;
+
+    for (WaitPolicy policy : {WaitPolicy::Block,
+                            WaitPolicy::SpinThenBlock,
+                            WaitPolicy::Spin}) {
+
+        Producer producer("Policies", name_space);
+
+        producer.set_wait_policy(policy);
+
+        producer.run();
+
+        std::atomic<int> n_ready(0);
+        std::atomic<int> n_failures(0);
+
+        std::vector<std::thread> consumers;
+
+        for (int i = 0; i < n_consumers; ++i) {
+
+            consumers.emplace_back([&]() {
+
+                Consumer consumer("Policies", name_space);
+
+                consumer.set_wait_policy(policy);
+
+                consumer.run();
+
+                n_ready++;
+
+                for (int round = 0; round < n_rounds; ++round) {
+
+                    if (!consumer.wait(TIMEOUT) || !consumer.ack()) {
+
+                        n_failures++;
+
+                        break;
+                    }
+
+                }
+
+                consumer.close();
+
+            });
+
+        }
+
+        while (n_ready < n_consumers) {
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        for (int round = 0; round < n_rounds; ++round) {
+
+            producer.trigger();
+
+            ASSERT_TRUE(producer.wait_ack_from(n_consumers, TIMEOUT));
+
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+
+        for (auto& consumer : consumers) {
+
+            consumer.join();
+        }
+
+        double round_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                end - start).count() / n_rounds;
+
+        std::cout << "Average trigger/ack round with wait policy " <<
+                    static_cast<int>(policy) << ": " << round_time / 1000.0 << " us" << std::endl;
+
+        ASSERT_EQ(n_failures, 0);
+
+        producer.close();
+
+    }
+
+}
+
+TEST(ProducerConsumerTest, SpinningTimesOut) {
+
+    Producer producer("SpinTimeout", name_space);
+
+    producer.set_wait_policy(WaitPolicy::Spin);
+
+    producer.run();
+
+    Consumer consumer("SpinTimeout", name_space);
+
+    consumer.set_wait_policy(WaitPolicy::Spin);
+
+    consumer.run();
+
+    ASSERT_FALSE(consumer.wait(10)); // spinning still honours the timeout
+    ASSERT_FALSE(producer.wait_ack_from(1, 10));
+
+    consumer.close();
+    producer.close();
+
+}
+
+TEST(ProducerConsumerTest, CondVarSpinningPredicateWaits) {
+
+    ConditionVariable server_cv(true, "SpinCondVar", name_space,
+                    false, VLevel::V0, true);
+
+    ConditionVariable client_cv(false, "SpinCondVar", name_space);
+
+    client_cv.set_wait_policy(WaitPolicy::SpinThenBlock, 1000);
+
+    int value = 0; // protected by the named mutex
+
+    std::thread notifier([&]() {
+
+        for (int i = 1; i <= 100; ++i) {
+
+            auto lock = server_cv.lock();
+
+            value = i;
+
+            ConditionVariable::unlock(lock);
+
+            server_cv.notify_all();
+
+        }
+
+    });
+
+    auto lock = client_cv.lock();
+
+    client_cv.wait_for(lock, [&]() { return value == 100; });
+
+    ASSERT_EQ(value, 100);
+
+    ConditionVariable::unlock(lock);
+
+    notifier.join();
+
+    client_cv.set_wait_policy(WaitPolicy::Spin);
+
+    lock = client_cv.lock();
+
+    ASSERT_FALSE(client_cv.timedwait_for(lock, 10,
+                    [&]() { return value > 100; })); // nothing is coming
+
+    ConditionVariable::unlock(lock);
+
+}
+
+TEST(ProducerConsumerTest, MissingAcksTimeOut) {
+
+    Producer producer("MissingAcks", name_space);
+
+    producer.run();
+
+    Consumer consumer("MissingAcks", name_space);
+
+    consumer.run();
+
+    ASSERT_FALSE(consumer.wait(10)); // nothing triggered yet
+
+    producer.trigger();
+
+    ASSERT_TRUE(consumer.wait(TIMEOUT));
+    ASSERT_TRUE(consumer.ack());
+
+    ASSERT_FALSE(producer.wait_ack_from(2, 20)); // one consumer only
+    ASSERT_TRUE(producer.wait_ack_from(1, 20)); // its ack was not lost
+
+    consumer.close();
+    producer.close();
+
+}
+
+TEST(ProducerConsumerTest, StragglersAreIdentified) {
+
+    Producer producer("Stragglers", name_space);
+
+    producer.run();
+
+    std::vector<std::unique_ptr<Consumer>> consumers;
+
+    for (int i = 0; i < 3; ++i) {
+
+        consumers.push_back(std::make_unique<Consumer>("Stragglers", name_space));
+
+        consumers.back()->run();
+
+        ASSERT_EQ(consumers.back()->slot(), i);
+    }
+
+    ASSERT_EQ(producer.n_consumers(), 3);
+
+    producer.trigger();
+
+    ASSERT_TRUE(consumers[0]->wait(TIMEOUT));
+    ASSERT_TRUE(consumers[0]->ack());
+
+    ASSERT_TRUE(consumers[2]->wait(TIMEOUT));
+    ASSERT_TRUE(consumers[2]->ack());
+    ASSERT_TRUE(consumers[2]->ack()); // counted once
+
+    ASSERT_FALSE(producer.wait_ack_from(3, 20));
+    ASSERT_FALSE(producer.wait_ack_all(20));
+
+    ASSERT_EQ(producer.missing_acks(), std::vector<int>{1});
+
+    ASSERT_TRUE(consumers[1]->wait(TIMEOUT));
+    ASSERT_TRUE(consumers[1]->ack());
+
+    ASSERT_TRUE(producer.wait_ack_all(TIMEOUT));
+    ASSERT_TRUE(producer.missing_acks().empty());
+
+    for (int i = 0; i < 3; ++i) {
+
+        std::vector<uint64_t> histogram = producer.ack_latency_histogram(i);
+
+        ASSERT_EQ(histogram.size(), Producer::N_LATENCY_BINS);
+        ASSERT_EQ(std::accumulate(histogram.begin(), histogram.end(), uint64_t(0)), 1);
+    }
+
+    // acks for an old trigger are rejected
+    producer.trigger();
+
+    ASSERT_TRUE(consumers[0]->wait(TIMEOUT));
+
+    producer.trigger();
+
+    ASSERT_FALSE(consumers[0]->ack());
+
+    // closed consumers are not waited for and their slot is reused
+    consumers[1]->close();
+
+    ASSERT_EQ(producer.n_consumers(), 2);
+
+    ASSERT_TRUE(consumers[0]->wait(TIMEOUT));
+    ASSERT_TRUE(consumers[0]->ack());
+    ASSERT_FALSE(consumers[2]->wait(TIMEOUT)); // reports the missed trigger
+    ASSERT_TRUE(consumers[2]->ack()); // but can ack the last one
+
+    ASSERT_TRUE(producer.wait_ack_all(TIMEOUT));
+
+    Consumer newcomer("Stragglers", name_space);
+
+    newcomer.run();
+
+    ASSERT_EQ(newcomer.slot(), 1);
+
+    newcomer.close();
+
+    for (auto& consumer : consumers) {
+
+        consumer->close();
+    }
+
+    producer.close();
+
+}
+
+TEST(ProducerConsumerTest, CrashedConsumersAreReaped) {
+
+    Producer producer("Crashed", name_space);
+
+    producer.run();
+
+    Consumer consumer("Crashed", name_space);
+
+    consumer.run();
+
+    pid_t pid = fork();
+
+    ASSERT_NE(pid, -1);
+
+    if (pid == 0) {
+
+        // registers and dies without closing
+        Consumer child_consumer("Crashed", name_space);
+
+        child_consumer.run();
+
+        _exit(0);
+
+    }
+
+    int status = 0;
+
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+
+    ASSERT_EQ(producer.n_consumers(), 1);
+
+    std::thread acker([&]() {
+
+        if (consumer.wait(TIMEOUT)) {
+
+            consumer.ack();
+        }
+
+    });
+
+    producer.trigger();
+
+    ASSERT_TRUE(producer.wait_ack_all()); // not waiting for the dead one
+
+    acker.join();
+
+    consumer.close();
+    producer.close();
+
+}
+
+TEST(ProducerConsumerTest, ConsumersGiveUpOnClose) {
+
+    Producer producer("GiveUp", name_space);
+
+    producer.run();
+
+    Consumer consumer("GiveUp", name_space);
+
+    consumer.run();
+
+    std::thread closer([&]() {
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+        producer.close();
+
+    });
+
+    ASSERT_FALSE(consumer.wait()); // no timeout
+
+    closer.join();
+
+    ASSERT_FALSE(consumer.ack());
+
+    consumer.close();
+
+}
+
+TEST(ProducerConsumerTest, TriggersArePollable) {
+
+    const int n_consumers = 4;
+
+    Producer producer("Pollable", name_space);
+
+    producer.run();
+
+    ASSERT_TRUE(producer.enable_notify_fd());
+
+    std::vector<std::unique_ptr<Consumer>> consumers;
+
+    int epoll_fd = epoll_create1(0);
+
+    ASSERT_GE(epoll_fd, 0);
+
+    for (int i = 0; i < n_consumers; ++i) {
+
+        consumers.emplace_back(new Consumer("Pollable", name_space));
+
+        consumers.back()->run();
+
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u32 = i;
+
+        ASSERT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_ADD,
+                        consumers.back()->get_notify_fd(), &event), 0);
+
+    }
+
+    epoll_event events[n_consumers];
+
+    // all the consumers served by a single thread
+    for (int round = 0; round < 10; ++round) {
+
+        producer.trigger();
+
+        int n_acked = 0;
+
+        while (n_acked < n_consumers) {
+
+            int n_events = epoll_wait(epoll_fd, events, n_consumers, TIMEOUT);
+
+            ASSERT_GT(n_events, 0);
+
+            for (int e = 0; e < n_events; ++e) {
+
+                Consumer& consumer = *consumers[events[e].data.u32];
+
+                ASSERT_EQ(consumer.clear_notify(), 1);
+
+                ASSERT_TRUE(consumer.wait(0)); // the trigger is already there
+                ASSERT_TRUE(consumer.ack());
+
+                n_acked++;
+            }
+
+        }
+
+        ASSERT_TRUE(producer.wait_ack_all(TIMEOUT));
+
+    }
+
+    consumers.back()->close(); // dropped by the producer at the next trigger
+
+    producer.trigger();
+
+    ASSERT_EQ(epoll_wait(epoll_fd, events, n_consumers, TIMEOUT), n_consumers - 1);
+
+    for (int i = 0; i < n_consumers - 1; ++i) {
+
+        consumers[i]->clear_notify();
+        consumers[i]->wait(0);
+    }
+
+    producer.close();
+
+    ASSERT_EQ(epoll_wait(epoll_fd, events, n_consumers, TIMEOUT), n_consumers - 1);
+
+    ASSERT_FALSE(consumers[0]->wait(0)); // producer gone
+
+    ::close(epoll_fd);
+
+    for (auto& consumer : consumers) {
+
+        consumer->close();
+    }
+
+}
+
+TEST(ProducerConsumerTest, SingleProducerPerBarrier) {
+
+    Producer producer("Unique", name_space);
+
+    producer.run();
+
+    Producer other("Unique", name_space);
+
+    ASSERT_THROW(other.run(), std::runtime_error);
+
+    Consumer consumer("Unique", name_space);
+
+    consumer.run();
+
+    Producer new_owner("Unique", name_space,
+                false,
+                VLevel::V0,
+                true); // force_reconnection
+
+    new_owner.run();
+
+    ASSERT_FALSE(consumer.wait(TIMEOUT)); // the old producer is gone
+
+    consumer.close();
+    consumer.run(); // now attached to the new producer
+
+    new_owner.trigger();
+
+    ASSERT_TRUE(consumer.wait(TIMEOUT));
+
+    producer.close(); // does not affect the new producer
+    
+    ASSERT_TRUE(consumer.ack());
+    ASSERT_TRUE(new_owner.wait_ack_from(1, TIMEOUT));
+
+    consumer.close();
+    new_owner.close();
+
+}
+
+TEST(TensorProducerTest, DataMatchesTheTrigger) {
+
+    int n_rows = 100;
+    int n_cols = 30;
+
+    TensorProducer<float, RowMajor> producer(n_rows, n_cols, "TensorRounds", name_space);
+
+    producer.run();
+
+    std::atomic<int> n_ready(0);
+    std::atomic<int> n_failures(0);
+
+    std::vector<std::thread> consumers;
+
+    for (int i = 0; i < 4; ++i) {
+
+        consumers.emplace_back([&]() {
+
+            TensorConsumer<float, RowMajor> consumer("TensorRounds", name_space);
+
+            consumer.run();
+
+            n_ready++;
+
+            for (int round = 1; round <= N_ROUNDS; ++round) {
+
+                if (!consumer.wait(TIMEOUT) ||
+                    consumer.getNRows() != n_rows ||
+                    !(consumer.data().array() == static_cast<float>(round)).all() ||
+                    !consumer.isValid() ||
+                    !consumer.ack()) {
+
+                    n_failures++;
+
+                    break;
+                }
+
+            }
+
+            consumer.close();
+
+        });
+
+    }
+
+    while (n_ready < 4) {
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    Tensor<float, RowMajor> data(n_rows, n_cols);
+
+    for (int round = 1; round <= N_ROUNDS; ++round) {
+
+        data.setConstant(static_cast<float>(round));
+
+        producer.publish(data);
+
+        ASSERT_TRUE(producer.wait_ack_all(TIMEOUT));
+
+    }
+
+    for (auto& consumer : consumers) {
+
+        consumer.join();
+    }
+
+    ASSERT_EQ(n_failures, 0);
+
+    producer.close();
+
+}
+
+TEST(TensorProducerTest, OverwrittenViewsAreDetected) {
+
+    TensorProducer<int, ColMajor> producer(5, 4, "TensorOverwrite", name_space,
+                false, VLevel::V0, false,
+                2); // n_slots
+
+    producer.run();
+
+    TensorConsumer<int, ColMajor> consumer("TensorOverwrite", name_space);
+
+    consumer.run();
+
+    producer.next().setConstant(1); // zero-copy
+    producer.publish();
+
+    ASSERT_TRUE(consumer.wait(TIMEOUT));
+    ASSERT_EQ(consumer.data()(4, 3), 1);
+
+    producer.next().setConstant(2); // other slot
+    producer.publish();
+
+    ASSERT_TRUE(consumer.isValid());
+
+    producer.next(); // back to the slot being viewed
+
+    ASSERT_FALSE(consumer.isValid());
+
+    producer.publish();
+
+    consumer.close();
+    producer.close();
+
+}
+
+TEST(TensorProducerTest, MismatchesAreRejected) {
+
+    TensorProducer<float, RowMajor> producer(2, 2, "TensorMismatch", name_space);
+
+    producer.run();
+
+    TensorConsumer<double, RowMajor> wrong_type("TensorMismatch", name_space);
+    ASSERT_THROW(wrong_type.run(), std::runtime_error);
+
+    TensorConsumer<int, RowMajor> same_size("TensorMismatch", name_space); // as float
+    ASSERT_THROW(same_size.run(), std::runtime_error);
+
+    TensorConsumer<float, ColMajor> wrong_layout("TensorMismatch", name_space);
+    ASSERT_THROW(wrong_layout.run(), std::runtime_error);
+
+    Consumer plain("TensorMismatch", name_space); // triggers only
+
+    plain.run();
+
+    Tensor<float, RowMajor> data = Tensor<float, RowMajor>::Zero(2, 2);
+
+    producer.publish(data);
+
+    ASSERT_TRUE(plain.wait(TIMEOUT));
+
+    plain.close();
+
+    Producer no_data("TensorMissing", name_space);
+
+    no_data.run();
+
+    TensorConsumer<float, RowMajor> no_tensor("TensorMissing", name_space);
+    ASSERT_THROW(no_tensor.run(), std::runtime_error);
+
+    no_data.close();
+    producer.close();
+
+}
+
+TEST(ProducerConsumerTest, LateAcksAreNotCounted) {
+
+    // the producer triggers again right while a consumer acks the previous
+    // trigger: its ack must not complete the new round (which it only sees,
+    // and acks, some time later). The data carries the round
+    int n_pairs = 1000;
+    int delay_us = 20; // processing time of the late consumer
+
+    TensorProducer<int, RowMajor> producer(1, 1, "LateAcks", name_space,
+                false, VLevel::V0, false,
+                8); // n_slots
+
+    producer.run();
+
+    std::atomic<int> n_ready(0);
+    std::atomic<bool> done(false);
+
+    std::atomic<int> processed(0); // last round processed by the late consumer
+    std::atomic<int> acking(0); // round the late consumer is about to ack
+
+    std::thread late_consumer([&]() {
+
+        TensorConsumer<int, RowMajor> consumer("LateAcks", name_space);
+
+        consumer.run();
+
+        n_ready++;
+
+        unsigned int n_spins = 0;
+
+        while (!done) {
+
+            if (!consumer.wait(10)) {
+
+                continue; // timeout
+            }
+
+            int round = consumer.data()(0, 0);
+
+            auto start = std::chrono::steady_clock::now();
+
+            while (std::chrono::steady_clock::now() - start <
+                    std::chrono::microseconds(delay_us)) {}
+
+            processed = round;
+            acking = round;
+
+            // the producer triggers again as soon as it sees this: the
+            // ack lands slightly before, within or after the trigger
+            n_spins = (n_spins * 1103515245u + 12345u) % 4096u;
+
+            for (volatile unsigned int spin = 0; spin < n_spins; ++spin) {}
+
+            if (round % 4 == 1) {
+
+                std::this_thread::yield(); // lets the producer trigger first
+                // (also on a single core)
+            }
+
+            consumer.ack(); // may be rejected
+
+        }
+
+        consumer.close();
+
+    });
+
+    std::thread prompt_consumer([&]() {
+
+        Consumer consumer("LateAcks", name_space);
+
+        consumer.run();
+
+        n_ready++;
+
+        while (!done) {
+
+            consumer.wait(10); // false also if it missed some triggers
+
+            consumer.ack(); // acks the last one it saw
+
+        }
+
+        consumer.close();
+
+    });
+
+    while (n_ready < 2) {
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    Tensor<int, RowMajor> data(1, 1);
+
+    int n_completed = 0;
+    int n_miscounted = 0;
+
+    for (int pair = 0; pair < n_pairs; ++pair) {
+
+        int round = 2 * pair + 1;
+
+        data(0, 0) = round;
+        producer.publish(data);
+
+        while (acking != round) {} // the late consumer is about to ack it
+
+        data(0, 0) = round + 1;
+        producer.publish(data);
+
+        if (producer.wait_ack_all(TIMEOUT)) {
+
+            n_completed++;
+
+            if (processed != round + 1) {
+
+                n_miscounted++; // completed by the ack of the previous round
+            }
+
+        }
+
+        while (acking != round + 1) {} // before the next pair
+
+    }
+
+    done = true;
+
+    late_consumer.join();
+    prompt_consumer.join();
+
+    EXPECT_EQ(n_miscounted, 0);
+    EXPECT_EQ(n_completed, n_pairs);
+
+    producer.close();
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -29,11 +29,15 @@
 
 #include <test_utils.hpp>
 
+#include <CopyUtils.hpp> // private (for switching copy kernels)
+
 int N_ITERATIONS = 1000000;
 int N_ITERATIONS_STR = 100000;
 
 int STR_TENSOR_LENGTH = 100;
 
+int N_ITERATIONS_LARGE = 200;
+
 using namespace EigenIPC;
 
 using VLevel = Journal::VLevel;
@@ -442,6 +446,254 @@ TEST_F(StringTensorWrite, StringTensorWriteBenchmark) {
 
 }
 
+TEST_F(StringTensorWrite, StringCachedReadBenchmark) {
+
+    check_comp_type(journal);
+
+    // labels which (almost) never change: reads are served from the
+    // decoded copy, or only re-decode the strings which were written
+    double unchanged_time = 0, one_changed_time = 0; // [ns]
+
+    string_t_ptr->write(str_vec_write, 0);
+    string_t_ptr->read(str_vec_read, 0);
+
+    for (int i = 0; i < N_ITERATIONS_STR; ++i) {
+
+        auto start = std::chrono::high_resolution_clock::now();
+        string_t_ptr->read(str_vec_read, 0);
+        auto end = std::chrono::high_resolution_clock::now();
+        unchanged_time += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        string_t_ptr->write(str_vec_write[i % STR_TENSOR_LENGTH], i % STR_TENSOR_LENGTH);
+
+        start = std::chrono::high_resolution_clock::now();
+        string_t_ptr->read(str_vec_read, 0);
+        end = std::chrono::high_resolution_clock::now();
+        one_changed_time += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    }
+
+    unchanged_time /= N_ITERATIONS_STR;
+    one_changed_time /= N_ITERATIONS_STR;
+
+    std::cout << "Read of " << STR_TENSOR_LENGTH << " strings:" << std::endl;
+    std::cout << "  unchanged: " << unchanged_time << " ns" << std::endl;
+    std::cout << "  one string changed: " << one_changed_time << " ns\n" << std::endl;
+
+    ASSERT_EQ(str_vec_read, str_vec_write);
+
+}
+
+// reference: the previous StringTensor layout (a fixed column of 256 ints per
+// string, packed and unpacked byte by byte, on top of a plain Server<int>)
+static constexpr int LEGACY_STR_ROWS = 1024 / sizeof(int);
+
+void legacy_encode(const std::string& str, Tensor<int>& buffer, int col_index) {
+
+    buffer.col(col_index).setZero();
+
+    for (size_t i = 0, row = 0; i < str.size(); i += sizeof(int), ++row) {
+
+        int value = 0;
+
+        for (size_t j = 0; j < sizeof(int) && i + j < str.size(); ++j) {
+
+            value |= (static_cast<int>(static_cast<unsigned char>(str[i + j])) << (j * 8));
+        }
+
+        buffer(row, col_index) = value;
+    }
+
+}
+
+void legacy_decode(std::string& str, const Tensor<int>& buffer, int col_index) {
+
+    str.clear();
+
+    for (int row = 0; row < LEGACY_STR_ROWS; ++row) {
+
+        int value = buffer(row, col_index);
+
+        for (size_t j = 0; j < sizeof(int); ++j) {
+
+            char c = (value >> (j * 8)) & 0xFF;
+
+            if (c == 0) break;
+
+            str.push_back(c);
+        }
+
+        if (str.size() % sizeof(int) != 0) break;
+    }
+
+}
+
+TEST_F(StringTensorWrite, StringCodecBenchmark) {
+
+    check_comp_type(journal);
+
+    // the same operation with both layouts: encode, write to the shared memory,
+    // read back and decode (all of which StringTensor::write() + read() do)
+    Server<int> legacy_server(LEGACY_STR_ROWS, STR_TENSOR_LENGTH,
+                "LegacyStrTensor", name_space,
+                false,
+                VLevel::V0,
+                true); // (not safe, as the StringTensor)
+
+    legacy_server.run();
+
+    Tensor<int> legacy_buffer = Tensor<int>::Zero(LEGACY_STR_ROWS, STR_TENSOR_LENGTH);
+    Tensor<int> legacy_column = Tensor<int>::Zero(LEGACY_STR_ROWS, 1); // single string
+
+    double legacy_time = 0, arena_time = 0; // [ns]
+    double legacy_status_time = 0, arena_status_time = 0; // [ns], single string
+
+    std::string status = "step 123456: running (3 contacts, 12 active constraints)";
+    std::string status_read;
+
+    for (int i = 0; i < N_ITERATIONS_STR; ++i) {
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int j = 0; j < STR_TENSOR_LENGTH; ++j) {
+            legacy_encode(str_vec_write[j], legacy_buffer, j);
+        }
+        legacy_server.write(legacy_buffer, 0, 0);
+        legacy_server.read(legacy_buffer, 0, 0);
+        for (int j = 0; j < STR_TENSOR_LENGTH; ++j) {
+            legacy_decode(str_vec_read[j], legacy_buffer, j);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        legacy_time += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        start = std::chrono::high_resolution_clock::now();
+        string_t_ptr->write(str_vec_write, 0);
+        string_t_ptr->read(str_vec_read, 0);
+        end = std::chrono::high_resolution_clock::now();
+        arena_time += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        start = std::chrono::high_resolution_clock::now();
+        legacy_encode(status, legacy_column, 0);
+        legacy_server.write(legacy_column, 0, 0);
+        legacy_server.read(legacy_column, 0, 0);
+        legacy_decode(status_read, legacy_column, 0);
+        end = std::chrono::high_resolution_clock::now();
+        legacy_status_time += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        start = std::chrono::high_resolution_clock::now();
+        string_t_ptr->write(status, 0);
+        string_t_ptr->read(status_read, 0);
+        end = std::chrono::high_resolution_clock::now();
+        arena_status_time += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    }
+
+    legacy_time /= N_ITERATIONS_STR;
+    arena_time /= N_ITERATIONS_STR;
+    legacy_status_time /= N_ITERATIONS_STR;
+    arena_status_time /= N_ITERATIONS_STR;
+
+    std::cout << "Write + read of " << STR_TENSOR_LENGTH << " strings:" << std::endl;
+    std::cout << "  fixed columns (byte loops): " << legacy_time << " ns" << std::endl;
+    std::cout << "  arena: " << arena_time << " ns (ratio " <<
+                    arena_time / legacy_time << ")" << std::endl;
+    std::cout << "Write + read of a status string:" << std::endl;
+    std::cout << "  fixed columns (byte loops): " << legacy_status_time << " ns" << std::endl;
+    std::cout << "  arena: " << arena_status_time << " ns (ratio " <<
+                    arena_status_time / legacy_status_time << ")\n" << std::endl;
+
+    ASSERT_EQ(str_vec_read, str_vec_write);
+    ASSERT_EQ(status_read, status);
+
+    legacy_server.close();
+
+}
+
+// large tensors (copy kernels)
+template <typename Copy>
+double copyBandwidth(Copy copy, std::size_t n_bytes) { // [GB/s]
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (int i = 0; i < N_ITERATIONS_LARGE; ++i) {
+
+        copy();
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double time = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    return n_bytes * N_ITERATIONS_LARGE / time;
+
+}
+
+TEST(LargeWrite, CopyKernelsBenchmark) {
+
+    check_comp_type(journal);
+
+    int rows = 4096;
+    int cols = 1024; // 16 MB of floats
+
+    Server<float, RowMajor> server(rows, cols,
+                "LargeWrite", name_space,
+                false,
+                VLevel::V0,
+                true);
+
+    server.run();
+
+    Tensor<float, RowMajor> data(rows, cols);
+    data.setRandom();
+
+    Tensor<float, RowMajor> output(rows, cols);
+    Tensor<float, RowMajor> eigen_target(rows, cols); // not shared
+
+    std::size_t n_bytes = sizeof(float) * rows * cols;
+
+    // reference: plain Eigen block assignment
+    double eigen_bw = copyBandwidth([&]() {
+                    eigen_target.block(0, 0, rows, cols) = data;
+                }, n_bytes);
+
+    // regular stores (memcpy)
+    CopyUtils::streamThreshold().store(SIZE_MAX);
+
+    double memcpy_bw = copyBandwidth([&]() {
+                    server.write(data, 0, 0);
+                }, n_bytes);
+
+    // non-temporal stores
+    CopyUtils::streamThreshold().store(CopyUtils::STREAM_THRESHOLD);
+
+    double stream_bw = copyBandwidth([&]() {
+                    server.write(data, 0, 0);
+                }, n_bytes);
+
+    double read_bw = copyBandwidth([&]() {
+                    server.read(output, 0, 0);
+                }, n_bytes);
+
+    std::cout << "Tensor size: " << n_bytes / (1024 * 1024) << " MB" << std::endl;
+    std::cout << "Streaming kernel: " << static_cast<int>(CopyUtils::streamKernel()) <<
+                " (0: memcpy, 1: SSE2, 2: AVX2, 3: AVX512)" << std::endl;
+    std::cout << "Eigen assignment (not shared): " << eigen_bw << " GB/s" << std::endl;
+    std::cout << "Write (regular stores): " << memcpy_bw << " GB/s" << std::endl;
+    std::cout << "Write (streaming stores): " << stream_bw << " GB/s" << std::endl;
+    std::cout << "Read: " << read_bw << " GB/s\n" << std::endl;
+
+    ASSERT_TRUE(output == data); // the fast paths copy the right data
+
+    Tensor<float, RowMajor> block(100, 200);
+    block.setRandom();
+
+    ASSERT_TRUE(server.write(block, 10, 20)); // strided -> generic path
+    ASSERT_TRUE(server.read(output, 0, 0));
+    ASSERT_TRUE(output.block(10, 20, 100, 200) == block);
+
+    server.close();
+
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
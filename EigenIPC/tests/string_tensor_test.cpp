@@ -0,0 +1,382 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+// 
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+// 
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+// 
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+
+#include <EigenIPC/StringTensor.hpp>
+#include <EigenIPC/Journal.hpp>
+
+using namespace EigenIPC;
+
+using VLevel = Journal::VLevel;
+
+static std::string name_space = "StringTensorTests";
+
+int N_STRINGS = 100;
+
+std::string make_string(int i, int length) {
+
+    std::string str = "str" + std::to_string(i) + "-";
+
+    while (str.size() < static_cast<std::size_t>(length)) {
+
+        str.push_back('a' + (str.size() + i) % 26);
+    }
+
+    str.resize(length);
+
+    return str;
+
+}
+
+TEST(StringTensorTest, ClientsReadWhatServerWrote) {
+
+    StringTensor<StrServer> server(N_STRINGS, "RoundTrip", name_space);
+    server.run();
+
+    StringTensor<StrClient> client("RoundTrip", name_space);
+    client.run();
+
+    ASSERT_EQ(client.getLength(), N_STRINGS);
+
+    std::vector<std::string> written(N_STRINGS), read(N_STRINGS);
+
+    for (int i = 0; i < N_STRINGS; ++i) {
+
+        written[i] = make_string(i, i % 40); // some are empty
+    }
+
+    written[3] = "ünïcödé ✓"; // multi-byte UTF-8
+
+    ASSERT_TRUE(server.write(written, 0));
+
+    ASSERT_TRUE(client.read(read, 0));
+    EXPECT_EQ(read, written);
+
+    std::string str;
+    ASSERT_TRUE(client.read(str, 3));
+    EXPECT_EQ(str, written[3]);
+
+    // out of range
+    EXPECT_FALSE(client.read(str, N_STRINGS));
+    EXPECT_FALSE(client.read(str, -1));
+    EXPECT_FALSE(server.write(written, 1));
+
+    // clients can write too
+    ASSERT_TRUE(client.write(std::string("from client"), 7));
+    ASSERT_TRUE(server.read(str, 7));
+    EXPECT_EQ(str, "from client");
+
+    client.close();
+    server.close();
+
+}
+
+TEST(StringTensorTest, LongStringsAreSupported) {
+
+    StringTensor<StrServer> server(4, "LongStrings", name_space,
+                            false, VLevel::V0, false, false,
+                            100000); // arena [bytes]
+    server.run();
+
+    StringTensor<StrClient> client("LongStrings", name_space);
+    client.run();
+
+    std::vector<std::string> written = {make_string(0, 5000),
+                                    "",
+                                    make_string(2, 1025),
+                                    make_string(3, 40000)};
+
+    std::vector<std::string> read(written.size());
+
+    ASSERT_TRUE(server.write(written, 0));
+    ASSERT_TRUE(client.read(read, 0));
+
+    EXPECT_EQ(read, written);
+
+    client.close();
+    server.close();
+
+}
+
+TEST(StringTensorTest, RewritesCompactTheArena) {
+
+    int length = 8;
+    int arena_bytes = 256; // only a few rewrites fit before compacting
+
+    StringTensor<StrServer> server(length, "Compaction", name_space,
+                            false, VLevel::V0, false, false,
+                            arena_bytes);
+    server.run();
+
+    StringTensor<StrClient> client("Compaction", name_space);
+    client.run();
+
+    std::vector<std::string> expected(length), read(length);
+
+    for (int i = 0; i < 1000; ++i) {
+
+        int index = i % length;
+
+        expected[index] = make_string(i, 1 + i % 30); // different lengths
+
+        ASSERT_TRUE(client.write(expected[index], index));
+
+        ASSERT_TRUE(client.read(read, 0));
+        ASSERT_EQ(read, expected);
+
+    }
+
+    // the whole list can't fit, not even after compacting -> nothing changes
+    std::string too_long = make_string(0, arena_bytes);
+
+    EXPECT_FALSE(server.write(too_long, 0));
+
+    ASSERT_TRUE(server.read(read, 0));
+    EXPECT_EQ(read, expected);
+
+    client.close();
+    server.close();
+
+}
+
+TEST(StringTensorTest, WritersPreserveEachOthersStrings) {
+
+    // the client's local copy of the arena never saw what the server wrote
+    StringTensor<StrServer> server(4, "SharedRows", name_space);
+    server.run();
+
+    StringTensor<StrClient> client("SharedRows", name_space);
+    client.run();
+
+    std::vector<std::string> expected = {"abcdefg", "", "", ""};
+    std::vector<std::string> read(expected.size());
+
+    ASSERT_TRUE(server.write(expected, 0));
+
+    ASSERT_TRUE(client.write(std::string("XYZ"), 1)); // same arena row
+    expected[1] = "XYZ";
+
+    ASSERT_TRUE(client.read(read, 0));
+    EXPECT_EQ(read, expected);
+
+    ASSERT_TRUE(server.read(read, 0));
+    EXPECT_EQ(read, expected);
+
+    ASSERT_TRUE(server.write(std::string("server again"), 2));
+    expected[2] = "server again";
+
+    ASSERT_TRUE(client.read(read, 0));
+    EXPECT_EQ(read, expected);
+
+    client.close();
+    server.close();
+
+}
+
+TEST(StringTensorTest, ConcurrentWritersPreserveEachOthersStrings) {
+
+    // the server and two clients keep writing their own columns at the same
+    // time; the arena is small, so that they also compact it every now and then
+    int length = 12;
+    int n_writers = 3;
+    int n_writes = 50000;
+
+    StringTensor<StrServer> server(length, "ConcurrentWriters", name_space,
+                            false, VLevel::V0, false,
+                            true, // safe
+                            512); // arena [bytes]
+    server.run();
+
+    std::vector<std::unique_ptr<StringTensor<StrClient>>> clients;
+
+    for (int i = 1; i < n_writers; ++i) {
+
+        clients.push_back(std::make_unique<StringTensor<StrClient>>(
+                                "ConcurrentWriters", name_space));
+        clients.back()->run();
+    }
+
+    std::vector<std::string> expected(length);
+    std::atomic<int> n_failures(0);
+
+    auto writer = [&](auto& string_tensor, int id) {
+
+        std::vector<std::string> all(length);
+
+        for (int i = 0; i < n_writes; ++i) {
+
+            int index = id + n_writers * (i % (length / n_writers)); // own columns
+
+            std::string written = make_string(id * n_writes + i, 1 + i % 20);
+
+            int attempts = 0;
+
+            while (!string_tensor.write(written, index) && ++attempts < 100000) {
+
+                std::this_thread::yield(); // busy
+            }
+
+            expected[index] = written; // only touched by this writer
+
+            attempts = 0;
+
+            while (!string_tensor.read(all, 0) && ++attempts < 100000) {
+
+                std::this_thread::yield();
+            }
+
+            // none of our strings was clobbered by the other writers
+            for (int col = id; col < length; col += n_writers) {
+
+                if (all[col] != expected[col]) {
+
+                    n_failures++;
+                }
+            }
+
+        }
+
+    };
+
+    std::vector<std::thread> threads;
+
+    threads.emplace_back([&]() { writer(server, 0); });
+
+    for (int i = 1; i < n_writers; ++i) {
+
+        threads.emplace_back([&, i]() { writer(*clients[i - 1], i); });
+    }
+
+    for (auto& thread : threads) {
+
+        thread.join();
+    }
+
+    EXPECT_EQ(n_failures, 0);
+
+    std::vector<std::string> read(length);
+
+    ASSERT_TRUE(server.read(read, 0));
+    EXPECT_EQ(read, expected);
+
+    ASSERT_TRUE(clients[0]->read(read, 0));
+    EXPECT_EQ(read, expected);
+
+    for (auto& client : clients) {
+
+        client->close();
+    }
+
+    server.close();
+
+}
+
+TEST(StringTensorTest, CachedReadsFollowWrites) {
+
+    StringTensor<StrServer> server(N_STRINGS, "CachedReads", name_space);
+    server.run();
+
+    StringTensor<StrClient> client("CachedReads", name_space);
+    client.run();
+
+    EXPECT_TRUE(client.isStale()); // never read
+
+    std::vector<std::string> expected(N_STRINGS), read(N_STRINGS);
+
+    for (int i = 0; i < N_STRINGS; ++i) {
+
+        expected[i] = make_string(i, 10 + i % 20);
+    }
+
+    ASSERT_TRUE(server.write(expected, 0));
+
+    ASSERT_TRUE(client.read(read, 0));
+    EXPECT_EQ(read, expected);
+    EXPECT_FALSE(client.isStale());
+
+    // served from the cache
+    std::vector<std::string> read_again(N_STRINGS);
+    ASSERT_TRUE(client.read(read_again, 0));
+    EXPECT_EQ(read_again, expected);
+
+    // a single string changes
+    expected[42] = "changed";
+    ASSERT_TRUE(server.write(expected[42], 42));
+
+    EXPECT_TRUE(client.isStale());
+
+    ASSERT_TRUE(client.read(read, 0));
+    EXPECT_EQ(read, expected);
+    EXPECT_FALSE(client.isStale());
+
+    // writes from the client itself (which may trigger a compaction)
+    // are picked up by its reads and by the server's
+    for (int i = 0; i < 200; ++i) {
+
+        int index = (7 * i) % N_STRINGS;
+
+        expected[index] = make_string(i, 1 + i % 50);
+
+        ASSERT_TRUE(client.write(expected[index], index));
+
+        std::string str;
+        ASSERT_TRUE(client.read(str, index));
+        ASSERT_EQ(str, expected[index]);
+    }
+
+    ASSERT_TRUE(client.read(read, 0));
+    EXPECT_EQ(read, expected);
+
+    EXPECT_TRUE(server.isStale());
+    ASSERT_TRUE(server.read(read, 0));
+    EXPECT_EQ(read, expected);
+    EXPECT_FALSE(server.isStale());
+
+    client.close();
+    server.close();
+
+}
+
+TEST(StringTensorTest, DefaultArenaIsCompact) {
+
+    int length = 5000;
+
+    StringTensor<StrServer> server(length, "Footprint", name_space);
+
+    // a few bytes per string instead of a fixed 1024 bytes slot
+    long long n_bytes = static_cast<long long>(server.getSharedMem().getNRows()) *
+                server.getSharedMem().getNCols() * sizeof(int);
+
+    std::cout << "Shared memory for " << length << " strings: " << n_bytes << " bytes" << std::endl;
+
+    EXPECT_LT(n_bytes, length * 1024 / 4);
+
+    server.close();
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,261 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+//
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+//
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#include <unistd.h>
+
+#include <EigenIPC/SymbolTable.hpp>
+#include <EigenIPC/Journal.hpp>
+
+using namespace EigenIPC;
+
+using VLevel = Journal::VLevel;
+
+static std::string name_space = "SymbolTableTests";
+
+int N_SYMBOLS = 5000;
+
+std::string link_name(int i) {
+
+    return "robot/link_" + std::to_string(i) + "/frame";
+
+}
+
+TEST(SymbolTableTest, IdsAreStableAcrossProcesses) {
+
+    SymbolTable<StrServer> server(N_SYMBOLS, "Links", name_space);
+    server.run();
+
+    SymbolTable<StrClient> client("Links", name_space);
+    client.run();
+
+    ASSERT_EQ(client.getCapacity(), N_SYMBOLS);
+
+    for (int i = 0; i < N_SYMBOLS; ++i) {
+
+        ASSERT_EQ(server.intern(link_name(i)), i); // IDs in interning order
+    }
+
+    EXPECT_EQ(server.size(), N_SYMBOLS);
+    EXPECT_EQ(client.size(), N_SYMBOLS);
+
+    // interning again does not add anything
+    EXPECT_EQ(server.intern(link_name(42)), 42);
+    EXPECT_EQ(client.intern(link_name(4999)), 4999);
+    EXPECT_EQ(client.size(), N_SYMBOLS);
+
+    std::string str;
+
+    for (int i = 0; i < N_SYMBOLS; ++i) {
+
+        ASSERT_EQ(client.find(link_name(i)), i);
+
+        ASSERT_TRUE(client.name(i, str));
+        ASSERT_EQ(str, link_name(i));
+    }
+
+    EXPECT_EQ(client.find("not a link"), -1);
+    EXPECT_EQ(server.find(""), -1);
+    EXPECT_FALSE(client.name(N_SYMBOLS, str));
+    EXPECT_FALSE(client.name(-1, str));
+
+    client.close();
+    server.close();
+
+}
+
+TEST(SymbolTableTest, ClientsCanIntern) {
+
+    SymbolTable<StrServer> server(100, "Sensors", name_space);
+    server.run();
+
+    SymbolTable<StrClient> client("Sensors", name_space);
+    client.run();
+
+    EXPECT_EQ(server.intern("imu"), 0);
+    EXPECT_EQ(client.intern("lidar"), 1);
+    EXPECT_EQ(client.intern(""), 2); // the empty string is a symbol too
+
+    EXPECT_EQ(server.find("lidar"), 1);
+    EXPECT_EQ(server.find(""), 2);
+    EXPECT_EQ(client.find("imu"), 0);
+
+    EXPECT_EQ(server.size(), 3);
+
+    client.close();
+    server.close();
+
+}
+
+TEST(SymbolTableTest, ConcurrentInterningAgrees) {
+
+    int n_threads = 4;
+    int n_names = 500; // the same names, in a different order per thread
+    std::vector<int> steps = {1, 3, 7, 9};
+
+    SymbolTable<StrServer> server(n_names, "Concurrent", name_space);
+    server.run();
+
+    std::vector<std::vector<int>> ids(n_threads, std::vector<int>(n_names, -1));
+
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < n_threads; ++t) {
+
+        threads.emplace_back([&, t]() {
+
+            SymbolTable<StrClient> client("Concurrent", name_space);
+            client.run();
+
+            for (int i = 0; i < n_names; ++i) {
+
+                int index = (i * steps[t]) % n_names; // steps are coprime
+                // with n_names -> each thread goes through all the names
+
+                ids[t][index] = client.intern(link_name(index));
+            }
+
+            client.close();
+
+        });
+
+    }
+
+    for (auto& thread : threads) {
+
+        thread.join();
+    }
+
+    ASSERT_EQ(server.size(), n_names); // no duplicates
+
+    std::vector<bool> taken(n_names, false);
+
+    for (int i = 0; i < n_names; ++i) {
+
+        int id = server.find(link_name(i));
+
+        ASSERT_GE(id, 0);
+        ASSERT_LT(id, n_names);
+        ASSERT_FALSE(taken[id]);
+
+        taken[id] = true;
+
+        for (int t = 0; t < n_threads; ++t) {
+
+            ASSERT_EQ(ids[t][i], id);
+        }
+    }
+
+    server.close();
+
+}
+
+TEST(SymbolTableTest, FullTableRejectsNewSymbols) {
+
+    SymbolTable<StrServer> server(3, "Full", name_space);
+    server.run();
+
+    EXPECT_EQ(server.intern("a"), 0);
+    EXPECT_EQ(server.intern("b"), 1);
+    EXPECT_EQ(server.intern("c"), 2);
+
+    EXPECT_EQ(server.intern("d"), -1);
+    EXPECT_EQ(server.intern("b"), 1); // existing ones are still found
+
+    EXPECT_EQ(server.size(), 3);
+
+    server.close();
+
+}
+
+TEST(SymbolTableTest, TakeoverKeepsTheNewWritersMutex) {
+
+    std::string mutex_file = "/dev/shm/" + name_space + "Takeover_writers";
+
+    SymbolTable<StrServer> old_server(10, "Takeover", name_space);
+    old_server.run();
+
+    SymbolTable<StrServer> server(10, "Takeover", name_space,
+                        false, VLevel::V0,
+                        true); // force_reconnection
+    server.run();
+
+    old_server.close(); // must not remove the new server's mutex
+    old_server.close(); // (no-op)
+
+    ASSERT_EQ(access(mutex_file.c_str(), F_OK), 0);
+
+    SymbolTable<StrClient> client("Takeover", name_space);
+    client.run();
+
+    EXPECT_EQ(client.intern("imu"), 0);
+    EXPECT_EQ(server.intern("imu"), 0);
+
+    client.close();
+    server.close();
+
+    EXPECT_NE(access(mutex_file.c_str(), F_OK), 0); // gone with its server
+
+}
+
+TEST(SymbolTableTest, LookupBenchmark) {
+
+    SymbolTable<StrServer> server(N_SYMBOLS, "LookupBench", name_space);
+    server.run();
+
+    SymbolTable<StrClient> client("LookupBench", name_space);
+    client.run();
+
+    std::vector<std::string> names(N_SYMBOLS);
+
+    for (int i = 0; i < N_SYMBOLS; ++i) {
+
+        names[i] = link_name(i);
+
+        server.intern(names[i]);
+    }
+
+    int sum = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < N_SYMBOLS; ++i) {
+        sum += client.find(names[i]);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double find_time = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() /
+                static_cast<double>(N_SYMBOLS);
+
+    std::cout << "Average lookup time (" << N_SYMBOLS << " symbols): " << find_time << " ns" << std::endl;
+
+    EXPECT_EQ(sum, N_SYMBOLS * (N_SYMBOLS - 1) / 2);
+
+    client.close();
+    server.close();
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
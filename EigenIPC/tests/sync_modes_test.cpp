@@ -0,0 +1,1618 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+//
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+//
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/wait.h>
+#include <sys/epoll.h>
+#include <poll.h>
+#include <Eigen/Dense>
+
+#include <EigenIPC/Server.hpp>
+#include <EigenIPC/Client.hpp>
+#include <EigenIPC/Journal.hpp>
+
+#include <test_utils.hpp>
+
+// private headers
+#include <SyncUtils.hpp>
+
+using namespace EigenIPC;
+
+using VLevel = Journal::VLevel;
+
+static std::string name_space = "SyncModeTests";
+
+int N_WRITES = 20000;
+
+int N_ROWS = 200;
+int N_COLS = 50;
+
+// the writer always writes tensors filled with a single value:
+// any reader seeing more than one value got a torn (inconsistent) copy
+template <typename Scalar, int Layout>
+bool isUniform(const Tensor<Scalar, Layout>& t) {
+
+    return (t.array() == t(0, 0)).all();
+
+}
+
+class SeqLockTest : public ::testing::Test {
+protected:
+
+    SeqLockTest() :
+        server_ptr(new Server<double>(N_ROWS, N_COLS,
+                            "SeqLock", name_space,
+                            false,
+                            VLevel::V0,
+                            true,
+                            true,
+                            SyncMode::SeqLock)),
+        client_ptr(new Client<double>("SeqLock", name_space,
+                            false,
+                            VLevel::V0,
+                            true)) {
+
+        server_ptr->run();
+        client_ptr->attach();
+
+    }
+
+    void TearDown() override {
+
+        client_ptr->close();
+        server_ptr->close();
+
+    }
+
+    Server<double>::UniquePtr server_ptr;
+    Client<double>::UniquePtr client_ptr;
+
+};
+
+TEST_F(SeqLockTest, ModeIsSharedWithClients) {
+
+    ASSERT_EQ(server_ptr->getSyncMode(), SyncMode::SeqLock);
+    ASSERT_EQ(client_ptr->getSyncMode(), SyncMode::SeqLock);
+
+}
+
+TEST_F(SeqLockTest, ReadsAreNeverTorn) {
+
+    std::atomic<bool> done(false);
+
+    std::thread writer([&]() {
+
+        Tensor<double> data(N_ROWS, N_COLS);
+
+        for (int i = 1; i <= N_WRITES; ++i) {
+
+            data.setConstant(i);
+
+            // writer never waits for readers
+            ASSERT_TRUE(server_ptr->write(data, 0, 0));
+        }
+
+        done = true;
+
+    });
+
+    Tensor<double> output(N_ROWS, N_COLS);
+
+    int n_reads = 0;
+    int n_torn = 0;
+    double last_read = 0;
+
+    while (!done) {
+
+        if (client_ptr->read(output, 0, 0)) {
+
+            if (!isUniform(output)) {
+                n_torn++;
+            }
+
+            ASSERT_GE(output(0, 0), last_read); // never going back in time
+
+            last_read = output(0, 0);
+
+            n_reads++;
+        }
+
+    }
+
+    writer.join();
+
+    ASSERT_TRUE(client_ptr->read(output, 0, 0));
+    ASSERT_EQ(output(0, 0), N_WRITES);
+
+    ASSERT_GT(n_reads, 0);
+    ASSERT_EQ(n_torn, 0);
+
+}
+
+int N_STRIPES = 4;
+
+class StripedTest : public ::testing::Test {
+protected:
+
+    StripedTest() :
+        server_ptr(new Server<double>(N_ROWS, N_COLS,
+                            "Striped", name_space,
+                            false,
+                            VLevel::V0,
+                            true,
+                            true,
+                            SyncMode::Striped,
+                            N_STRIPES)),
+        client_ptr(new Client<double>("Striped", name_space,
+                            false,
+                            VLevel::V0,
+                            true)) {
+
+        server_ptr->run();
+        client_ptr->attach();
+
+    }
+
+    void TearDown() override {
+
+        client_ptr->close();
+        server_ptr->close();
+
+    }
+
+    Server<double>::UniquePtr server_ptr;
+    Client<double>::UniquePtr client_ptr;
+
+};
+
+TEST_F(StripedTest, ModeIsSharedWithClients) {
+
+    ASSERT_EQ(server_ptr->getSyncMode(), SyncMode::Striped);
+    ASSERT_EQ(client_ptr->getSyncMode(), SyncMode::Striped);
+
+}
+
+TEST_F(StripedTest, WholeTensorLockHoldsAllStripes) {
+
+    int rows_per_stripe = N_ROWS / N_STRIPES;
+
+    // the whole tensor is locked by the client
+    client_ptr->dataSemAcquire();
+
+    Tensor<double> block(rows_per_stripe, N_COLS);
+    block.setConstant(1.0);
+
+    // any block -> nonblocking write fails
+    ASSERT_FALSE(server_ptr->write(block, 0, 0));
+    ASSERT_FALSE(server_ptr->write(block, N_ROWS - rows_per_stripe, 0));
+    ASSERT_FALSE(server_ptr->write(block, rows_per_stripe / 2, 0)); // across two stripes
+
+    client_ptr->dataSemRelease();
+
+    ASSERT_TRUE(server_ptr->write(block, 0, 0));
+    ASSERT_TRUE(server_ptr->write(block, N_ROWS - rows_per_stripe, 0));
+
+    Tensor<double> output(N_ROWS, N_COLS);
+
+    ASSERT_TRUE(client_ptr->read(output, 0, 0));
+    ASSERT_TRUE((output.topRows(rows_per_stripe).array() == 1.0).all());
+    ASSERT_TRUE((output.bottomRows(rows_per_stripe).array() == 1.0).all());
+
+}
+
+TEST_F(StripedTest, ConcurrentBlockWriters) {
+
+    // one writer client per stripe, each only touching its own rows
+    int rows_per_stripe = N_ROWS / N_STRIPES;
+
+    std::vector<std::thread> writers;
+
+    for (int s = 0; s < N_STRIPES; ++s) {
+
+        writers.emplace_back([&, s]() {
+
+            Client<double> writer("Striped", name_space,
+                            false,
+                            VLevel::V0,
+                            true);
+
+            writer.attach();
+
+            Tensor<double> block(rows_per_stripe, N_COLS);
+
+            for (int i = 1; i <= N_WRITES; ++i) {
+
+                block.setConstant(s * N_WRITES + i);
+
+                while (!writer.write(block, s * rows_per_stripe, 0)) {
+                    // the stripe can only be busy because of the reader
+                }
+
+            }
+
+            writer.close();
+
+        });
+
+    }
+
+    Tensor<double> output(rows_per_stripe, N_COLS);
+
+    int n_torn = 0;
+
+    for (int i = 0; i < N_WRITES; ++i) {
+
+        int s = i % N_STRIPES;
+
+        if (client_ptr->read(output, s * rows_per_stripe, 0) &&
+                !isUniform(output)) {
+
+            n_torn++;
+        }
+
+    }
+
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    ASSERT_EQ(n_torn, 0);
+
+    for (int s = 0; s < N_STRIPES; ++s) {
+
+        ASSERT_TRUE(client_ptr->read(output, s * rows_per_stripe, 0));
+        ASSERT_EQ(output(0, 0), s * N_WRITES + N_WRITES);
+
+    }
+
+}
+
+int N_SLOTS = 3;
+
+class RingTest : public ::testing::Test {
+protected:
+
+    RingTest() :
+        server_ptr(new Server<double>(N_ROWS, N_COLS,
+                            "Ring", name_space,
+                            false,
+                            VLevel::V0,
+                            true,
+                            true,
+                            SyncMode::Ring,
+                            1,
+                            N_SLOTS)),
+        client_ptr(new Client<double>("Ring", name_space,
+                            false,
+                            VLevel::V0,
+                            true)) {
+
+        server_ptr->run();
+        client_ptr->attach();
+
+    }
+
+    void TearDown() override {
+
+        client_ptr->close();
+        server_ptr->close();
+
+    }
+
+    Server<double>::UniquePtr server_ptr;
+    Client<double>::UniquePtr client_ptr;
+
+};
+
+TEST_F(RingTest, ModeIsSharedWithClients) {
+
+    ASSERT_EQ(server_ptr->getSyncMode(), SyncMode::Ring);
+    ASSERT_EQ(client_ptr->getSyncMode(), SyncMode::Ring);
+
+}
+
+TEST_F(RingTest, PartialWritesKeepLatestData) {
+
+    Tensor<double> data(N_ROWS, N_COLS);
+    data.setConstant(1.0);
+
+    ASSERT_TRUE(server_ptr->write(data, 0, 0));
+
+    // more writes than slots, each touching a single row
+    Tensor<double> row(1, N_COLS);
+
+    for (int i = 0; i < 2 * N_SLOTS; ++i) {
+
+        row.setConstant(i + 2);
+
+        ASSERT_TRUE(server_ptr->write(row, i, 0));
+
+    }
+
+    Tensor<double> output(N_ROWS, N_COLS);
+
+    ASSERT_TRUE(client_ptr->read(output, 0, 0));
+
+    for (int i = 0; i < 2 * N_SLOTS; ++i) {
+
+        ASSERT_TRUE((output.row(i).array() == i + 2).all());
+
+    }
+
+    ASSERT_TRUE((output.bottomRows(N_ROWS - 2 * N_SLOTS).array() == 1.0).all());
+
+    // out of bounds writes are not published
+    ASSERT_FALSE(server_ptr->write(data, 1, 0));
+
+    Tensor<double> output_after(N_ROWS, N_COLS);
+
+    ASSERT_TRUE(client_ptr->read(output_after, 0, 0));
+    ASSERT_TRUE(output_after == output);
+
+}
+
+TEST_F(RingTest, ReadsDoNotWaitForWriters) {
+
+    // writers are holding the data semaphore
+    server_ptr->dataSemAcquire();
+
+    Tensor<double> output(N_ROWS, N_COLS);
+
+    ASSERT_TRUE(client_ptr->read(output, 0, 0));
+
+    server_ptr->dataSemRelease();
+
+}
+
+TEST_F(RingTest, ReadsAreNeverTorn) {
+
+    std::atomic<bool> done(false);
+
+    std::thread writer([&]() {
+
+        Tensor<double> data(N_ROWS, N_COLS);
+
+        for (int i = 1; i <= N_WRITES; ++i) {
+
+            data.setConstant(i);
+
+            ASSERT_TRUE(server_ptr->write(data, 0, 0));
+        }
+
+        done = true;
+
+    });
+
+    Tensor<double> output(N_ROWS, N_COLS);
+
+    int n_reads = 0;
+    int n_torn = 0;
+    double last_read = 0;
+
+    while (!done) {
+
+        if (client_ptr->read(output, 0, 0)) {
+
+            if (!isUniform(output)) {
+                n_torn++;
+            }
+
+            ASSERT_GE(output(0, 0), last_read); // never going back in time
+
+            last_read = output(0, 0);
+
+            n_reads++;
+        }
+
+    }
+
+    writer.join();
+
+    ASSERT_TRUE(client_ptr->read(output, 0, 0));
+    ASSERT_EQ(output(0, 0), N_WRITES);
+
+    ASSERT_GT(n_reads, 0);
+    ASSERT_EQ(n_torn, 0);
+
+}
+
+TEST(DataLockTest, RecoveredFromDeadOwner) {
+
+    Server<double> server(N_ROWS, N_COLS,
+                "DataLock", name_space,
+                false,
+                VLevel::V0,
+                true,
+                true);
+
+    server.run();
+
+    Tensor<double> data(N_ROWS, N_COLS);
+    data.setConstant(1.0);
+
+    pid_t pid = fork();
+
+    ASSERT_NE(pid, -1);
+
+    if (pid == 0) {
+
+        // the child grabs the data lock and dies without releasing it
+        Client<double> client("DataLock", name_space,
+                false,
+                VLevel::V0,
+                true);
+
+        client.attach();
+
+        client.dataSemAcquire();
+
+        _exit(0);
+
+    }
+
+    int status = 0;
+
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+
+    // no need to wait: the lock is taken over right away
+    ASSERT_TRUE(server.write(data, 0, 0));
+
+    // and properly released afterwards
+    server.dataSemAcquire();
+    server.dataSemRelease();
+
+    Tensor<double> output(N_ROWS, N_COLS);
+
+    ASSERT_TRUE(server.read(output, 0, 0));
+    ASSERT_TRUE(output == data);
+
+    server.close();
+
+}
+
+TEST(DataLockTest, BlockingWaitersAreWokenUp) {
+
+    Server<double> server(N_ROWS, N_COLS,
+                "DataLock", name_space,
+                false,
+                VLevel::V0,
+                true,
+                true);
+
+    server.run();
+
+    Client<double> client("DataLock", name_space,
+                false,
+                VLevel::V0,
+                true);
+
+    client.attach();
+
+    std::atomic<int> n_acquired(0);
+
+    server.dataSemAcquire();
+
+    std::thread waiter([&]() {
+
+        for (int i = 0; i < 1000; ++i) {
+
+            client.dataSemAcquire(); // blocking (sleeps on contention)
+            n_acquired++;
+            client.dataSemRelease();
+
+        }
+
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    ASSERT_EQ(n_acquired, 0);
+
+    server.dataSemRelease();
+
+    for (int i = 0; i < 1000; ++i) {
+
+        server.dataSemAcquire();
+        server.dataSemRelease();
+
+    }
+
+    waiter.join();
+
+    ASSERT_EQ(n_acquired, 1000);
+
+    client.close();
+    server.close();
+
+}
+
+// number of shared memory objects (semaphores excluded) whose name starts with prefix
+int countShmObjects(const std::string& prefix) {
+
+    int count = 0;
+
+    DIR* dir = opendir("/dev/shm");
+
+    if (dir == nullptr) {
+        return -1;
+    }
+
+    while (struct dirent* entry = readdir(dir)) {
+
+        std::string name(entry->d_name);
+
+        if (name.rfind(prefix, 0) == 0) {
+            count++;
+        }
+
+    }
+
+    closedir(dir);
+
+    return count;
+
+}
+
+TEST(MemHeaderTest, SingleSegmentPerTensor) {
+
+    Server<float> server(N_ROWS, N_COLS,
+                "Header", name_space,
+                false,
+                VLevel::V0,
+                true,
+                true);
+
+    server.run();
+
+    Client<float> client("Header", name_space,
+                false,
+                VLevel::V0,
+                true);
+
+    client.attach();
+
+    // metadata, locks and data all live in the same segment
+    ASSERT_EQ(countShmObjects(name_space + "Header"), 1);
+
+    ASSERT_EQ(client.getNRows(), N_ROWS);
+    ASSERT_EQ(client.getNCols(), N_COLS);
+    ASSERT_EQ(client.getScalarType(), DType::Float);
+    ASSERT_EQ(server.getNClients(), 1);
+
+    client.close();
+
+    ASSERT_EQ(server.getNClients(), 0);
+
+    server.close();
+
+}
+
+TEST(MemHeaderTest, ClientsWaitForServerMemory) {
+
+    Client<float> client("Header", name_space,
+                false,
+                VLevel::V0,
+                true);
+
+    Server<float>::UniquePtr server_ptr;
+
+    std::thread server_starter([&]() {
+
+        // the memory does not exist yet when the client starts waiting
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        server_ptr.reset(new Server<float>(N_ROWS, N_COLS,
+                            "Header", name_space,
+                            false,
+                            VLevel::V0,
+                            true,
+                            true));
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        server_ptr->run();
+
+    });
+
+    client.attach(); // blocking
+
+    server_starter.join();
+
+    ASSERT_TRUE(client.isAttached());
+    ASSERT_EQ(client.getNRows(), N_ROWS);
+    ASSERT_EQ(server_ptr->getNClients(), 1);
+
+    client.close();
+    server_ptr->close();
+
+}
+
+TEST(MemHeaderTest, ClientsReattachToNewServer) {
+
+    Server<float>::UniquePtr server_ptr(new Server<float>(N_ROWS, N_COLS,
+                            "Header", name_space,
+                            false,
+                            VLevel::V0,
+                            true,
+                            true));
+
+    server_ptr->run();
+
+    Client<float> client("Header", name_space,
+                false,
+                VLevel::V0,
+                true);
+
+    client.attach();
+    client.detach();
+
+    server_ptr->close();
+
+    // a new server creates a new (bigger) memory
+    server_ptr.reset(new Server<float>(2 * N_ROWS, N_COLS,
+                            "Header", name_space,
+                            false,
+                            VLevel::V0,
+                            true,
+                            true));
+
+    server_ptr->run();
+
+    Tensor<float> data(2 * N_ROWS, N_COLS);
+    data.setConstant(3.0);
+
+    ASSERT_TRUE(server_ptr->write(data, 0, 0));
+
+    client.attach(); // the stale memory is dropped
+
+    Tensor<float> output(2 * N_ROWS, N_COLS);
+
+    ASSERT_EQ(client.getNRows(), 2 * N_ROWS);
+    ASSERT_TRUE(client.read(output, 0, 0));
+    ASSERT_TRUE(output == data);
+    ASSERT_EQ(server_ptr->getNClients(), 1);
+
+    client.close();
+    server_ptr->close();
+
+}
+
+TEST(MemHeaderTest, ClientsAttachRightAfterRun) {
+
+    Server<float> server(N_ROWS, N_COLS,
+                "Discovery", name_space,
+                false,
+                VLevel::V0,
+                true,
+                true);
+
+    Client<float> client("Discovery", name_space);
+
+    std::atomic<long long> attached_ns(0);
+
+    std::thread attacher([&]() {
+
+        client.attach(); // sleeping until the server runs
+
+        attached_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    long long run_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    server.run();
+
+    attacher.join();
+
+    double latency_us = (attached_ns - run_ns) / 1000.0;
+
+    std::cout << "run() -> attach() latency [us]: " << latency_us << std::endl;
+
+    // woken up by the server (not by the periodic check)
+    ASSERT_LT(latency_us, 5000.0);
+
+    client.close();
+    server.close();
+
+}
+
+TEST(MemHeaderTest, AttachAllWaitsForAllServers) {
+
+    const int n_tensors = 16;
+
+    std::vector<Client<double>::UniquePtr> clients;
+    std::vector<Client<double>*> client_ptrs;
+
+    for (int i = 0; i < n_tensors; ++i) {
+
+        clients.emplace_back(new Client<double>("AttachAll" + std::to_string(i), name_space));
+        client_ptrs.push_back(clients.back().get());
+    }
+
+    std::vector<Server<double>::UniquePtr> servers(n_tensors);
+
+    std::thread starter([&]() {
+
+        // started in reverse order, some of them before being waited for
+        for (int i = n_tensors - 1; i >= 0; --i) {
+
+            servers[i].reset(new Server<double>(2, 2,
+                            "AttachAll" + std::to_string(i), name_space,
+                            false, VLevel::V0, true));
+
+            servers[i]->run();
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+    });
+
+    ASSERT_TRUE(Client<double>::attachAll(client_ptrs, 5000));
+
+    starter.join();
+
+    for (int i = 0; i < n_tensors; ++i) {
+
+        ASSERT_TRUE(clients[i]->isAttached());
+        ASSERT_EQ(servers[i]->getNClients(), 1);
+    }
+
+    // one server is missing: the others are attached anyway
+    Client<double> missing("AttachAllMissing", name_space);
+    Client<double> other("AttachAll0", name_space);
+
+    auto start = std::chrono::steady_clock::now();
+
+    ASSERT_FALSE(Client<double>::attachAll({&missing, &other}, 30));
+
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(30));
+
+    ASSERT_FALSE(missing.isAttached());
+    ASSERT_TRUE(other.isAttached());
+
+    other.close();
+    missing.close();
+
+    for (int i = 0; i < n_tensors; ++i) {
+
+        clients[i]->close();
+        servers[i]->close();
+    }
+
+}
+
+TEST(ClientRegistryTest, ConcurrentAttachesAreCounted) {
+
+    Server<float> server(4, 4,
+                "Registry", name_space,
+                false,
+                VLevel::V0,
+                true,
+                true);
+
+    server.run();
+
+    const int n_threads = 8;
+    const int n_cycles = 50;
+
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < n_threads; ++t) {
+
+        threads.emplace_back([&]() {
+
+            for (int i = 0; i < n_cycles; ++i) {
+
+                Client<float> client("Registry", name_space);
+
+                client.attach();
+                client.detach();
+            }
+
+        });
+
+    }
+
+    std::vector<Client<float>::UniquePtr> clients;
+
+    for (int i = 0; i < 10; ++i) {
+
+        clients.emplace_back(new Client<float>("Registry", name_space));
+        clients.back()->attach();
+    }
+
+    for (auto& thread : threads) {
+
+        thread.join();
+    }
+
+    ASSERT_EQ(server.getNClients(), 10); // no lost updates
+
+    for (auto& client : clients) {
+
+        client->close();
+    }
+
+    ASSERT_EQ(server.getNClients(), 0);
+
+    server.close();
+
+}
+
+TEST(ClientRegistryTest, CrashedClientsAreReaped) {
+
+    Server<float> server(4, 4,
+                "Registry", name_space,
+                false,
+                VLevel::V0,
+                true,
+                true);
+
+    server.run();
+
+    Client<float> client("Registry", name_space);
+
+    client.attach();
+
+    const int n_children = 3;
+
+    for (int c = 0; c < n_children; ++c) {
+
+        pid_t pid = fork();
+
+        ASSERT_NE(pid, -1);
+
+        if (pid == 0) {
+
+            // attaches and dies without detaching
+            Client<float> child_client("Registry", name_space);
+
+            child_client.attach();
+
+            _exit(0);
+
+        }
+
+        int status = 0;
+
+        ASSERT_EQ(waitpid(pid, &status, 0), pid);
+
+    }
+
+    // scans for dead clients are rate limited
+    std::this_thread::sleep_for(std::chrono::nanoseconds(SyncUtils::REAP_PERIOD_NS));
+
+    ASSERT_EQ(server.getNClients(), 1);
+
+    client.close();
+
+    ASSERT_EQ(server.getNClients(), 0);
+
+    server.close();
+
+}
+
+TEST(ClientRegistryTest, IdleClientsAreReported) {
+
+    Server<float> server(4, 4,
+                "Registry", name_space,
+                false,
+                VLevel::V0,
+                true,
+                true);
+
+    server.run();
+
+    Client<float> busy("Registry", name_space);
+    Client<float> idle("Registry", name_space);
+
+    busy.attach();
+    idle.attach();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    Tensor<float> output(4, 4);
+
+    ASSERT_TRUE(busy.read(output, 0, 0)); // heartbeat
+
+    // both live in this process: only one of them is idle
+    ASSERT_EQ(server.getIdleClients(50), std::vector<int>({static_cast<int>(getpid())}));
+    ASSERT_TRUE(server.getIdleClients(10000).empty());
+
+    busy.close();
+    idle.close();
+
+    server.close();
+
+}
+
+class ViewTest : public ::testing::TestWithParam<SyncMode> {
+protected:
+
+    ViewTest() :
+        server_ptr(new Server<double>(N_ROWS, N_COLS,
+                            "View", name_space,
+                            false,
+                            VLevel::V0,
+                            true,
+                            true,
+                            GetParam(),
+                            N_STRIPES,
+                            N_SLOTS)),
+        client_ptr(new Client<double>("View", name_space,
+                            false,
+                            VLevel::V0,
+                            true)) {
+
+        server_ptr->run();
+        client_ptr->attach();
+
+    }
+
+    void TearDown() override {
+
+        client_ptr->close();
+        server_ptr->close();
+
+    }
+
+    Server<double>::UniquePtr server_ptr;
+    Client<double>::UniquePtr client_ptr;
+
+};
+
+TEST_P(ViewTest, WriteViewIsSeenByReaders) {
+
+    Tensor<double> data(N_ROWS, N_COLS);
+    data.setConstant(1.0);
+
+    ASSERT_TRUE(server_ptr->write(data, 0, 0));
+
+    {
+        // computing directly into shared memory
+        Server<double>::WriteView view = server_ptr->acquireView(10, 5, 20, 3);
+
+        ASSERT_TRUE(view.isValid());
+        ASSERT_EQ(view.data().rows(), 20);
+        ASSERT_EQ(view.data().cols(), 3);
+
+        view.data().setConstant(2.0);
+        view.data()(0, 0) = 3.0;
+
+    } // released (published) here
+
+    data.block(10, 5, 20, 3).setConstant(2.0);
+    data(10, 5) = 3.0;
+
+    Tensor<double> output(N_ROWS, N_COLS);
+
+    ASSERT_TRUE(client_ptr->read(output, 0, 0));
+    ASSERT_TRUE(output == data);
+
+    Client<double>::ReadView view = client_ptr->acquireView(10, 5, 20, 3);
+
+    ASSERT_TRUE(view.isValid());
+    ASSERT_TRUE(view.data() == data.block(10, 5, 20, 3));
+    ASSERT_EQ(view.data().sum(), 2.0 * 20 * 3 + 1.0); // no copy needed
+
+    ASSERT_TRUE(client_ptr->releaseView(view));
+    ASSERT_FALSE(view.isValid());
+    ASSERT_FALSE(client_ptr->releaseView(view)); // already released
+
+}
+
+TEST_P(ViewTest, OutOfBoundsViewsAreInvalid) {
+
+    ASSERT_FALSE(client_ptr->acquireView(N_ROWS - 1, 0, 2, 1).isValid());
+    ASSERT_FALSE(server_ptr->acquireView(0, N_COLS, 1, 1).isValid());
+
+    // nothing was left locked
+    ASSERT_TRUE(client_ptr->acquireView(0, 0, N_ROWS, N_COLS).isValid());
+
+}
+
+TEST_P(ViewTest, BorrowedDataIsProtected) {
+
+    Tensor<double> data(N_ROWS, N_COLS);
+    data.setConstant(1.0);
+
+    Client<double>::ReadView view = client_ptr->acquireView(0, 0, N_ROWS, N_COLS);
+
+    ASSERT_TRUE(view.isValid());
+
+    if (GetParam() == SyncMode::Lock || GetParam() == SyncMode::Striped) {
+
+        // writers have to wait for the view to be released
+        ASSERT_FALSE(server_ptr->write(data, 0, 0));
+
+        ASSERT_TRUE(client_ptr->releaseView(view));
+
+    } else {
+
+        // writers never wait, but the reader is told that what it saw
+        // may have been overwritten
+        for (int i = 0; i < N_SLOTS; ++i) {
+
+            ASSERT_TRUE(server_ptr->write(data, 0, 0));
+        }
+
+        ASSERT_FALSE(client_ptr->releaseView(view));
+
+    }
+
+    ASSERT_TRUE(server_ptr->write(data, 0, 0));
+
+}
+
+INSTANTIATE_TEST_SUITE_P(SyncModes, ViewTest,
+                        ::testing::Values(SyncMode::Lock,
+                                        SyncMode::SeqLock,
+                                        SyncMode::Striped,
+                                        SyncMode::Ring));
+
+class UpdateTest : public ::testing::TestWithParam<SyncMode> {
+protected:
+
+    UpdateTest() :
+        server_ptr(new Server<double>(N_ROWS, N_COLS,
+                            "Update", name_space,
+                            false,
+                            VLevel::V0,
+                            true,
+                            true,
+                            GetParam(),
+                            N_STRIPES,
+                            N_SLOTS)),
+        client_ptr(new Client<double>("Update", name_space,
+                            false,
+                            VLevel::V0,
+                            true)) {
+
+        server_ptr->run();
+        client_ptr->attach();
+
+    }
+
+    void TearDown() override {
+
+        client_ptr->close();
+        server_ptr->close();
+
+    }
+
+    Server<double>::UniquePtr server_ptr;
+    Client<double>::UniquePtr client_ptr;
+
+};
+
+TEST_P(UpdateTest, TimesOutWithoutWrites) {
+
+    auto start = std::chrono::steady_clock::now();
+
+    ASSERT_FALSE(client_ptr->waitForUpdate(20));
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_GE(elapsed, std::chrono::milliseconds(20));
+
+}
+
+TEST_P(UpdateTest, PastWritesAreReportedOnce) {
+
+    Tensor<double> data(N_ROWS, N_COLS);
+    data.setConstant(1.0);
+
+    ASSERT_TRUE(server_ptr->write(data, 0, 0));
+    ASSERT_TRUE(server_ptr->write(data, 0, 0));
+
+    ASSERT_TRUE(client_ptr->waitForUpdate(0)); // both writes at once
+    ASSERT_FALSE(client_ptr->waitForUpdate(0));
+
+    {
+        Server<double>::WriteView view = server_ptr->acquireView(0, 0, 1, 1);
+
+        ASSERT_TRUE(view.isValid());
+
+    } // releasing a view also counts as a write
+
+    ASSERT_TRUE(client_ptr->waitForUpdate(0));
+
+}
+
+TEST_P(UpdateTest, WaitersAreWokenUpByWrites) {
+
+    Tensor<double> data(N_ROWS, N_COLS);
+
+    const int n_updates = 100;
+
+    std::atomic<int> n_woken(0);
+    std::atomic<bool> done(false);
+
+    std::thread waiter([&]() {
+
+        Tensor<double> output(N_ROWS, N_COLS);
+
+        while (client_ptr->waitForUpdate(1000)) {
+
+            ASSERT_TRUE(client_ptr->read(output, 0, 0));
+
+            n_woken++;
+
+            if (output(0, 0) == n_updates - 1) {
+                break; // seen the last write
+            }
+
+        }
+
+        done = true;
+
+    });
+
+    for (int i = 0; i < n_updates; ++i) {
+
+        data.setConstant(i);
+
+        ASSERT_TRUE(server_ptr->write(data, 0, 0));
+
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+
+    }
+
+    waiter.join();
+
+    ASSERT_TRUE(done);
+    ASSERT_GT(n_woken, 0);
+    ASSERT_LE(n_woken, n_updates);
+
+}
+
+TEST_P(UpdateTest, WaitersGiveUpWhenServerStops) {
+
+    std::thread stopper([&]() {
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+        server_ptr->stop();
+
+    });
+
+    ASSERT_FALSE(client_ptr->waitForUpdate()); // no timeout
+
+    stopper.join();
+
+}
+
+TEST_P(UpdateTest, NotifyFdIsSignaledByWrites) {
+
+    ASSERT_EQ(client_ptr->getNotifyFd(), -1); // not exposed by the server
+
+    ASSERT_TRUE(server_ptr->enableNotifyFd());
+
+    int fd = client_ptr->getNotifyFd();
+
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(client_ptr->getNotifyFd(), fd); // registered once
+
+    pollfd pfd = {fd, POLLIN, 0};
+
+    ASSERT_EQ(poll(&pfd, 1, 0), 0);
+
+    Tensor<double> data(N_ROWS, N_COLS);
+    data.setConstant(1.0);
+
+    ASSERT_TRUE(server_ptr->write(data, 0, 0));
+    ASSERT_TRUE(server_ptr->write(data, 0, 0));
+
+    ASSERT_EQ(poll(&pfd, 1, 1000), 1);
+
+    ASSERT_EQ(client_ptr->clearNotify(), 2);
+    ASSERT_EQ(client_ptr->clearNotify(), 0); // rearmed
+
+    ASSERT_EQ(poll(&pfd, 1, 0), 0);
+
+    server_ptr->stop();
+
+    ASSERT_EQ(poll(&pfd, 1, 1000), 1); // pollers find out the server stopped
+
+}
+
+INSTANTIATE_TEST_SUITE_P(SyncModes, UpdateTest,
+                        ::testing::Values(SyncMode::Lock,
+                                        SyncMode::SeqLock,
+                                        SyncMode::Striped,
+                                        SyncMode::Ring));
+
+TEST(NotifyFdTest, TensorsAreMultiplexedWithEpoll) {
+
+    const int n_tensors = 8;
+
+    std::vector<Server<float>::UniquePtr> servers;
+    std::vector<Client<float>::UniquePtr> clients;
+
+    int epoll_fd = epoll_create1(0);
+
+    ASSERT_GE(epoll_fd, 0);
+
+    for (int i = 0; i < n_tensors; ++i) {
+
+        std::string name = "Multiplexed" + std::to_string(i);
+
+        servers.emplace_back(new Server<float>(4, 4, name, name_space));
+        servers.back()->run();
+
+        ASSERT_TRUE(servers.back()->enableNotifyFd());
+
+        clients.emplace_back(new Client<float>(name, name_space));
+        clients.back()->attach();
+
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u32 = i; // tensor index
+
+        ASSERT_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_ADD,
+                        clients.back()->getNotifyFd(), &event), 0);
+
+    }
+
+    Tensor<float> data(4, 4);
+    data.setConstant(3.0);
+
+    // a single thread waits on all the tensors
+    for (int i = n_tensors - 1; i >= 0; i -= 3) {
+
+        ASSERT_TRUE(servers[i]->write(data, 0, 0));
+    }
+
+    std::vector<int> ready;
+
+    epoll_event events[n_tensors];
+
+    int n_events = epoll_wait(epoll_fd, events, n_tensors, 1000);
+
+    for (int e = 0; e < n_events; ++e) {
+
+        int i = events[e].data.u32;
+
+        ASSERT_EQ(clients[i]->clearNotify(), 1);
+
+        ready.push_back(i);
+    }
+
+    std::sort(ready.begin(), ready.end());
+
+    ASSERT_EQ(ready, std::vector<int>({1, 4, 7}));
+
+    ASSERT_EQ(epoll_wait(epoll_fd, events, n_tensors, 0), 0);
+
+    ::close(epoll_fd);
+
+    for (int i = 0; i < n_tensors; ++i) {
+
+        clients[i]->close();
+        servers[i]->close();
+    }
+
+}
+
+class DirtyRowsTest : public ::testing::TestWithParam<SyncMode> {
+protected:
+
+    DirtyRowsTest() :
+        server_ptr(new Server<double>(N_ROWS, N_COLS,
+                            "DirtyRows", name_space,
+                            false,
+                            VLevel::V0,
+                            true,
+                            true,
+                            GetParam(),
+                            N_STRIPES,
+                            N_SLOTS)),
+        client_ptr(new Client<double>("DirtyRows", name_space,
+                            false,
+                            VLevel::V0,
+                            true)) {
+
+        server_ptr->run();
+        client_ptr->attach();
+
+    }
+
+    void TearDown() override {
+
+        client_ptr->close();
+        server_ptr->close();
+
+    }
+
+    Server<double>::UniquePtr server_ptr;
+    Client<double>::UniquePtr client_ptr;
+
+};
+
+TEST_P(DirtyRowsTest, OnlyChangedRowsAreCopied) {
+
+    Tensor<double> data(N_ROWS, N_COLS);
+    data.setConstant(1.0);
+
+    ASSERT_TRUE(server_ptr->write(data, 0, 0));
+
+    Tensor<double> output(N_ROWS, N_COLS);
+    std::vector<int> changed_rows;
+    uint64_t version = 0;
+
+    ASSERT_TRUE(client_ptr->readChanged(output, version, changed_rows));
+    ASSERT_EQ(changed_rows.size(), N_ROWS); // first read -> everything
+    ASSERT_TRUE(output == data);
+    ASSERT_GT(version, 0);
+
+    output.setConstant(-1.0); // untouched rows keep this
+
+    Tensor<double> block(3, N_COLS);
+    block.setConstant(2.0);
+    ASSERT_TRUE(server_ptr->write(block, 10, 0));
+    data.block(10, 0, 3, N_COLS) = block;
+
+    Tensor<double> partial_row(1, 5);
+    partial_row.setConstant(3.0);
+    ASSERT_TRUE(server_ptr->write(partial_row, 50, 7));
+    data.block(50, 7, 1, 5) = partial_row;
+
+    {
+        Server<double>::WriteView view = server_ptr->acquireView(100, 0, 2, 1);
+
+        ASSERT_TRUE(view.isValid());
+
+        view.data().setConstant(4.0);
+        data.block(100, 0, 2, 1).setConstant(4.0);
+
+    }
+
+    ASSERT_TRUE(client_ptr->readChanged(output, version, changed_rows));
+    ASSERT_EQ(changed_rows, std::vector<int>({10, 11, 12, 50, 100, 101}));
+
+    for (int i = 0; i < N_ROWS; ++i) {
+
+        bool changed = std::find(changed_rows.begin(), changed_rows.end(), i) !=
+                        changed_rows.end();
+
+        if (changed) {
+            ASSERT_TRUE(output.row(i) == data.row(i));
+        } else {
+            ASSERT_TRUE((output.row(i).array() == -1.0).all());
+        }
+
+    }
+
+    uint64_t last_version = version;
+
+    ASSERT_TRUE(client_ptr->readChanged(output, version, changed_rows));
+    ASSERT_TRUE(changed_rows.empty());
+    ASSERT_EQ(version, last_version);
+
+}
+
+TEST_P(DirtyRowsTest, NoRowIsMissedUnderConcurrentWrites) {
+
+    std::atomic<bool> done(false);
+
+    std::thread writer([&]() {
+
+        Tensor<double> row_data(1, N_COLS);
+
+        for (int i = 0; i < N_WRITES; ++i) {
+
+            row_data.setConstant(i);
+
+            while (!server_ptr->write(row_data, (i * 7) % N_ROWS, 0)) {} // retry
+            // if the lock is held by the reader
+
+        }
+
+        done = true;
+
+    });
+
+    Tensor<double> output(N_ROWS, N_COLS);
+    std::vector<int> changed_rows;
+    uint64_t version = 0;
+
+    while (!done) {
+
+        client_ptr->readChanged(output, version, changed_rows);
+
+    }
+
+    writer.join();
+
+    ASSERT_TRUE(client_ptr->readChanged(output, version, changed_rows));
+
+    Tensor<double> data(N_ROWS, N_COLS);
+    ASSERT_TRUE(client_ptr->read(data, 0, 0));
+
+    ASSERT_TRUE(output == data); // incremental copy in sync with the full one
+
+}
+
+INSTANTIATE_TEST_SUITE_P(SyncModes, DirtyRowsTest,
+                        ::testing::Values(SyncMode::Lock,
+                                        SyncMode::SeqLock,
+                                        SyncMode::Striped,
+                                        SyncMode::Ring));
+
+class BatchTest : public ::testing::TestWithParam<SyncMode> {
+protected:
+
+    BatchTest() :
+        server_ptr(new Server<double>(N_ROWS, N_COLS,
+                            "Batch", name_space,
+                            false,
+                            VLevel::V0,
+                            true,
+                            true,
+                            GetParam(),
+                            N_STRIPES,
+                            N_SLOTS)),
+        client_ptr(new Client<double>("Batch", name_space,
+                            false,
+                            VLevel::V0,
+                            true)) {
+
+        server_ptr->run();
+        client_ptr->attach();
+
+    }
+
+    void TearDown() override {
+
+        client_ptr->close();
+        server_ptr->close();
+
+    }
+
+    Server<double>::UniquePtr server_ptr;
+    Client<double>::UniquePtr client_ptr;
+
+};
+
+TEST_P(BatchTest, WritesArePublishedOnCommit) {
+
+    Tensor<double> data(N_ROWS, N_COLS);
+    data.setConstant(1.0);
+
+    ASSERT_TRUE(server_ptr->write(data, 0, 0));
+
+    Tensor<double> output(N_ROWS, N_COLS);
+    std::vector<int> changed_rows;
+    uint64_t version = 0;
+
+    ASSERT_TRUE(client_ptr->readChanged(output, version, changed_rows));
+    ASSERT_TRUE(client_ptr->waitForUpdate(0));
+
+    Tensor<double> block(10, N_COLS);
+    block.setConstant(2.0);
+
+    ASSERT_TRUE(server_ptr->beginBatch());
+    ASSERT_TRUE(server_ptr->isBatching());
+    ASSERT_FALSE(server_ptr->beginBatch()); // no nesting
+
+    ASSERT_TRUE(server_ptr->write(block, 0, 0));
+    ASSERT_TRUE(server_ptr->write(block, 100, 0));
+
+    // readers either wait (fail) or see the data from before the batch
+    bool success_read = client_ptr->read(output, 0, 0);
+
+    ASSERT_TRUE(!success_read || (output.array() == 1.0).all());
+    ASSERT_FALSE(client_ptr->waitForUpdate(0));
+
+    ASSERT_FALSE(server_ptr->read(output, 0, 0)); // the server's own reads fail
+
+    ASSERT_TRUE(server_ptr->commit());
+    ASSERT_FALSE(server_ptr->isBatching());
+    ASSERT_FALSE(server_ptr->commit()); // nothing left to commit
+
+    data.block(0, 0, 10, N_COLS) = block;
+    data.block(100, 0, 10, N_COLS) = block;
+
+    ASSERT_TRUE(client_ptr->read(output, 0, 0));
+    ASSERT_TRUE(output == data);
+
+    ASSERT_TRUE(client_ptr->waitForUpdate(0));
+
+    ASSERT_TRUE(client_ptr->readChanged(output, version, changed_rows));
+    ASSERT_EQ(changed_rows.size(), 20);
+    ASSERT_EQ(changed_rows.front(), 0);
+    ASSERT_EQ(changed_rows.back(), 109);
+
+}
+
+TEST_P(BatchTest, ReadersSeeWholeBatches) {
+
+    const int block_rows = N_ROWS / 4;
+
+    std::atomic<bool> done(false);
+
+    std::thread writer([&]() {
+
+        Tensor<double> block(block_rows, N_COLS);
+
+        for (int i = 0; i < N_WRITES; ++i) {
+
+            block.setConstant(i);
+
+            if (!server_ptr->beginBatch()) {
+                continue; // a reader holds the data
+            }
+
+            // two disjoint blocks, at the beginning and at the end
+            server_ptr->write(block, 0, 0);
+            server_ptr->write(block, N_ROWS - block_rows, 0);
+
+            server_ptr->commit();
+
+        }
+
+        done = true;
+
+    });
+
+    Tensor<double> output(N_ROWS, N_COLS);
+
+    int n_reads = 0;
+
+    while (!done) {
+
+        if (client_ptr->read(output, 0, 0)) {
+
+            Tensor<double> first = output.topRows(block_rows);
+            Tensor<double> last = output.bottomRows(block_rows);
+
+            ASSERT_TRUE(isUniform(first));
+            ASSERT_TRUE(first == last);
+
+            n_reads++;
+
+        }
+
+    }
+
+    writer.join();
+
+    ASSERT_GT(n_reads, 0);
+
+}
+
+INSTANTIATE_TEST_SUITE_P(SyncModes, BatchTest,
+                        ::testing::Values(SyncMode::Lock,
+                                        SyncMode::SeqLock,
+                                        SyncMode::Striped,
+                                        SyncMode::Ring));
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
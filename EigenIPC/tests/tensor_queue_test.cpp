@@ -0,0 +1,341 @@
+// Copyright (C) 2023  Andrea Patrizi (AndrePatri)
+// 
+// This file is part of EigenIPC and distributed under the General Public License version 2 license.
+// 
+// EigenIPC is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+// 
+// EigenIPC is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with EigenIPC.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <memory>
+
+#include <EigenIPC/TensorQueue.hpp>
+#include <EigenIPC/Journal.hpp>
+
+using namespace EigenIPC;
+
+using VLevel = Journal::VLevel;
+
+static std::string name_space = "TensorQueueTests";
+
+int N_PRODUCERS = 4;
+int N_CONSUMERS = 4;
+int N_ITEMS = 5000; // per producer
+
+int TIMEOUT = 5000; // [ms]
+
+TEST(TensorQueueTest, FifoOrder) {
+
+    TensorQueue<int, RowMajor> queue("Fifo", name_space);
+
+    queue.create(3, 2, 4);
+
+    Tensor<int, RowMajor> data(3, 2);
+
+    for (int i = 0; i < 4; ++i) {
+
+        data.setConstant(i);
+
+        ASSERT_TRUE(queue.tryPush(data));
+    }
+
+    ASSERT_FALSE(queue.tryPush(data)); // full
+    ASSERT_FALSE(queue.push(data, 10));
+
+    ASSERT_EQ(queue.size(), 4);
+
+    Tensor<int, RowMajor> output(3, 2);
+
+    for (int i = 0; i < 4; ++i) {
+
+        ASSERT_TRUE(queue.tryPop(output));
+
+        ASSERT_TRUE((output.array() == i).all());
+    }
+
+    ASSERT_FALSE(queue.tryPop(output)); // empty
+    ASSERT_FALSE(queue.pop(output, 10));
+
+    Tensor<int, RowMajor> wrong_size(2, 2);
+
+    ASSERT_THROW(queue.tryPush(wrong_size), std::runtime_error);
+
+    queue.close();
+
+}
+
+TEST(TensorQueueTest, EveryItemIsPoppedOnce) {
+
+    TensorQueue<double, ColMajor> queue("Mpmc", name_space);
+
+    queue.create(10, 2, 64);
+
+    std::vector<std::atomic<int>> pop_count(N_PRODUCERS * N_ITEMS);
+
+    for (auto& count : pop_count) {
+
+        count = 0;
+    }
+
+    std::atomic<int> n_popped(0);
+    std::atomic<int> n_failures(0);
+
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < N_PRODUCERS; ++p) {
+
+        threads.emplace_back([&, p]() {
+
+            TensorQueue<double, ColMajor> producer("Mpmc", name_space);
+
+            producer.attach();
+
+            Tensor<double, ColMajor> data(10, 2);
+
+            for (int i = 0; i < N_ITEMS; ++i) {
+
+                data.col(0).setConstant(p);
+                data.col(1).setConstant(i);
+
+                if (!producer.push(data, TIMEOUT)) {
+
+                    n_failures++;
+
+                    break;
+                }
+
+            }
+
+            producer.close();
+
+        });
+
+    }
+
+    for (int c = 0; c < N_CONSUMERS; ++c) {
+
+        threads.emplace_back([&]() {
+
+            TensorQueue<double, ColMajor> consumer("Mpmc", name_space);
+
+            consumer.attach();
+
+            Tensor<double, ColMajor> output(10, 2);
+
+            std::vector<int> last(N_PRODUCERS, -1); // FIFO per producer
+
+            while (n_popped < N_PRODUCERS * N_ITEMS) {
+
+                if (!consumer.pop(output, 10)) {
+
+                    continue; // others got the last items
+                }
+
+                n_popped++;
+
+                int p = static_cast<int>(output(0, 0));
+                int i = static_cast<int>(output(0, 1));
+
+                if (!(output.col(0).array() == p).all() ||
+                    !(output.col(1).array() == i).all() ||
+                    i <= last[p]) {
+
+                    n_failures++; // torn or out of order
+                }
+
+                last[p] = i;
+
+                pop_count[p * N_ITEMS + i]++;
+
+            }
+
+            consumer.close();
+
+        });
+
+    }
+
+    for (auto& thread : threads) {
+
+        thread.join();
+    }
+
+    ASSERT_EQ(n_failures, 0);
+
+    for (auto& count : pop_count) {
+
+        ASSERT_EQ(count, 1);
+    }
+
+    ASSERT_EQ(queue.size(), 0);
+
+    queue.close();
+
+}
+
+TEST(TensorQueueTest, BatchesAreContiguous) {
+
+    TensorQueue<float, RowMajor> queue("Batches", name_space);
+
+    queue.create(4, 4, 4);
+
+    Tensor<float, RowMajor> data(4, 4);
+    Tensor<float, RowMajor> output(4, 4);
+
+    for (int i = 0; i < 3; ++i) {
+
+        data.setConstant(i);
+
+        ASSERT_TRUE(queue.tryPush(data));
+    }
+
+    ASSERT_TRUE(queue.tryPop(output));
+    ASSERT_TRUE(queue.tryPop(output));
+
+    for (int i = 3; i < 6; ++i) { // wraps around the end of the ring
+
+        data.setConstant(i);
+
+        ASSERT_TRUE(queue.tryPush(data));
+    }
+
+    {
+        auto batch = queue.tryPopBatch(10);
+
+        ASSERT_EQ(batch.size(), 2); // up to the end of the ring
+
+        ASSERT_EQ(batch.data(0)(3, 3), 2);
+        ASSERT_EQ(batch.data(1)(3, 3), 3);
+
+        ASSERT_EQ(batch.data(1).data(), batch.data(0).data() + 16); // (64 bytes)
+
+        ASSERT_FALSE(queue.tryPush(data)); // the cells are still borrowed
+
+    } // released
+
+    data.setConstant(6);
+    ASSERT_TRUE(queue.tryPush(data));
+    data.setConstant(7);
+    ASSERT_TRUE(queue.tryPush(data));
+    ASSERT_FALSE(queue.tryPush(data));
+
+    auto batch = queue.popBatch(10, TIMEOUT); // back at the start of the ring
+
+    ASSERT_EQ(batch.size(), 4);
+
+    for (int i = 0; i < 4; ++i) {
+
+        ASSERT_EQ(batch.data(i)(0, 0), 4 + i);
+    }
+
+    batch.release();
+
+    ASSERT_EQ(queue.tryPopBatch(10).size(), 0); // empty
+
+    queue.close();
+
+}
+
+TEST(TensorQueueTest, BatchesAreInvalidatedOnClose) {
+
+    Tensor<int, ColMajor> data(1, 1);
+    data.setConstant(1);
+
+    auto queue = std::make_unique<TensorQueue<int, ColMajor>>("Invalidated", name_space);
+
+    queue->create(1, 1, 4);
+
+    ASSERT_TRUE(queue->tryPush(data));
+    ASSERT_TRUE(queue->tryPush(data));
+
+    auto closed = queue->tryPopBatch(1);
+    auto destroyed = queue->tryPopBatch(1);
+
+    ASSERT_EQ(closed.size(), 1);
+    ASSERT_EQ(destroyed.size(), 1);
+
+    queue->close(); // its memory is unmapped
+
+    ASSERT_EQ(closed.size(), 0);
+
+    closed.release(); // no-op
+
+    queue->create(1, 1, 4); // a new queue does not revive old batches
+
+    ASSERT_EQ(destroyed.size(), 0);
+
+    queue.reset();
+
+    destroyed.release(); // no-op (outlives its queue)
+
+}
+
+TEST(TensorQueueTest, WaitersGiveUpOnClose) {
+
+    TensorQueue<int, ColMajor> queue("GiveUp", name_space);
+
+    queue.create(1, 1, 2);
+
+    TensorQueue<int, ColMajor> consumer("GiveUp", name_space);
+
+    consumer.attach();
+
+    std::thread closer([&]() {
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+        queue.close();
+
+    });
+
+    Tensor<int, ColMajor> output(1, 1);
+
+    ASSERT_FALSE(consumer.pop(output)); // no timeout
+
+    closer.join();
+
+    ASSERT_FALSE(consumer.isRunning());
+
+    consumer.close();
+
+}
+
+TEST(TensorQueueTest, MismatchesAreRejected) {
+
+    TensorQueue<float, RowMajor> queue("Mismatch", name_space);
+
+    queue.create(2, 2, 2);
+
+    TensorQueue<double, RowMajor> wrong_type("Mismatch", name_space);
+    ASSERT_THROW(wrong_type.attach(), std::runtime_error);
+
+    TensorQueue<int, RowMajor> same_size("Mismatch", name_space); // as float
+    ASSERT_THROW(same_size.attach(), std::runtime_error);
+
+    TensorQueue<float, ColMajor> wrong_layout("Mismatch", name_space);
+    ASSERT_THROW(wrong_layout.attach(), std::runtime_error);
+
+    TensorQueue<float, RowMajor> other("Mismatch", name_space);
+    ASSERT_THROW(other.create(2, 2, 2), std::runtime_error); // already there
+
+    queue.close();
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}